@@ -1,7 +1,11 @@
 #ifndef MY_NEURAL_NET_ACTIVATION_H_
 #define MY_NEURAL_NET_ACTIVATION_H_
 
+#include <cmath>
+#include <cstdint>
+#include <cstring>
 #include <functional>
+#include <utility>
 
 /**
  * @file activation.h
@@ -17,7 +21,17 @@ namespace nn {
 	enum class ActivationType {
 		Sigmoid,
 		ReLU,
-		Tanh
+		Tanh,
+		Linear   ///< Identity, e.g. for the bottleneck of a factored layer
+	};
+
+	/**
+	 * @enum ActivationPrecision
+	 * @brief Exact libm activations or fast polynomial approximations.
+	 */
+	enum class ActivationPrecision {
+		Exact,
+		Fast   ///< Sigmoid/Tanh (and derivatives) within 1e-7 relative error for |x| <= 350
 	};
 
 	/**
@@ -32,9 +46,199 @@ namespace nn {
 	/**
 	 * @brief Returns the activation function (forward & derivative) for a given type.
 	 * @param type The activation type
+	 * @param precision Exact or fast approximation
 	 * @return Corresponding activation functions
 	 */
-	ActivationFunction getActivation(ActivationType type);
+	ActivationFunction getActivation(ActivationType type,
+		ActivationPrecision precision = ActivationPrecision::Exact);
+
+	/**
+	 * @struct ActivationTraits
+	 * @brief Inlinable forward & derivative for an activation known at compile time.
+	 *
+	 * Fixed-topology code paths use these directly instead of going through
+	 * the std::function members of ActivationFunction.
+	 */
+	template <ActivationType Type>
+	struct ActivationTraits;
+
+	template <>
+	struct ActivationTraits<ActivationType::Sigmoid> {
+		static double forward(double x) {
+			return 1.0 / (1.0 + std::exp(-x));
+		}
+		static double derivative(double x) {
+			double s = forward(x);
+			return s * (1.0 - s);
+		}
+	};
+
+	template <>
+	struct ActivationTraits<ActivationType::ReLU> {
+		static double forward(double x) {
+			return (x > 0.0) ? x : 0.0;
+		}
+		static double derivative(double x) {
+			return (x > 0.0) ? 1.0 : 0.0;
+		}
+	};
+
+	template <>
+	struct ActivationTraits<ActivationType::Tanh> {
+		static double forward(double x) {
+			return std::tanh(x);
+		}
+		static double derivative(double x) {
+			double t = std::tanh(x);
+			return 1.0 - t * t;
+		}
+	};
+
+	template <>
+	struct ActivationTraits<ActivationType::Linear> {
+		static double forward(double x) {
+			return x;
+		}
+		static double derivative(double) {
+			return 1.0;
+		}
+	};
+
+	namespace detail {
+
+		/**
+		 * @brief Splits x = n ln2 + r with |r| <= ln2/2 and returns expm1(r)
+		 *        (degree-7 Taylor, relative error < 2e-8) and 2^n.
+		 *        Branch-free so loops over it can vectorize.
+		 */
+		inline double expm1Reduced(double x, double& scale) {
+			const double kLog2e = 1.4426950408889634;
+			const double kLn2Hi = 6.93147180369123816490e-01;  // Cody-Waite split of ln2
+			const double kLn2Lo = 1.90821492927058770002e-10;
+			const double kRound = 6755399441055744.0;           // 1.5 * 2^52: rounds to integer
+			x = (x < -700.0) ? -700.0 : ((x > 700.0) ? 700.0 : x);
+			const double t = x * kLog2e + kRound;
+			const double n = t - kRound;
+			const double r = (x - n * kLn2Hi) - n * kLn2Lo;
+			// The low mantissa bits of t hold n; move n + bias into the
+			// exponent field with integer ops only (no double -> int convert).
+			// Unsigned, so the shift that drops the high bits is well defined
+			uint64_t bits;
+			std::memcpy(&bits, &t, sizeof(bits));
+			bits = (bits + 1023) << 52;
+			std::memcpy(&scale, &bits, sizeof(scale));
+			return r * (1.0 + r * (1.0 / 2 + r * (1.0 / 6 + r * (1.0 / 24 + r * (1.0 / 120
+				+ r * (1.0 / 720 + r * (1.0 / 5040)))))));
+		}
+
+	}  // namespace detail
+
+	/**
+	 * @brief exp(x) with relative error below 2e-8 for |x| <= 700.
+	 */
+	inline double fastExp(double x) {
+		double scale;
+		double p = detail::expm1Reduced(x, scale);
+		return scale + scale * p;
+	}
+
+	/**
+	 * @brief exp(x) - 1 with relative error below 2e-8 for |x| <= 700,
+	 *        including near 0.
+	 */
+	inline double fastExpm1(double x) {
+		double scale;
+		double p = detail::expm1Reduced(x, scale);
+		return scale * p + (scale - 1.0);
+	}
+
+	/**
+	 * @struct FastActivationTraits
+	 * @brief ActivationTraits counterparts built on fastExp / fastExpm1.
+	 *        Derivatives are formed from exp directly (not 1 - t*t), so they
+	 *        keep their relative accuracy in the saturated tails.
+	 */
+	template <ActivationType Type>
+	struct FastActivationTraits;
+
+	template <>
+	struct FastActivationTraits<ActivationType::Sigmoid> {
+		static double forward(double x) {
+			return 1.0 / (1.0 + fastExp(-x));
+		}
+		static double derivative(double x) {
+			double e = fastExp(-std::fabs(x));
+			double d = 1.0 + e;
+			return e / (d * d);
+		}
+	};
+
+	template <>
+	struct FastActivationTraits<ActivationType::ReLU> : ActivationTraits<ActivationType::ReLU> {};
+
+	template <>
+	struct FastActivationTraits<ActivationType::Linear> : ActivationTraits<ActivationType::Linear> {};
+
+	template <>
+	struct FastActivationTraits<ActivationType::Tanh> {
+		static double forward(double x) {
+			double e = fastExpm1(2.0 * x);
+			return e / (e + 2.0);
+		}
+		static double derivative(double x) {
+			double e = fastExp(-2.0 * std::fabs(x));
+			double d = 1.0 + e;
+			return 4.0 * e / (d * d);
+		}
+	};
+
+	/**
+	 * @brief Calls func(ActivationTraits<type>{}) so a kernel written against
+	 *        the traits is instantiated once per activation and picked at runtime.
+	 */
+	template <typename Func>
+	void withActivationTraits(ActivationType type, Func&& func) {
+		switch (type) {
+		case ActivationType::Sigmoid:
+			func(ActivationTraits<ActivationType::Sigmoid>{});
+			return;
+		case ActivationType::ReLU:
+			func(ActivationTraits<ActivationType::ReLU>{});
+			return;
+		case ActivationType::Tanh:
+			func(ActivationTraits<ActivationType::Tanh>{});
+			return;
+		case ActivationType::Linear:
+			func(ActivationTraits<ActivationType::Linear>{});
+			return;
+		}
+	}
+
+	/**
+	 * @brief withActivationTraits that dispatches to FastActivationTraits
+	 *        for ActivationPrecision::Fast.
+	 */
+	template <typename Func>
+	void withActivationTraits(ActivationType type, ActivationPrecision precision, Func&& func) {
+		if (precision == ActivationPrecision::Exact) {
+			withActivationTraits(type, std::forward<Func>(func));
+			return;
+		}
+		switch (type) {
+		case ActivationType::Sigmoid:
+			func(FastActivationTraits<ActivationType::Sigmoid>{});
+			return;
+		case ActivationType::ReLU:
+			func(FastActivationTraits<ActivationType::ReLU>{});
+			return;
+		case ActivationType::Tanh:
+			func(FastActivationTraits<ActivationType::Tanh>{});
+			return;
+		case ActivationType::Linear:
+			func(FastActivationTraits<ActivationType::Linear>{});
+			return;
+		}
+	}
 
 }  // namespace nn
 
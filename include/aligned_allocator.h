@@ -0,0 +1,87 @@
+#ifndef MY_NEURAL_NET_ALIGNED_ALLOCATOR_H_
+#define MY_NEURAL_NET_ALIGNED_ALLOCATOR_H_
+
+#include <cstddef>
+#include <new>
+
+/**
+ * @file aligned_allocator.h
+ * @brief Cache-line aligned, huge-page backed storage for Matrix data.
+ */
+
+namespace nn {
+
+	/// Alignment of every Matrix buffer: one cache line, a full AVX-512 vector.
+	constexpr size_t kMatrixAlignment = 64;
+
+	/// Huge page size requested for large buffers.
+	constexpr size_t kHugePageBytes = size_t(2) << 20;
+
+	/**
+	 * @brief Sets the buffer size from which huge pages are requested
+	 *        (transparent huge pages on Linux, large pages on Windows when the
+	 *        process holds the privilege). Smaller buffers, and any request
+	 *        the OS refuses, fall back to ordinary aligned pages.
+	 * @param bytes Threshold; 0 disables huge pages
+	 */
+	void setHugePageThreshold(size_t bytes);
+
+	/**
+	 * @return Current huge-page threshold in bytes (default 4 MiB).
+	 */
+	size_t hugePageThreshold();
+
+	/**
+	 * @brief Allocates bytes aligned to kMatrixAlignment. From the threshold
+	 *        up the underlying block starts on a huge-page boundary and spans
+	 *        whole huge pages; the data begins one cache line into it, after
+	 *        the block header. Throws std::bad_alloc on failure.
+	 */
+	void* allocateAligned(size_t bytes);
+
+	/**
+	 * @brief Frees a block from allocateAligned.
+	 */
+	void deallocateAligned(void* p) noexcept;
+
+	/**
+	 * @brief Row stride (in doubles) for a width of cols: cols rounded up to
+	 *        whole cache lines, plus one line when the stride would be a
+	 *        multiple of 512 bytes, where consecutive rows map to the same
+	 *        L1 sets and evict each other during column-wise access.
+	 */
+	size_t paddedLeadingDimension(size_t cols);
+
+	/**
+	 * @class AlignedAllocator
+	 * @brief Standard allocator over allocateAligned.
+	 */
+	template <typename T>
+	class AlignedAllocator {
+	public:
+		using value_type = T;
+
+		AlignedAllocator() noexcept = default;
+		template <typename U>
+		AlignedAllocator(const AlignedAllocator<U>&) noexcept {}
+
+		T* allocate(size_t n) {
+			if (n > size_t(-1) / sizeof(T)) {
+				throw std::bad_alloc();
+			}
+			return static_cast<T*>(allocateAligned(n * sizeof(T)));
+		}
+
+		void deallocate(T* p, size_t) noexcept {
+			deallocateAligned(p);
+		}
+
+		template <typename U>
+		bool operator==(const AlignedAllocator<U>&) const noexcept { return true; }
+		template <typename U>
+		bool operator!=(const AlignedAllocator<U>&) const noexcept { return false; }
+	};
+
+}  // namespace nn
+
+#endif  // MY_NEURAL_NET_ALIGNED_ALLOCATOR_H_
@@ -0,0 +1,109 @@
+#ifndef MY_NEURAL_NET_CONV_LAYER_H_
+#define MY_NEURAL_NET_CONV_LAYER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "matrix.h"
+#include "activation.h"
+#include "layer.h"
+
+/**
+ * @file conv_layer.h
+ * @brief 2-D convolution layer lowered onto GEMM with a tiled im2col buffer.
+ */
+
+namespace nn {
+
+	/**
+	 * @class Conv2DLayer
+	 * @brief out = act(conv(in, W) + b) with square kernels, stride and zero padding.
+	 *
+	 * Each row of the input is one sample stored channel-major (C x H x W);
+	 * each output row is (filters x outHeight x outWidth) in the same layout,
+	 * so conv layers chain directly and Dense layers can consume the result.
+	 *
+	 * Forward lowers a tile of output pixels at a time into a
+	 * (C*k*k x tile) column buffer and multiplies it by the (filters x C*k*k)
+	 * weights. The tile is sized so the column buffer stays within
+	 * `im2colBudgetBytes`, so a large image is never unfolded in full.
+	 * Backward lowers the same tiles transposed (one patch per row) to get
+	 * dW = delta * col^T as a plain GEMM, and scatters W^T * delta back
+	 * into the input gradient (col2im).
+	 */
+	class Conv2DLayer : public Layer {
+	public:
+		/**
+		 * @param channels Input channels C
+		 * @param height Input height H
+		 * @param width Input width W
+		 * @param filters Output channels
+		 * @param kernelSize Side k of the square kernel
+		 * @param stride Step between windows
+		 * @param padding Zero rows/columns added on each side
+		 * @param activation e.g. ReLU
+		 * @param im2colBudgetBytes Upper bound on the column buffer
+		 */
+		Conv2DLayer(size_t channels, size_t height, size_t width,
+			size_t filters, size_t kernelSize,
+			size_t stride = 1, size_t padding = 0,
+			ActivationType activation = ActivationType::ReLU,
+			size_t im2colBudgetBytes = size_t(1) << 20);
+
+		/**
+		 * @brief As above with an explicit initialization seed.
+		 */
+		Conv2DLayer(size_t channels, size_t height, size_t width,
+			size_t filters, size_t kernelSize,
+			size_t stride, size_t padding,
+			ActivationType activation,
+			size_t im2colBudgetBytes,
+			uint64_t seed);
+
+		size_t outputWidth(const std::vector<size_t>& inputWidths) const override;
+		std::vector<size_t> savedWidths(const std::vector<size_t>& inputWidths) const override;
+		void forward(const std::vector<const Matrix*>& inputs, Matrix& output,
+			const std::vector<Matrix*>& saved, bool training) override;
+		void backward(const std::vector<const Matrix*>& inputs,
+			const std::vector<Matrix*>& saved, Matrix& gradOutput,
+			const std::vector<Matrix*>& gradInputs) override;
+		std::vector<std::pair<Matrix*, Matrix*>> parameters() override;
+
+		size_t outHeight() const { return m_outH; }
+		size_t outWidth() const { return m_outW; }
+
+		/**
+		 * @return Output pixels lowered per GEMM.
+		 */
+		size_t tilePixels() const { return m_tilePixels; }
+
+		Matrix& weights() { return m_weights; }
+		Matrix& biases() { return m_biases; }
+
+	private:
+		size_t m_channels, m_height, m_width;
+		size_t m_filters, m_kernel, m_stride, m_padding;
+		size_t m_outH, m_outW;
+		size_t m_patchSize;     ///< C * k * k
+		size_t m_tilePixels;
+		ActivationType m_activation;
+
+		Matrix m_weights;       ///< filters x patchSize
+		Matrix m_biases;        ///< 1 x filters
+		Matrix m_gradW;
+		Matrix m_gradB;
+
+		// Workspace, sized once for a full tile
+		std::vector<double> m_col;       ///< patchSize x tile (or tile x patchSize)
+		std::vector<double> m_tileOut;   ///< filters x tile
+		std::vector<double> m_tileGradW; ///< filters x patchSize
+		std::vector<double> m_weightsT;  ///< patchSize x filters
+
+		void im2col(const double* image, size_t p0, size_t count, double* col) const;
+		void im2colTransposed(const double* image, size_t p0, size_t count, double* colT) const;
+		void col2im(const double* col, size_t p0, size_t count, double* image) const;
+	};
+
+}  // namespace nn
+
+#endif  // MY_NEURAL_NET_CONV_LAYER_H_
@@ -0,0 +1,89 @@
+#ifndef MY_NEURAL_NET_DATA_PARALLEL_H_
+#define MY_NEURAL_NET_DATA_PARALLEL_H_
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "distributed.h"
+#include "matrix.h"
+#include "neural_network.h"
+
+/**
+ * @file data_parallel.h
+ * @brief Data-parallel training of NeuralNetwork replicas in separate processes.
+ */
+
+namespace nn {
+
+	/**
+	 * @class DataParallelTrainer
+	 * @brief Each process trains a replica on its own shard of every
+	 *        mini-batch; gradients are averaged with a ring all-reduce so all
+	 *        replicas take the same optimizer step.
+	 *
+	 * With overlap on, a communication thread all-reduces layer i's
+	 * gradients while backprop continues with layers i - 1 .. 0, so network
+	 * time hides behind compute (the reverse loop produces the last layers'
+	 * gradients first). The constructor broadcasts rank 0's parameters so
+	 * replicas start identical.
+	 */
+	class DataParallelTrainer {
+	public:
+		/**
+		 * @param net This process's replica (must outlive the trainer; not LBFGS)
+		 * @param comm Connected communicator (must outlive the trainer)
+		 * @param overlap Reduce layers in the background during backprop
+		 */
+		DataParallelTrainer(NeuralNetwork& net, RingCommunicator& comm, bool overlap = true);
+		~DataParallelTrainer();
+
+		DataParallelTrainer(const DataParallelTrainer&) = delete;
+		DataParallelTrainer& operator=(const DataParallelTrainer&) = delete;
+
+		/**
+		 * @brief One synchronous step; every rank must call it with equally
+		 *        many rows so the averaged gradient is the full batch's.
+		 *        If any layer fails to reduce, no layer is updated and
+		 *        healthy() turns false.
+		 * @param input This rank's shard (rows x input_dim)
+		 * @param target This rank's shard (rows x output_dim)
+		 * @return This rank's loss on its shard
+		 */
+		double trainBatch(const Matrix& input, const Matrix& target);
+
+		/**
+		 * @return False once any collective failed (failed steps are not applied).
+		 */
+		bool healthy() const { return m_healthy; }
+
+	private:
+		NeuralNetwork& m_net;
+		RingCommunicator& m_comm;
+		bool m_overlap;
+		bool m_healthy = true;
+
+		std::vector<Matrix> m_inputs;
+		std::vector<Matrix> m_nets;
+		std::vector<Matrix> m_dW;
+		std::vector<Matrix> m_dB;
+		std::vector<std::vector<double>> m_buckets;   ///< Flattened dW then dB per layer
+
+		// Communication thread: reduces queued layer buckets in order
+		std::thread m_thread;
+		std::mutex m_mutex;
+		std::condition_variable m_cv;
+		std::deque<size_t> m_queue;
+		size_t m_reduced = 0;
+		bool m_commFailed = false;
+		bool m_stop = false;
+
+		void commMain();
+		bool reduceBucket(size_t i);
+	};
+
+}  // namespace nn
+
+#endif  // MY_NEURAL_NET_DATA_PARALLEL_H_
@@ -0,0 +1,36 @@
+#ifndef MY_NEURAL_NET_DATASET_H_
+#define MY_NEURAL_NET_DATASET_H_
+
+#include <cstddef>
+#include <vector>
+#include "matrix.h"
+
+/**
+ * @file dataset.h
+ * @brief A set of (input, target) samples.
+ */
+
+namespace nn {
+
+	/**
+	 * @struct Dataset
+	 * @brief Paired input/target matrices, one (1 x dim) row per sample.
+	 */
+	struct Dataset {
+		std::vector<Matrix> inputs;   ///< Each (1 x input_dim)
+		std::vector<Matrix> targets;  ///< Each (1 x output_dim)
+
+		/**
+		 * @return Number of samples.
+		 */
+		size_t size() const { return inputs.size(); }
+
+		/**
+		 * @return True if the dataset holds no samples.
+		 */
+		bool empty() const { return inputs.empty(); }
+	};
+
+}  // namespace nn
+
+#endif  // MY_NEURAL_NET_DATASET_H_
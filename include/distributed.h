@@ -0,0 +1,159 @@
+#ifndef MY_NEURAL_NET_DISTRIBUTED_H_
+#define MY_NEURAL_NET_DISTRIBUTED_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+/**
+ * @file distributed.h
+ * @brief Ring all-reduce between processes over local sockets, gradient
+ *        compression and a launcher for local worker processes.
+ */
+
+namespace nn {
+
+	/**
+	 * @enum Transport
+	 * @brief Socket family used between neighbouring ranks.
+	 */
+	enum class Transport {
+		Tcp,        ///< host:basePort + rank
+		UnixDomain  ///< socketDir/nn_ring_<basePort>_<rank> (POSIX only)
+	};
+
+	/**
+	 * @enum GradientCompression
+	 * @brief Encoding of gradients on the wire.
+	 */
+	enum class GradientCompression {
+		None,   ///< 8-byte doubles
+		Fp16,   ///< IEEE half precision (magnitudes clamped to 65504)
+		TopK    ///< Largest topKFraction entries as (index, float) with error feedback
+	};
+
+	/**
+	 * @struct DistributedConfig
+	 * @brief Identity of this process in the ring and how to reach the others.
+	 */
+	struct DistributedConfig {
+		size_t rank = 0;
+		size_t worldSize = 1;
+		Transport transport = Transport::Tcp;
+		std::string host = "127.0.0.1";
+		uint16_t basePort = 29500;
+		std::string socketDir = "/tmp";
+		GradientCompression compression = GradientCompression::None;
+		double topKFraction = 0.01;
+		int connectTimeoutMs = 10000;
+
+		/**
+		 * @brief Reads NN_RANK, NN_WORLD_SIZE, NN_BASE_PORT and NN_TRANSPORT
+		 *        ("tcp" or "unix") as set by launchLocalWorkers.
+		 * @return False if NN_RANK or NN_WORLD_SIZE is missing
+		 */
+		static bool fromEnvironment(DistributedConfig& config);
+	};
+
+	/**
+	 * @brief Nearest IEEE half to x (round to nearest even), saturating at
+	 *        +-65504 so large gradients stay finite.
+	 */
+	uint16_t toHalf(double x);
+
+	/**
+	 * @brief Exact value of a half.
+	 */
+	double fromHalf(uint16_t h);
+
+	/**
+	 * @class RingCommunicator
+	 * @brief Connects each rank to its successor and predecessor and sums
+	 *        buffers around the ring.
+	 *
+	 * allReduce is bandwidth-optimal: a reduce-scatter then an all-gather,
+	 * each N - 1 steps of one 1/N chunk, so every rank sends about
+	 * 2 (N - 1) / N of the buffer whatever N is. Each step sends to the
+	 * successor while receiving from the predecessor. All ranks must call
+	 * the collective operations in the same order and end with identical
+	 * results (chunks are reduced in a fixed order).
+	 */
+	class RingCommunicator {
+	public:
+		explicit RingCommunicator(const DistributedConfig& config);
+
+		/**
+		 * @brief Closes the sockets.
+		 */
+		~RingCommunicator();
+
+		RingCommunicator(const RingCommunicator&) = delete;
+		RingCommunicator& operator=(const RingCommunicator&) = delete;
+
+		/**
+		 * @brief Listens, connects to the successor (retrying until the
+		 *        timeout) and accepts the predecessor.
+		 * @return False on timeout or socket errors
+		 */
+		bool connect();
+
+		/**
+		 * @brief Sums data over all ranks in place, compressed per config.
+		 * @param bucket Identifies the buffer for TopK error feedback;
+		 *        use the same id for the same tensor on every call
+		 * @return False if a peer failed
+		 */
+		bool allReduce(double* data, size_t count, size_t bucket = 0);
+
+		/**
+		 * @brief Copies root's data to every rank (uncompressed).
+		 */
+		bool broadcast(double* data, size_t count, size_t root = 0);
+
+		/**
+		 * @brief Closes the sockets. Later collectives fail at once, and so do
+		 *        the neighbours' (a failed collective closes this rank too).
+		 */
+		void close();
+
+		size_t rank() const { return m_config.rank; }
+		size_t worldSize() const { return m_config.worldSize; }
+
+		/**
+		 * @return Payload bytes sent so far (excluding length prefixes).
+		 */
+		uint64_t bytesSent() const { return m_bytesSent; }
+
+	private:
+		DistributedConfig m_config;
+		intptr_t m_listen = -1;
+		intptr_t m_next = -1;   ///< Socket to rank + 1
+		intptr_t m_prev = -1;   ///< Socket from rank - 1
+		uint64_t m_bytesSent = 0;
+		std::map<size_t, std::vector<double>> m_residuals;   ///< TopK error feedback per bucket
+
+		bool exchange(const void* sendData, size_t sendBytes, void* recvData, size_t recvBytes);
+		bool exchangeMessage(const std::vector<char>& out, std::vector<char>& in);
+		bool ringAllReduce(double* data, size_t count);
+		bool topKAllReduce(double* data, size_t count, size_t bucket);
+	};
+
+	/**
+	 * @return Absolute path of the running executable (empty if unknown).
+	 */
+	std::string currentExecutablePath();
+
+	/**
+	 * @brief Runs worldSize copies of executable with args, each with
+	 *        NN_RANK, NN_WORLD_SIZE, NN_BASE_PORT and NN_TRANSPORT set from
+	 *        config, and waits for all of them.
+	 * @return Number of workers that failed (0 on success)
+	 */
+	size_t launchLocalWorkers(const std::string& executable,
+		const std::vector<std::string>& args, const DistributedConfig& config);
+
+}  // namespace nn
+
+#endif  // MY_NEURAL_NET_DISTRIBUTED_H_
@@ -0,0 +1,73 @@
+#ifndef MY_NEURAL_NET_EVALUATION_H_
+#define MY_NEURAL_NET_EVALUATION_H_
+
+#include <cstddef>
+#include <vector>
+#include "dataset.h"
+#include "neural_network.h"
+
+/**
+ * @file evaluation.h
+ * @brief Batched, parallel scoring of a network on a dataset.
+ */
+
+namespace nn {
+
+	/**
+	 * @enum Metric
+	 * @brief Quantities evaluate() can compute.
+	 */
+	enum class Metric {
+		Loss,             ///< Mean per-sample loss of the network's loss type
+		Accuracy,         ///< Single outputs thresholded at 0.5, wider ones by argmax
+		AUC,              ///< ROC AUC; one-vs-rest mean over classes for wider outputs
+		ConfusionMatrix   ///< Counts of (actual, predicted) class pairs
+	};
+
+	/**
+	 * @struct EvaluationResult
+	 * @brief Requested metrics; the others stay at their defaults.
+	 */
+	struct EvaluationResult {
+		size_t samples = 0;
+		double loss = 0.0;
+		double accuracy = 0.0;
+		double auc = 0.0;               ///< 0.5 for a class with only positives or negatives
+		size_t numClasses = 0;          ///< 2 for a single output, else the output width
+		std::vector<size_t> confusion;  ///< numClasses x numClasses, row = actual class
+
+		/**
+		 * @return Samples of class actual predicted as class predicted.
+		 */
+		size_t confusionCount(size_t actual, size_t predicted) const {
+			return confusion[actual * numClasses + predicted];
+		}
+	};
+
+	/**
+	 * @brief Stacks (1 x dim) samples into one (n x dim) matrix whose pages
+	 *        follow ExecutionConfig::datasetPolicy (see placeMatrix).
+	 * @param rows Samples, all of the same width (at least one)
+	 */
+	Matrix stackSamples(const std::vector<Matrix>& rows);
+
+	/**
+	 * @brief Scores net on data without touching its state.
+	 *
+	 * Samples are stacked once with stackSamples, then cut into batches run
+	 * through the const predict path in parallel (see parallelFor). Each
+	 * batch fills its own accumulator, and the accumulators are merged in
+	 * batch order, so the result does not depend on the number of threads.
+	 *
+	 * @param net Network to score
+	 * @param data Samples, each (1 x dim)
+	 * @param metrics What to compute
+	 * @param batchRows Samples per batch
+	 */
+	EvaluationResult evaluate(const NeuralNetwork& net, const Dataset& data,
+		const std::vector<Metric>& metrics = { Metric::Loss, Metric::Accuracy },
+		size_t batchRows = 64);
+
+}  // namespace nn
+
+#endif  // MY_NEURAL_NET_EVALUATION_H_
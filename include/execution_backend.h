@@ -0,0 +1,106 @@
+#ifndef MY_NEURAL_NET_EXECUTION_BACKEND_H_
+#define MY_NEURAL_NET_EXECUTION_BACKEND_H_
+
+#include <cstddef>
+#include <functional>
+#include "matrix.h"
+
+/**
+ * @file execution_backend.h
+ * @brief Runtime choice of the threads behind the library's parallel loops,
+ *        and NUMA placement of Matrix storage.
+ */
+
+namespace nn {
+
+	/**
+	 * @enum ExecutionBackend
+	 * @brief Who runs parallelFor.
+	 */
+	enum class ExecutionBackend {
+		ParallelStl,    ///< std::execution::par (threads float freely)
+		PinnedThreads   ///< A persistent ThreadGroup, static ranges per worker
+	};
+
+	/**
+	 * @enum NumaPolicy
+	 * @brief Where the pages of a buffer should live.
+	 */
+	enum class NumaPolicy {
+		FirstTouch,   ///< Each pinned worker's band of the buffer on that worker's node
+		Interleave,   ///< Pages round-robin over all nodes
+		Bind          ///< All pages on ExecutionConfig::bindNode
+	};
+
+	/**
+	 * @enum TensorRole
+	 * @brief Which configured policy a buffer follows.
+	 */
+	enum class TensorRole {
+		Weights,
+		Activations,
+		Dataset        ///< Stacked samples (stackSamples in evaluation.h)
+	};
+
+	/**
+	 * @struct ExecutionConfig
+	 * @brief Process-wide execution and placement settings.
+	 */
+	struct ExecutionConfig {
+		ExecutionBackend backend = ExecutionBackend::ParallelStl;
+		size_t numThreads = 0;     ///< PinnedThreads workers (0 = one per logical core)
+		bool pinThreads = true;    ///< Pin worker t to core firstCore + t
+		size_t firstCore = 0;
+		NumaPolicy weightPolicy = NumaPolicy::FirstTouch;
+		NumaPolicy activationPolicy = NumaPolicy::FirstTouch;
+		NumaPolicy datasetPolicy = NumaPolicy::Interleave;
+		size_t bindNode = 0;       ///< Node used by NumaPolicy::Bind
+	};
+
+	/**
+	 * @brief Replaces the process-wide configuration (and the worker group).
+	 *        Call while no parallel work is running.
+	 */
+	void setExecutionConfig(const ExecutionConfig& config);
+
+	/**
+	 * @return The active configuration.
+	 */
+	const ExecutionConfig& executionConfig();
+
+	/**
+	 * @brief Calls body(begin, end) on disjoint ranges covering [0, count).
+	 *
+	 * With PinnedThreads, worker t always gets the t-th equal band, so memory
+	 * a worker first-touched is the memory it keeps processing. Ranges are at
+	 * least grain long; nested calls and calls that find the group busy run
+	 * serially on the caller.
+	 */
+	void parallelFor(size_t count, size_t grain, const std::function<void(size_t, size_t)>& body);
+
+	/**
+	 * @return Number of NUMA nodes (1 where unknown).
+	 */
+	size_t numaNodeCount();
+
+	/**
+	 * @return NUMA node of a logical core (0 where unknown).
+	 */
+	size_t numaNodeOfCore(size_t core);
+
+	/**
+	 * @brief Applies a policy to the whole pages inside [data, data + bytes),
+	 *        migrating pages already resident. Linux only.
+	 * @return False if nothing was placed (single node, unsupported, too small,
+	 *         or FirstTouch without pinned workers)
+	 */
+	bool placeMemory(void* data, size_t bytes, NumaPolicy policy);
+
+	/**
+	 * @brief placeMemory on a matrix's storage with the policy configured for its role.
+	 */
+	bool placeMatrix(Matrix& m, TensorRole role);
+
+}  // namespace nn
+
+#endif  // MY_NEURAL_NET_EXECUTION_BACKEND_H_
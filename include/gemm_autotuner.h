@@ -0,0 +1,140 @@
+#ifndef MY_NEURAL_NET_GEMM_AUTOTUNER_H_
+#define MY_NEURAL_NET_GEMM_AUTOTUNER_H_
+
+#include <cstddef>
+#include <string>
+#include <vector>
+#include "neural_network.h"
+
+/**
+ * @file gemm_autotuner.h
+ * @brief Per-shape choice of GEMM kernel, blocking and parallel split for
+ *        Matrix::multiply, picked by benchmarking and kept in an on-disk cache.
+ */
+
+namespace nn {
+
+	/**
+	 * @enum GemmKernel
+	 * @brief Inner loop nest. Every kernel sums each C(i, j) over k in
+	 *        increasing order, so all plans give bit-identical results.
+	 */
+	enum class GemmKernel {
+		RowStream,     ///< One row of C at a time, i-k-j order
+		RegisterTile,  ///< Four rows of C per pass, sharing each row of B
+		Blocked        ///< RegisterTile inside blockK x blockN tiles of B
+	};
+
+	/**
+	 * @enum GemmAxis
+	 * @brief Which dimension of C is split across threads.
+	 */
+	enum class GemmAxis {
+		Rows,
+		Columns
+	};
+
+	/**
+	 * @struct GemmPlan
+	 * @brief How one product shape is computed. The default plan is the
+	 *        untuned path: RowStream over row bands sized by work per task.
+	 */
+	struct GemmPlan {
+		GemmKernel kernel = GemmKernel::RowStream;
+		GemmAxis axis = GemmAxis::Rows;
+		size_t tasks = 0;      ///< Parallel bands (0 = sized by work, 1 = serial)
+		size_t blockK = 0;     ///< Blocked only
+		size_t blockN = 0;     ///< Blocked only
+		double seconds = 0.0;  ///< Measured time per call (0 if never tuned)
+	};
+
+	/**
+	 * @enum GemmTuning
+	 * @brief When Matrix::multiply consults and extends the tuning cache.
+	 */
+	enum class GemmTuning {
+		Off,      ///< Always the default plan
+		Cached,   ///< Tuned plans where cached, the default plan elsewhere
+		Online    ///< As Cached, but a new shape is tuned the first time it is seen
+	};
+
+	/**
+	 * @struct GemmTunerConfig
+	 * @brief Process-wide autotuner settings.
+	 */
+	struct GemmTunerConfig {
+		GemmTuning mode = GemmTuning::Cached;
+		std::string cachePath;           ///< Loaded on set, rewritten after each tuning (empty = memory only)
+		size_t minWork = 16 * 16 * 16;   ///< Products with fewer multiply-adds are never tuned
+		double secondsPerShape = 0.25;   ///< Benchmark budget per shape (the default plan is always timed)
+	};
+
+	/**
+	 * @brief Replaces the configuration and, if cachePath names a readable
+	 *        cache, merges its plans in. Call while no GEMM is running.
+	 * @return False if cachePath is set but could not be loaded
+	 */
+	bool setGemmTunerConfig(const GemmTunerConfig& config);
+
+	/**
+	 * @return The active configuration.
+	 */
+	const GemmTunerConfig& gemmTunerConfig();
+
+	/**
+	 * @brief Plan Matrix::multiply uses for C (M x N) = A (M x K) * B (K x N).
+	 *        Thread-safe; under GemmTuning::Online may benchmark first.
+	 */
+	GemmPlan gemmPlan(size_t M, size_t N, size_t K);
+
+	/**
+	 * @brief Benchmarks gemmCandidates(M, N, K) on scratch operands within
+	 *        the configured budget and caches the fastest (saving the cache
+	 *        file if one is configured). Meant for model load, not the hot path.
+	 * @return The chosen plan
+	 */
+	GemmPlan tuneGemm(size_t M, size_t N, size_t K);
+
+	/**
+	 * @brief Tunes every product a NeuralNetwork forward and backward pass on
+	 *        batches of batchRows rows performs, skipping shapes already cached.
+	 * @return Number of shapes newly tuned
+	 */
+	size_t tuneGemmForNetwork(const NeuralNetwork& net, size_t batchRows);
+
+	/**
+	 * @return Plans tuneGemm tries for this shape, the default plan first.
+	 */
+	std::vector<GemmPlan> gemmCandidates(size_t M, size_t N, size_t K);
+
+	/**
+	 * @brief C = A * B for row-major, densely packed operands using a plan.
+	 */
+	void runGemm(const GemmPlan& plan, const double* A, const double* B, double* C,
+		size_t M, size_t N, size_t K);
+
+	/**
+	 * @brief Merges plans from a cache file. Files written on a machine with a
+	 *        different number of logical cores are rejected as a whole.
+	 * @return False if the file is missing, foreign or malformed (nothing merged)
+	 */
+	bool loadGemmCache(const std::string& path);
+
+	/**
+	 * @brief Writes every cached plan (via a temporary file, then rename).
+	 */
+	bool saveGemmCache(const std::string& path);
+
+	/**
+	 * @brief Forgets every cached plan (the file is left alone).
+	 */
+	void clearGemmCache();
+
+	/**
+	 * @return Number of cached shapes.
+	 */
+	size_t gemmCacheSize();
+
+}  // namespace nn
+
+#endif  // MY_NEURAL_NET_GEMM_AUTOTUNER_H_
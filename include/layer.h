@@ -0,0 +1,244 @@
+#ifndef MY_NEURAL_NET_LAYER_H_
+#define MY_NEURAL_NET_LAYER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include "matrix.h"
+#include "activation.h"
+
+/**
+ * @file layer.h
+ * @brief Layer interface and the built-in layers used by LayerGraph.
+ */
+
+namespace nn {
+
+	/**
+	 * @class Layer
+	 * @brief One node of a LayerGraph.
+	 *
+	 * Layers never allocate activation storage themselves: every tensor a
+	 * layer reads or writes during a step (inputs, output, tensors saved for
+	 * backward, gradients) is a (batch x width) buffer handed in by the graph's
+	 * execution plan. Only parameters and their gradients are owned by the layer.
+	 */
+	class Layer {
+	public:
+		virtual ~Layer() = default;
+
+		/**
+		 * @return Number of input tensors (1 for everything but Residual).
+		 */
+		virtual size_t numInputs() const { return 1; }
+
+		/**
+		 * @param inputWidths Width of each input tensor
+		 * @return Width of the output tensor
+		 */
+		virtual size_t outputWidth(const std::vector<size_t>& inputWidths) const = 0;
+
+		/**
+		 * @brief Widths of the (batch x width) tensors forward() stores for
+		 *        backward() (e.g. pre-activations, dropout masks).
+		 */
+		virtual std::vector<size_t> savedWidths(const std::vector<size_t>& inputWidths) const {
+			(void)inputWidths;
+			return {};
+		}
+
+		/**
+		 * @return True if backward() reads the layer inputs; lets the memory
+		 *         planner release them right after forward otherwise.
+		 */
+		virtual bool needsInputsForBackward() const { return true; }
+
+		/**
+		 * @brief Computes output from inputs.
+		 * @param inputs One buffer per input
+		 * @param output Destination, already shaped (batch x outputWidth)
+		 * @param saved Destinations for savedWidths(), already shaped
+		 * @param training False skips train-only behaviour (e.g. dropout)
+		 */
+		virtual void forward(const std::vector<const Matrix*>& inputs, Matrix& output,
+			const std::vector<Matrix*>& saved, bool training) = 0;
+
+		/**
+		 * @brief Computes parameter gradients and accumulates input gradients.
+		 * @param inputs Same buffers as forward (stale if !needsInputsForBackward)
+		 * @param saved Tensors written by forward; may be overwritten
+		 * @param gradOutput dL/dOutput; may be overwritten (both are dead afterwards)
+		 * @param gradInputs dL/dInput[k] to add into, or nullptr if not needed
+		 */
+		virtual void backward(const std::vector<const Matrix*>& inputs,
+			const std::vector<Matrix*>& saved, Matrix& gradOutput,
+			const std::vector<Matrix*>& gradInputs) = 0;
+
+		/**
+		 * @return (parameter, gradient) pairs for the graph's optimizers.
+		 */
+		virtual std::vector<std::pair<Matrix*, Matrix*>> parameters() { return {}; }
+	};
+
+	/**
+	 * @class DenseLayer
+	 * @brief Fully-connected layer: out = act(in * W + b).
+	 */
+	class DenseLayer : public Layer {
+	public:
+		/**
+		 * @brief Constructs with initializer matched to the activation.
+		 * @param inDim Input width
+		 * @param outDim Output width
+		 * @param activation e.g. ReLU
+		 * @param seed Initialization seed (defaults to a fresh global stream)
+		 */
+		DenseLayer(size_t inDim, size_t outDim, ActivationType activation);
+		DenseLayer(size_t inDim, size_t outDim, ActivationType activation, uint64_t seed);
+
+		size_t outputWidth(const std::vector<size_t>& inputWidths) const override;
+		std::vector<size_t> savedWidths(const std::vector<size_t>& inputWidths) const override;
+		void forward(const std::vector<const Matrix*>& inputs, Matrix& output,
+			const std::vector<Matrix*>& saved, bool training) override;
+		void backward(const std::vector<const Matrix*>& inputs,
+			const std::vector<Matrix*>& saved, Matrix& gradOutput,
+			const std::vector<Matrix*>& gradInputs) override;
+		std::vector<std::pair<Matrix*, Matrix*>> parameters() override;
+
+		Matrix& weights() { return m_weights; }
+		Matrix& biases() { return m_biases; }
+
+		/**
+		 * @brief Switches between exact and fast approximate activations.
+		 */
+		void setActivationPrecision(ActivationPrecision precision) { m_precision = precision; }
+
+	private:
+		ActivationType m_activation;
+		ActivationPrecision m_precision = ActivationPrecision::Exact;
+		Matrix m_weights;   ///< inDim x outDim
+		Matrix m_biases;    ///< 1 x outDim
+		Matrix m_gradW;
+		Matrix m_gradB;
+
+		// Backward workspace (grown on demand, never shrunk)
+		std::vector<double> m_transposed;  ///< in^T, then W^T
+		std::vector<double> m_product;     ///< delta * W^T before it is accumulated
+	};
+
+	/**
+	 * @class DropoutLayer
+	 * @brief Inverted dropout: zeroes each element with probability `rate`
+	 *        and scales survivors by 1 / (1 - rate). Identity when not training.
+	 *
+	 * Masks come from the counter-based generator keyed by (seed, step), so a
+	 * run is reproducible regardless of thread count.
+	 */
+	class DropoutLayer : public Layer {
+	public:
+		explicit DropoutLayer(double rate);
+		DropoutLayer(double rate, uint64_t seed);
+
+		size_t outputWidth(const std::vector<size_t>& inputWidths) const override;
+		std::vector<size_t> savedWidths(const std::vector<size_t>& inputWidths) const override;
+		bool needsInputsForBackward() const override { return false; }
+		void forward(const std::vector<const Matrix*>& inputs, Matrix& output,
+			const std::vector<Matrix*>& saved, bool training) override;
+		void backward(const std::vector<const Matrix*>& inputs,
+			const std::vector<Matrix*>& saved, Matrix& gradOutput,
+			const std::vector<Matrix*>& gradInputs) override;
+
+	private:
+		double m_rate;
+		uint64_t m_seed;
+		uint64_t m_step = 0;
+	};
+
+	/**
+	 * @class LayerNormLayer
+	 * @brief Normalizes each row to zero mean / unit variance, then applies
+	 *        a learned per-feature scale (gamma) and shift (beta).
+	 */
+	class LayerNormLayer : public Layer {
+	public:
+		explicit LayerNormLayer(size_t width, double epsilon = 1e-5);
+
+		size_t outputWidth(const std::vector<size_t>& inputWidths) const override;
+		std::vector<size_t> savedWidths(const std::vector<size_t>& inputWidths) const override;
+		void forward(const std::vector<const Matrix*>& inputs, Matrix& output,
+			const std::vector<Matrix*>& saved, bool training) override;
+		void backward(const std::vector<const Matrix*>& inputs,
+			const std::vector<Matrix*>& saved, Matrix& gradOutput,
+			const std::vector<Matrix*>& gradInputs) override;
+		std::vector<std::pair<Matrix*, Matrix*>> parameters() override;
+
+	private:
+		double m_epsilon;
+		Matrix m_gamma;     ///< 1 x width
+		Matrix m_beta;      ///< 1 x width
+		Matrix m_gradGamma;
+		Matrix m_gradBeta;
+	};
+
+	/**
+	 * @class BatchNormLayer
+	 * @brief Normalizes each feature over the batch, then applies a learned
+	 *        scale (gamma) and shift (beta).
+	 *
+	 * Training uses the batch statistics, gathered in one Welford pass over
+	 * the rows, and folds them into exponential running averages; inference
+	 * normalizes with the running averages instead.
+	 */
+	class BatchNormLayer : public Layer {
+	public:
+		/**
+		 * @param width Features
+		 * @param momentum Weight of the newest batch in the running averages
+		 * @param epsilon Added to the variance
+		 */
+		explicit BatchNormLayer(size_t width, double momentum = 0.1, double epsilon = 1e-5);
+
+		size_t outputWidth(const std::vector<size_t>& inputWidths) const override;
+		void forward(const std::vector<const Matrix*>& inputs, Matrix& output,
+			const std::vector<Matrix*>& saved, bool training) override;
+		void backward(const std::vector<const Matrix*>& inputs,
+			const std::vector<Matrix*>& saved, Matrix& gradOutput,
+			const std::vector<Matrix*>& gradInputs) override;
+		std::vector<std::pair<Matrix*, Matrix*>> parameters() override;
+
+		const Matrix& runningMean() const { return m_runningMean; }
+		const Matrix& runningVar() const { return m_runningVar; }
+
+	private:
+		double m_momentum;
+		double m_epsilon;
+		Matrix m_gamma;       ///< 1 x width
+		Matrix m_beta;        ///< 1 x width
+		Matrix m_gradGamma;
+		Matrix m_gradBeta;
+		Matrix m_runningMean;
+		Matrix m_runningVar;
+		Matrix m_batchMean;   ///< Statistics of the last training batch
+		Matrix m_batchRstd;
+	};
+
+	/**
+	 * @class ResidualLayer
+	 * @brief Element-wise sum of two same-width inputs (a skip connection).
+	 */
+	class ResidualLayer : public Layer {
+	public:
+		size_t numInputs() const override { return 2; }
+		size_t outputWidth(const std::vector<size_t>& inputWidths) const override;
+		bool needsInputsForBackward() const override { return false; }
+		void forward(const std::vector<const Matrix*>& inputs, Matrix& output,
+			const std::vector<Matrix*>& saved, bool training) override;
+		void backward(const std::vector<const Matrix*>& inputs,
+			const std::vector<Matrix*>& saved, Matrix& gradOutput,
+			const std::vector<Matrix*>& gradInputs) override;
+	};
+
+}  // namespace nn
+
+#endif  // MY_NEURAL_NET_LAYER_H_
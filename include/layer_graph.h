@@ -0,0 +1,187 @@
+#ifndef MY_NEURAL_NET_LAYER_GRAPH_H_
+#define MY_NEURAL_NET_LAYER_GRAPH_H_
+
+#include <cstddef>
+#include <memory>
+#include <utility>
+#include <vector>
+#include "matrix.h"
+#include "layer.h"
+#include "loss.h"
+#include "optimizer.h"
+
+/**
+ * @file layer_graph.h
+ * @brief DAG of layers compiled into a static execution plan with planned memory.
+ */
+
+namespace nn {
+
+	/**
+	 * @struct TensorLifetime
+	 * @brief A tensor's size and the inclusive range of plan steps it is live in.
+	 */
+	struct TensorLifetime {
+		size_t elements;
+		size_t firstUse;
+		size_t lastUse;
+	};
+
+	/**
+	 * @struct MemoryPlan
+	 * @brief Assignment of tensors to shared buffers.
+	 */
+	struct MemoryPlan {
+		std::vector<size_t> bufferOf;        ///< Buffer index of each tensor
+		std::vector<size_t> bufferElements;  ///< Capacity of each buffer
+	};
+
+	/**
+	 * @brief Greedy-by-size buffer assignment: tensors are visited largest
+	 *        first and placed in the first buffer none of whose tenants'
+	 *        lifetimes overlap theirs, so tensors that are never live at the
+	 *        same time share storage.
+	 * @param tensors Size and lifetime of every tensor
+	 * @return Buffer of each tensor and the capacity of each buffer
+	 */
+	MemoryPlan planMemory(const std::vector<TensorLifetime>& tensors);
+
+	/**
+	 * @class LayerGraph
+	 * @brief Layers wired into a DAG (node 0 is the graph input, the last
+	 *        added node is the output), trained with mini-batch backprop.
+	 *
+	 * compile() topologically orders the nodes once (insertion order is
+	 * already topological, since a node may only consume earlier nodes),
+	 * resolves every step's input/output/saved/gradient buffers up front and
+	 * runs planMemory over their lifetimes. forward() and trainBatch() then
+	 * just walk the prepared steps: no graph traversal, no per-step lookups
+	 * and no allocation for activations or gradients.
+	 */
+	class LayerGraph {
+	public:
+		static constexpr size_t kInput = 0;  ///< Node id of the graph input
+
+		/**
+		 * @param inputWidth Features per sample
+		 * @param lossType e.g. CrossEntropy
+		 * @param optType e.g. Momentum (one optimizer per parameter tensor)
+		 * @param learningRate
+		 * @param momentum
+		 */
+		LayerGraph(size_t inputWidth,
+			LossType lossType,
+			OptimizerType optType,
+			double learningRate = 0.1,
+			double momentum = 0.9);
+
+		/**
+		 * @brief Appends a layer fed by earlier nodes.
+		 * @param layer The layer (ownership is taken)
+		 * @param inputs Node ids, one per layer input
+		 * @return Node id of the new layer
+		 */
+		size_t add(std::unique_ptr<Layer> layer, const std::vector<size_t>& inputs);
+
+		/**
+		 * @brief Appends a single-input layer fed by the most recent node.
+		 */
+		size_t add(std::unique_ptr<Layer> layer);
+
+		/**
+		 * @return Output width of a node.
+		 */
+		size_t outputWidth(size_t node) const;
+
+		/**
+		 * @return The layer at a node (node > 0).
+		 */
+		Layer& layer(size_t node);
+
+		/**
+		 * @brief Builds the execution plan and allocates its buffers.
+		 *        Called automatically when the batch size or mode changes.
+		 * @param batchSize Rows per forward/trainBatch call
+		 * @param training Also plan the backward pass (saved tensors, gradients)
+		 */
+		void compile(size_t batchSize, bool training = true);
+
+		/**
+		 * @brief Inference pass (dropout disabled).
+		 * @param input (batch x inputWidth)
+		 * @return The output (batch x outputWidth), valid until the next call
+		 */
+		const Matrix& forward(const Matrix& input);
+
+		/**
+		 * @brief One optimizer step on a mini-batch.
+		 * @param input (batch x inputWidth)
+		 * @param target (batch x outputWidth)
+		 * @return Loss averaged over the batch
+		 */
+		double trainBatch(const Matrix& input, const Matrix& target);
+
+		/**
+		 * @return Bytes held by the planned buffers.
+		 */
+		size_t plannedBytes() const;
+
+		/**
+		 * @return Bytes the same plan would need with one buffer per tensor.
+		 */
+		size_t unplannedBytes() const;
+
+		/**
+		 * @return Number of planned buffers.
+		 */
+		size_t numBuffers() const;
+
+		void setLearningRate(double lr);
+		double learningRate() const;
+
+	private:
+		struct Node {
+			std::unique_ptr<Layer> layer;  ///< Null for the input node
+			std::vector<size_t> inputs;
+			size_t width;
+			std::vector<size_t> savedWidths;
+		};
+
+		// One layer invocation with every buffer resolved at compile time
+		struct Step {
+			Layer* layer;
+			size_t outputWidth;
+			std::vector<size_t> savedWidths;
+			std::vector<const Matrix*> inputs;
+			Matrix* output;
+			std::vector<Matrix*> saved;
+			Matrix* gradOutput;
+			std::vector<Matrix*> gradInputs;
+			std::vector<std::pair<Matrix*, size_t>> zeroGrads;  ///< First writes of input grads
+		};
+
+		std::vector<Node> m_nodes;
+		LossType m_lossType;
+		OptimizerType m_optType;
+		double m_learningRate;
+		double m_momentum;
+		std::vector<std::pair<Matrix*, Matrix*>> m_parameters;
+		std::vector<std::unique_ptr<Optimizer>> m_optimizers;
+
+		size_t m_batchSize = 0;
+		bool m_training = false;
+		std::vector<Matrix> m_buffers;
+		std::vector<Step> m_steps;       ///< Forward order; backward walks it in reverse
+		Matrix* m_inputBuffer = nullptr;
+		Matrix* m_outputGrad = nullptr;
+		size_t m_plannedBytes = 0;
+		size_t m_unplannedBytes = 0;
+
+		void ensureCompiled(size_t batchSize, bool training);
+		void runForward(const Matrix& input, bool training);
+		double computeOutputGradient(const Matrix& target);
+	};
+
+}  // namespace nn
+
+#endif  // MY_NEURAL_NET_LAYER_GRAPH_H_
@@ -0,0 +1,77 @@
+#ifndef MY_NEURAL_NET_LBFGS_H_
+#define MY_NEURAL_NET_LBFGS_H_
+
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <vector>
+
+/**
+ * @file lbfgs.h
+ * @brief Limited-memory BFGS over a flat parameter vector.
+ */
+
+namespace nn {
+
+	/**
+	 * @struct LbfgsConfig
+	 * @brief History length and strong Wolfe line-search constants.
+	 */
+	struct LbfgsConfig {
+		size_t historySize = 10;        ///< Curvature pairs (s, y) kept
+		size_t maxLineSearchSteps = 25; ///< Objective evaluations per line search
+		double c1 = 1e-4;               ///< Sufficient decrease
+		double c2 = 0.9;                ///< Curvature
+	};
+
+	/**
+	 * @class Lbfgs
+	 * @brief Quasi-Newton minimizer: the inverse Hessian is approximated
+	 *        from the last historySize steps (two-loop recursion), and each
+	 *        step length satisfies the strong Wolfe conditions.
+	 *
+	 * The objective must stay the same between steps (e.g. a full-batch
+	 * loss); with a changing objective call reset() first.
+	 */
+	class Lbfgs {
+	public:
+		/**
+		 * @brief Returns f(x) and writes df/dx into grad (resized by the callee).
+		 */
+		using Objective = std::function<double(const std::vector<double>& x, std::vector<double>& grad)>;
+
+		explicit Lbfgs(const LbfgsConfig& config = LbfgsConfig());
+
+		/**
+		 * @brief One iteration: search direction, line search, history update.
+		 * @param x Parameters, moved to the accepted point
+		 * @param objective Loss and gradient
+		 * @return f at the new x (at the old x if no step was accepted)
+		 */
+		double step(std::vector<double>& x, const Objective& objective);
+
+		/**
+		 * @brief Forgets the curvature history.
+		 */
+		void reset();
+
+		/**
+		 * @return Completed iterations and objective evaluations so far.
+		 */
+		size_t iterations() const { return m_iterations; }
+		size_t evaluations() const { return m_evaluations; }
+
+	private:
+		LbfgsConfig m_config;
+		std::deque<std::vector<double>> m_s;   ///< x_{k+1} - x_k
+		std::deque<std::vector<double>> m_y;   ///< g_{k+1} - g_k
+		std::deque<double> m_rho;              ///< 1 / (y . s)
+		size_t m_iterations = 0;
+		size_t m_evaluations = 0;
+
+		void direction(const std::vector<double>& grad, std::vector<double>& dir) const;
+	};
+
+}  // namespace nn
+
+#endif  // MY_NEURAL_NET_LBFGS_H_
@@ -1,6 +1,7 @@
 #ifndef MY_NEURAL_NET_LOSS_H_
 #define MY_NEURAL_NET_LOSS_H_
 
+#include <cmath>
 #include <functional>
 #include "matrix.h"
 
@@ -43,6 +44,44 @@ namespace nn {
 	 */
 	LossFunction getLoss(LossType type);
 
+	/**
+	 * @struct LossTraits
+	 * @brief Per-element loss and gradient for a loss known at compile time.
+	 *
+	 * Both values are unnormalized; callers divide by the batch size the same
+	 * way LossFunction does.
+	 */
+	template <LossType Type>
+	struct LossTraits;
+
+	template <>
+	struct LossTraits<LossType::MSE> {
+		static double value(double p, double t) {
+			double diff = p - t;
+			return 0.5 * diff * diff;
+		}
+		static double gradient(double p, double t) {
+			return p - t;
+		}
+	};
+
+	template <>
+	struct LossTraits<LossType::CrossEntropy> {
+		static double clamp(double p) {
+			if (p < 1e-12) p = 1e-12;
+			if (p > 1.0 - 1e-12) p = 1.0 - 1e-12;
+			return p;
+		}
+		static double value(double p, double t) {
+			p = clamp(p);
+			return -(t * std::log(p) + (1.0 - t) * std::log(1.0 - p));
+		}
+		static double gradient(double p, double t) {
+			p = clamp(p);
+			return (p - t) / (p * (1.0 - p));
+		}
+	};
+
 }  // namespace nn
 
 #endif  // MY_NEURAL_NET_LOSS_H_
@@ -0,0 +1,87 @@
+#ifndef MY_NEURAL_NET_LOW_RANK_H_
+#define MY_NEURAL_NET_LOW_RANK_H_
+
+#include <cstddef>
+#include <vector>
+#include "dataset.h"
+#include "matrix.h"
+#include "neural_network.h"
+
+/**
+ * @file low_rank.h
+ * @brief Truncated SVD and low-rank factorization of NeuralNetwork layers.
+ */
+
+namespace nn {
+
+	/**
+	 * @struct SingularValueDecomposition
+	 * @brief A ~= U diag(singularValues) V^T with U (rows x k), V (cols x k),
+	 *        orthonormal columns and singular values in decreasing order.
+	 */
+	struct SingularValueDecomposition {
+		Matrix U;
+		std::vector<double> singularValues;
+		Matrix V;
+	};
+
+	/**
+	 * @brief SVD by one-sided Jacobi rotations, kept to the largest rank
+	 *        singular triplets.
+	 * @param A Any (rows x cols) matrix
+	 * @param rank Triplets to keep (0 or more than min(rows, cols) keeps all)
+	 */
+	SingularValueDecomposition truncatedSvd(const Matrix& A, size_t rank = 0);
+
+	/**
+	 * @brief Smallest rank whose singular values hold at least energy of
+	 *        the total sum of squares (at least 1).
+	 */
+	size_t rankForEnergy(const std::vector<double>& singularValues, double energy);
+
+	/**
+	 * @struct LowRankConfig
+	 * @brief Which layers factorizeLowRank replaces and at what rank.
+	 */
+	struct LowRankConfig {
+		double energy = 0.99;          ///< Fraction of squared singular values to keep
+		size_t minWeights = 4096;      ///< Smaller layers stay dense
+		double maxLossIncrease = 0.0;  ///< With validation data: allowed loss increase per layer (0 = use energy)
+	};
+
+	/**
+	 * @struct LowRankLayerReport
+	 * @brief What factorizeLowRank did to one original layer.
+	 */
+	struct LowRankLayerReport {
+		bool factored = false;
+		size_t rank = 0;           ///< Chosen rank (min(in, out) if not factored)
+		double energyKept = 1.0;   ///< Fraction of squared singular values kept
+	};
+
+	/**
+	 * @brief Replaces each large layer W (in x out) by two layers: a Linear
+	 *        bottleneck in -> r with weights U sqrt(S) and no bias, then
+	 *        r -> out with weights sqrt(S) V^T, the original bias and
+	 *        activation. A layer is only replaced when r (in + out) < in out,
+	 *        i.e. when the two thin products are cheaper than the fat one.
+	 *
+	 * The result is an ordinary NeuralNetwork with the same loss and
+	 * optimizer settings, so it can be fine-tuned with trainSample or a
+	 * Trainer to recover accuracy lost to truncation.
+	 *
+	 * @param net Trained network
+	 * @param config Rank budget
+	 * @param validation If given with config.maxLossIncrease > 0, each layer
+	 *        gets the smallest rank whose loss on it stays within the budget
+	 *        of the uncompressed network's (layers chosen in order)
+	 * @param report If given, one entry per original layer
+	 */
+	NeuralNetwork factorizeLowRank(const NeuralNetwork& net,
+		const LowRankConfig& config = LowRankConfig(),
+		const Dataset* validation = nullptr,
+		std::vector<LowRankLayerReport>* report = nullptr);
+
+}  // namespace nn
+
+#endif  // MY_NEURAL_NET_LOW_RANK_H_
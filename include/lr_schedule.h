@@ -0,0 +1,112 @@
+#ifndef MY_NEURAL_NET_LR_SCHEDULE_H_
+#define MY_NEURAL_NET_LR_SCHEDULE_H_
+
+#include <cstddef>
+#include <memory>
+
+/**
+ * @file lr_schedule.h
+ * @brief Learning-rate schedules (step, cosine, warmup, reduce-on-plateau).
+ */
+
+namespace nn {
+
+	/**
+	 * @class LearningRateSchedule
+	 * @brief Abstract base class mapping an epoch to a learning rate.
+	 */
+	class LearningRateSchedule {
+	public:
+		virtual ~LearningRateSchedule() = default;
+
+		/**
+		 * @brief Learning rate to use for an epoch.
+		 * @param epoch 0-based epoch index
+		 * @param baseRate The network's initial learning rate
+		 */
+		virtual double rate(size_t epoch, double baseRate) = 0;
+
+		/**
+		 * @brief Reports the latest monitored loss. Only schedules that react
+		 *        to progress (reduce-on-plateau) use it.
+		 */
+		virtual void observe(double /*loss*/) {}
+	};
+
+	/**
+	 * @class StepDecaySchedule
+	 * @brief rate = base * gamma^(epoch / stepSize)
+	 */
+	class StepDecaySchedule : public LearningRateSchedule {
+	public:
+		StepDecaySchedule(size_t stepSize, double gamma);
+
+		double rate(size_t epoch, double baseRate) override;
+
+	private:
+		size_t m_stepSize;
+		double m_gamma;
+	};
+
+	/**
+	 * @class CosineSchedule
+	 * @brief Cosine annealing from base down to minRate over totalEpochs,
+	 *        then held at minRate.
+	 */
+	class CosineSchedule : public LearningRateSchedule {
+	public:
+		explicit CosineSchedule(size_t totalEpochs, double minRate = 0.0);
+
+		double rate(size_t epoch, double baseRate) override;
+
+	private:
+		size_t m_totalEpochs;
+		double m_minRate;
+	};
+
+	/**
+	 * @class WarmupSchedule
+	 * @brief Linear ramp up to base over warmupEpochs, then defers to another
+	 *        schedule (or stays at base if none) with the epoch count restarted.
+	 */
+	class WarmupSchedule : public LearningRateSchedule {
+	public:
+		WarmupSchedule(size_t warmupEpochs,
+			std::unique_ptr<LearningRateSchedule> after = nullptr);
+
+		double rate(size_t epoch, double baseRate) override;
+		void observe(double loss) override;
+
+	private:
+		size_t m_warmupEpochs;
+		std::unique_ptr<LearningRateSchedule> m_after;
+	};
+
+	/**
+	 * @class ReduceOnPlateauSchedule
+	 * @brief Multiplies the rate by factor whenever the observed loss fails to
+	 *        improve by minDelta for more than patience observations.
+	 */
+	class ReduceOnPlateauSchedule : public LearningRateSchedule {
+	public:
+		ReduceOnPlateauSchedule(double factor = 0.5,
+			size_t patience = 5,
+			double minDelta = 1e-4,
+			double minRate = 1e-6);
+
+		double rate(size_t epoch, double baseRate) override;
+		void observe(double loss) override;
+
+	private:
+		double m_factor;
+		size_t m_patience;
+		double m_minDelta;
+		double m_minRate;
+		double m_scale;
+		double m_best;
+		size_t m_wait;
+	};
+
+}  // namespace nn
+
+#endif  // MY_NEURAL_NET_LR_SCHEDULE_H_
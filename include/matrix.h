@@ -4,6 +4,7 @@
 #include <cstddef>
 #include <vector>
 #include <functional>
+#include "aligned_allocator.h"
 
 /**
  * @file matrix.h
@@ -19,6 +20,9 @@ namespace nn {
 	 */
 	class Matrix {
 	public:
+		/// Element storage: kMatrixAlignment-aligned, huge pages for large buffers.
+		using Storage = std::vector<double, AlignedAllocator<double>>;
+
 		/**
 		 * @brief Constructs a matrix with specified rows, cols.
 		 * @param rows Number of rows
@@ -59,13 +63,40 @@ namespace nn {
 		size_t cols() const;
 
 		/**
-		 * @brief Parallel matrix multiplication: C = A * B.
+		 * @brief Parallel matrix multiplication: C = A * B. Kernel and thread
+		 *        split follow the tuned plan for the shape (see gemm_autotuner.h).
 		 * @param A Left operand
 		 * @param B Right operand
 		 * @return Result of A*B
 		 */
 		static Matrix multiply(const Matrix& A, const Matrix& B);
 
+		/**
+		 * @brief Strided-batched multiplication over raw row-major storage:
+		 *        C_i = A_i * B_i for i in [0, batchCount), where A_i is the
+		 *        (M x K) block at A + i * strideA, B_i the (K x N) block at
+		 *        B + i * strideB and C_i the (M x N) block at C + i * strideC.
+		 *
+		 * Small per-matrix products are spread across the batch, large ones are
+		 * split per the tuned plan for (M, N, K). A stride of 0 reuses the same
+		 * operand for every batch entry.
+		 */
+		static void multiplyStridedBatched(const double* A, size_t strideA,
+			const double* B, size_t strideB,
+			double* C, size_t strideC,
+			size_t M, size_t N, size_t K,
+			size_t batchCount);
+
+		/**
+		 * @brief Batched multiplication of vertically stacked matrices.
+		 * @param A (batchCount * M) x K, batch entry i in rows [i*M, (i+1)*M)
+		 * @param B (batchCount * K) x N stacked the same way, or a single
+		 *        K x N matrix shared by every batch entry
+		 * @param batchCount Number of products
+		 * @return (batchCount * M) x N stack of A_i * B_i
+		 */
+		static Matrix multiplyBatched(const Matrix& A, const Matrix& B, size_t batchCount);
+
 		/**
 		 * @brief Parallel element-wise add: C = A + B.
 		 * @param A Left operand
@@ -74,6 +105,21 @@ namespace nn {
 		 */
 		static Matrix add(const Matrix& A, const Matrix& B);
 
+		/**
+		 * @brief Adds a row vector to every row: C(r, c) = A(r, c) + row(0, c).
+		 * @param A (batch x cols) matrix
+		 * @param row (1 x cols) matrix, e.g. a bias
+		 * @return Result of the broadcast add
+		 */
+		static Matrix addRowVector(const Matrix& A, const Matrix& row);
+
+		/**
+		 * @brief Sums each column over all rows (e.g. a bias gradient over a batch).
+		 * @param M Matrix to reduce
+		 * @return (1 x cols) matrix of column sums
+		 */
+		static Matrix columnSums(const Matrix& M);
+
 		/**
 		 * @brief In-place transform using a unary function.
 		 * @param func Function to apply to each element
@@ -87,23 +133,33 @@ namespace nn {
 		 */
 		static Matrix transpose(const Matrix& M);
 
+		/**
+		 * @brief Changes the shape. Storage is reused (no reallocation) when the
+		 *        new element count fits the current capacity; element values are
+		 *        unspecified afterwards.
+		 * @param rows New number of rows
+		 * @param cols New number of columns
+		 */
+		void resize(size_t rows, size_t cols);
+
 		/**
 		 * @return Reference to underlying data vector.
 		 */
-		std::vector<double>& data();
+		Storage& data();
 
 		/**
 		 * @return Const reference to underlying data vector.
 		 */
-		const std::vector<double>& data() const;
+		const Storage& data() const;
 
 	private:
 		size_t m_rows;
 		size_t m_cols;
-		std::vector<double> m_data;
+		Storage m_data;
 
 		/**
-		 * @brief Helper to random-initialize data.
+		 * @brief Helper to random-initialize data with U[-1, 1] from the
+		 *        global seed (see random.h).
 		 */
 		void randomInit();
 	};
@@ -0,0 +1,137 @@
+#ifndef MY_NEURAL_NET_NETWORK_ENSEMBLE_H_
+#define MY_NEURAL_NET_NETWORK_ENSEMBLE_H_
+
+#include <cstddef>
+#include <vector>
+#include "matrix.h"
+#include "activation.h"
+#include "loss.h"
+#include "optimizer.h"
+#include "neural_network.h"
+
+/**
+ * @file network_ensemble.h
+ * @brief Trains many same-topology networks in lockstep.
+ */
+
+namespace nn {
+
+	/**
+	 * @class NetworkEnsemble
+	 * @brief K independent fully-connected networks sharing one topology,
+	 *        stored model-interleaved so one pass updates all of them.
+	 *
+	 * Every per-layer buffer is a Matrix whose rows are the usual elements of
+	 * a single network and whose K columns are the models, e.g. layer weights
+	 * are (inDim * outDim) x K with row (i * outDim + j) holding W(i, j) of
+	 * every model. Each kernel walks those rows, so the innermost loop runs
+	 * contiguously across models and vectorizes, turning K tiny products into
+	 * one wide one.
+	 *
+	 * Each model follows NeuralNetwork::trainSample exactly; models differ
+	 * only in their random initialization and, optionally, learning rate.
+	 */
+	class NetworkEnsemble {
+	public:
+		/**
+		 * @brief Constructs K models with per-model learning rates.
+		 * @param layerSizes e.g. {2, 4, 4, 1}
+		 * @param activations e.g. {ReLU, ReLU, Sigmoid}
+		 * @param lossType e.g. CrossEntropy
+		 * @param optType SGD or Momentum (LBFGS is not supported)
+		 * @param learningRates One learning rate per model (K = size)
+		 * @param momentum Shared momentum factor
+		 */
+		NetworkEnsemble(const std::vector<size_t>& layerSizes,
+			const std::vector<ActivationType>& activations,
+			LossType lossType,
+			OptimizerType optType,
+			const std::vector<double>& learningRates,
+			double momentum = 0.9);
+
+		/**
+		 * @brief Constructs K models sharing one learning rate.
+		 * @param numModels K
+		 */
+		NetworkEnsemble(size_t numModels,
+			const std::vector<size_t>& layerSizes,
+			const std::vector<ActivationType>& activations,
+			LossType lossType,
+			OptimizerType optType,
+			double learningRate = 0.1,
+			double momentum = 0.9);
+
+		/**
+		 * @return Number of models K.
+		 */
+		size_t size() const;
+
+		/**
+		 * @brief Forward pass of every model.
+		 * @param input (1 x input_dim) shared by all models, or (K x input_dim)
+		 *        with row k fed to model k
+		 * @return (K x output_dim) matrix, row k is model k's output
+		 */
+		Matrix forward(const Matrix& input);
+
+		/**
+		 * @brief Trains every model on one sample.
+		 * @param input (1 x input_dim) shared, or (K x input_dim) per model
+		 * @param target (1 x output_dim) shared, or (K x output_dim) per model
+		 * @return Per-model loss for this sample (also added to accumulatedLosses)
+		 */
+		const std::vector<double>& trainSample(const Matrix& input, const Matrix& target);
+
+		/**
+		 * @return Per-model loss summed over trainSample calls since resetLosses.
+		 */
+		const std::vector<double>& accumulatedLosses() const;
+
+		/**
+		 * @brief Zeroes the accumulated per-model losses (e.g. at epoch start).
+		 */
+		void resetLosses();
+
+		/**
+		 * @return Index of the model with the lowest accumulated loss.
+		 */
+		size_t bestModel() const;
+
+		/**
+		 * @brief Copies model k out into a standalone NeuralNetwork with the
+		 *        same configuration. Optimizer state (velocity) is not carried over.
+		 * @param k Model index
+		 */
+		NeuralNetwork extractModel(size_t k) const;
+
+	private:
+		size_t m_numModels;
+		std::vector<size_t> m_layerSizes;
+		std::vector<ActivationType> m_activationTypes;
+		LossType m_lossType;
+		OptimizerType m_optType;
+		std::vector<double> m_learningRates;
+		double m_momentum;
+
+		// All buffers below are (elements x K), model index innermost
+		std::vector<Matrix> m_weights;    ///< (inDim * outDim) x K
+		std::vector<Matrix> m_biases;     ///< outDim x K
+		std::vector<Matrix> m_velocityW;
+		std::vector<Matrix> m_velocityB;
+		std::vector<Matrix> m_layerNetInputs;
+		std::vector<Matrix> m_layerOutputs;
+		std::vector<Matrix> m_deltas;
+		Matrix m_input;                   ///< inDim x K
+
+		std::vector<double> m_sampleLosses;
+		std::vector<double> m_totalLosses;
+
+		void loadInput(const Matrix& input);
+		void forwardLayer(size_t layer);
+		void backwardLayer(size_t layer);
+		void computeOutputDelta(const Matrix& target);
+	};
+
+}  // namespace nn
+
+#endif  // MY_NEURAL_NET_NETWORK_ENSEMBLE_H_
@@ -1,10 +1,12 @@
 #ifndef MY_NEURAL_NET_NEURAL_NETWORK_H_
 #define MY_NEURAL_NET_NEURAL_NETWORK_H_
 
+#include <cstdint>
 #include <vector>
 #include <memory>
 #include "matrix.h"
 #include "activation.h"
+#include "lbfgs.h"
 #include "loss.h"
 #include "optimizer.h"
 
@@ -19,6 +21,9 @@ namespace nn {
      * @class NeuralNetwork
      * @brief Implements a multi-layer feed-forward neural network with
      *        backpropagation training (single-sample version).
+     *
+     * Inputs may also be (batch x input_dim) mini-batches: biases broadcast
+     * over the rows and the loss is averaged over the batch.
      */
     class NeuralNetwork {
     public:
@@ -38,6 +43,16 @@ namespace nn {
             double learningRate = 0.1,
             double momentum = 0.9);
 
+        /**
+         * @brief Re-initializes every layer deterministically from a seed:
+         *        He-normal weights for ReLU layers, Xavier-uniform for Sigmoid,
+         *        Tanh and Linear; biases 0.01 for ReLU layers, 0 otherwise. The
+         *        constructor calls this with a seed derived from the global
+         *        seed (see random.h).
+         * @param seed Any 64-bit value; equal seeds give bit-identical weights
+         */
+        void initializeParameters(uint64_t seed);
+
         /**
          * @brief Forward pass for a single sample.
          * @param input A (1 x input_dim) matrix
@@ -45,26 +60,223 @@ namespace nn {
          */
         Matrix forward(const Matrix& input);
 
+        /**
+         * @brief Inference-only forward pass; leaves the stored layer
+         *        activations untouched so it can run on a const network.
+         * @param input A (1 x input_dim) matrix
+         * @return The output matrix (1 x output_dim)
+         */
+        Matrix predict(const Matrix& input) const;
+
         /**
          * @brief Trains on a single sample via backprop.
+         *
+         * With OptimizerType::LBFGS this is one L-BFGS iteration (with line
+         * search) on the whole parameter vector, so input should be the full
+         * batch and the same on every call.
+         *
          * @param input A (1 x input_dim) matrix
          * @param target A (1 x output_dim) matrix
-         * @return The scalar loss value for this sample
+         * @return The scalar loss value for this sample (after the step for LBFGS)
          */
         double trainSample(const Matrix& input, const Matrix& target);
 
+        /**
+         * @brief Enables gradient checkpointing: forward keeps only the outputs
+         *        of every stride-th layer, and backprop recomputes the layers in
+         *        between, one segment at a time. Gradients are unchanged.
+         * @param stride Layers per segment; 0 or 1 keeps every activation (default)
+         */
+        void setCheckpointStride(size_t stride);
+
+        /**
+         * @brief Keeps every activation if that fits the budget, otherwise picks
+         *        the checkpoint stride with the lowest estimated peak activation
+         *        memory (every stride > 1 costs the same single recomputation).
+         * @param budgetBytes Activation memory budget
+         * @param batchSize Rows per training call the budget is planned for
+         * @return The chosen stride
+         */
+        size_t setCheckpointMemoryBudget(size_t budgetBytes, size_t batchSize);
+
+        /**
+         * @return Current checkpoint stride (1 = checkpointing disabled).
+         */
+        size_t checkpointStride() const;
+
+        /**
+         * @brief Estimated peak activation bytes of one training call.
+         * @param stride Checkpoint stride to evaluate
+         * @param batchSize Rows per training call
+         */
+        size_t estimateActivationBytes(size_t stride, size_t batchSize) const;
+
+        /**
+         * @return Highest number of bytes held in stored layer activations
+         *         since construction or the last reset.
+         */
+        size_t peakActivationBytes() const;
+
+        /**
+         * @brief Restarts peak activation-memory tracking.
+         */
+        void resetPeakActivationBytes();
+
+        /**
+         * @return Per-layer weight matrices (inDim x outDim), mutable so callers
+         *         can load trained parameters.
+         */
+        std::vector<Matrix>& weights();
+
+        /**
+         * @return Per-layer weight matrices (inDim x outDim).
+         */
+        const std::vector<Matrix>& weights() const;
+
+        /**
+         * @return Per-layer bias vectors (1 x outDim), mutable.
+         */
+        std::vector<Matrix>& biases();
+
+        /**
+         * @return Per-layer bias vectors (1 x outDim).
+         */
+        const std::vector<Matrix>& biases() const;
+
+        /**
+         * @brief Sets the learning rate of every layer's optimizers.
+         * @param learningRate New rate, effective from the next update
+         */
+        void setLearningRate(double learningRate);
+
+        /**
+         * @return Current learning rate.
+         */
+        double learningRate() const;
+
+        /**
+         * @return Loss the network is trained with.
+         */
+        LossType lossType() const;
+
+        /**
+         * @return Number of weight layers.
+         */
+        size_t numLayers() const;
+
+        /**
+         * @return Activation of layer i.
+         */
+        ActivationType activationType(size_t i) const;
+
+        /**
+         * @brief Switches layer i between exact and fast approximate activations.
+         */
+        void setActivationPrecision(size_t i, ActivationPrecision precision);
+
+        /**
+         * @return Activation precision of layer i.
+         */
+        ActivationPrecision activationPrecision(size_t i) const;
+
+        /**
+         * @return Optimizer kind every layer was created with.
+         */
+        OptimizerType optimizerType() const;
+
+        /**
+         * @return Momentum every layer's optimizer was created with.
+         */
+        double momentum() const;
+
+        // Layer-level pieces for trainers that schedule the passes themselves
+        // (e.g. PipelineTrainer). Unlike trainSample, gradients are computed
+        // with the current weights and applied separately.
+
+        /**
+         * @brief net = in * W_i + b_i, out = act_i(net).
+         */
+        void forwardLayer(size_t i, const Matrix& in, Matrix& net, Matrix& out) const;
+
+        /**
+         * @brief Adds layer i's weight and bias gradients into dW and dB
+         *        (assigned if empty) and optionally propagates the gradient.
+         * @param input The input layer i saw in forward
+         * @param net Layer i's pre-activation from the same forward
+         * @param grad In: dL/dOut. Out: dL/dIn if propagate, else dL/dNet
+         * @param propagate False skips the dL/dIn product (e.g. for layer 0)
+         */
+        void accumulateLayerGradients(size_t i, const Matrix& input, const Matrix& net,
+            Matrix& grad, Matrix& dW, Matrix& dB, bool propagate = true) const;
+
+        /**
+         * @brief Applies gradients to layer i through its optimizers. Not
+         *        available with OptimizerType::LBFGS.
+         */
+        void applyLayerGradients(size_t i, const Matrix& dW, const Matrix& dB);
+
+        /**
+         * @brief Full-batch loss and gradients at the current parameters, all
+         *        taken before any update (unlike trainSample, which updates
+         *        each layer before propagating through it).
+         * @param input A (batch x input_dim) matrix
+         * @param target A (batch x output_dim) matrix
+         * @param dW Set to one dL/dW_i per layer
+         * @param dB Set to one dL/db_i per layer
+         * @return The loss on the batch
+         */
+        double computeGradients(const Matrix& input, const Matrix& target,
+            std::vector<Matrix>& dW, std::vector<Matrix>& dB) const;
+
     private:
         std::vector<Matrix> m_weights;   ///< Weight matrices
         std::vector<Matrix> m_biases;    ///< Bias vectors
+        std::vector<ActivationType> m_activationTypes;
+        std::vector<ActivationPrecision> m_activationPrecisions;
         std::vector<ActivationFunction> m_activations;
-        std::vector<Matrix> m_layerNetInputs;   ///< Pre-activation net inputs
-        std::vector<Matrix> m_layerOutputs;     ///< Post-activation outputs
+        std::vector<Matrix> m_layerNetInputs;   ///< Pre-activation net inputs (empty if not stored)
+        std::vector<Matrix> m_layerOutputs;     ///< Post-activation outputs (empty if not stored)
+
+        size_t m_checkpointStride = 1;
+        size_t m_peakActivationBytes = 0;
 
+        LossType m_lossType;
         LossFunction m_lossFunc;
+        OptimizerType m_optimizerType;
+        double m_momentum;
 
         // Each layer has its own optimizer for W and B
         std::vector<std::unique_ptr<Optimizer>> m_optimizersW;
         std::vector<std::unique_ptr<Optimizer>> m_optimizersB;
+        std::unique_ptr<Lbfgs> m_lbfgs;   ///< Set for OptimizerType::LBFGS
+
+        /**
+         * @brief One L-BFGS step on the full batch (input, target).
+         */
+        double trainLbfgs(const Matrix& input, const Matrix& target);
+
+        /**
+         * @brief Loss and flattened gradient (W_0, b_0, W_1, ...) on a batch
+         *        at the current parameters; does not update anything.
+         */
+        double lossAndGradient(const Matrix& input, const Matrix& target,
+            std::vector<double>& grad) const;
+
+        /**
+         * @brief Backprop through layer i: turns gradOut (dL/dOut) into dL/dNet,
+         *        updates W_i and b_i, then sets gradOut to dL/dIn.
+         */
+        void backwardLayer(size_t i, const Matrix& input, Matrix& gradOut);
+
+        /**
+         * @return True if layer i's output is kept by forward.
+         */
+        bool isCheckpoint(size_t i) const;
+
+        /**
+         * @brief Updates the peak with the bytes currently stored.
+         */
+        void trackActivationMemory();
     };
 
 }  // namespace nn
@@ -0,0 +1,210 @@
+#ifndef MY_NEURAL_NET_ONLINE_LEARNING_H_
+#define MY_NEURAL_NET_ONLINE_LEARNING_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "matrix.h"
+#include "neural_network.h"
+#include "threading.h"
+
+/**
+ * @file online_learning.h
+ * @brief Training on a live sample stream while serving from published snapshots.
+ */
+
+namespace nn {
+
+	/**
+	 * @struct ModelSnapshot
+	 * @brief Immutable copy of a network's parameters, enough to predict.
+	 */
+	struct ModelSnapshot {
+		std::vector<Matrix> weights;
+		std::vector<Matrix> biases;
+		std::vector<ActivationType> activations;
+		std::vector<ActivationPrecision> precisions;
+		size_t version = 0;   ///< 1 for the initial snapshot, +1 per publish
+		size_t steps = 0;     ///< Training steps the parameters include
+
+		ModelSnapshot(const NeuralNetwork& net, size_t version, size_t steps);
+
+		/**
+		 * @brief Same result as NeuralNetwork::predict on the copied network.
+		 */
+		Matrix predict(const Matrix& input) const;
+	};
+
+	/**
+	 * @class SampleSource
+	 * @brief Stream of (input, target) pairs consumed by the OnlineLearner.
+	 */
+	class SampleSource {
+	public:
+		virtual ~SampleSource() = default;
+
+		/**
+		 * @brief Blocks until a sample is available.
+		 * @return False once the source is closed and drained
+		 */
+		virtual bool next(Matrix& input, Matrix& target) = 0;
+
+		/**
+		 * @brief Ends the stream; wakes a blocked next(). Thread-safe.
+		 */
+		virtual void close() = 0;
+	};
+
+	/**
+	 * @class QueueSampleSource
+	 * @brief In-process stream: producers push, the learner pops.
+	 */
+	class QueueSampleSource : public SampleSource {
+	public:
+		/**
+		 * @param capacity push() blocks while this many samples are queued
+		 */
+		explicit QueueSampleSource(size_t capacity = 4096);
+
+		/**
+		 * @brief Enqueues a sample. @return False if the source is closed.
+		 */
+		bool push(Matrix input, Matrix target);
+
+		bool next(Matrix& input, Matrix& target) override;
+		void close() override;
+
+	private:
+		size_t m_capacity;
+		bool m_closed = false;
+		std::deque<std::pair<Matrix, Matrix>> m_samples;
+		std::mutex m_mutex;
+		std::condition_variable m_notEmpty;
+		std::condition_variable m_notFull;
+	};
+
+	/**
+	 * @class FileTailSampleSource
+	 * @brief Follows a text file like `tail -f`: each line holds inputDim
+	 *        then outputDim numbers separated by spaces or commas. At the end
+	 *        of the file it polls for appended lines until closed.
+	 *
+	 * Blank lines and lines starting with '#' are ignored; lines with the
+	 * wrong count of numbers are skipped and counted.
+	 */
+	class FileTailSampleSource : public SampleSource {
+	public:
+		FileTailSampleSource(const std::string& path, size_t inputDim, size_t outputDim,
+			int pollMilliseconds = 20);
+
+		bool next(Matrix& input, Matrix& target) override;
+		void close() override;
+
+		/**
+		 * @return Malformed lines skipped so far.
+		 */
+		size_t skippedLines() const { return m_skipped; }
+
+	private:
+		std::string m_path;
+		std::ifstream m_file;
+		size_t m_inputDim;
+		size_t m_outputDim;
+		int m_pollMilliseconds;
+		std::string m_partial;   ///< Unterminated last line seen so far
+		size_t m_skipped = 0;
+		std::atomic<bool> m_closed{ false };
+
+		bool parse(const std::string& line, Matrix& input, Matrix& target);
+	};
+
+	/**
+	 * @struct OnlineLearnerConfig
+	 * @brief How often the OnlineLearner trains and publishes.
+	 */
+	struct OnlineLearnerConfig {
+		size_t batchSize = 1;          ///< Samples per trainSample call
+		size_t publishInterval = 100;  ///< Training steps between snapshots
+		size_t maxReaders = 64;        ///< Concurrent snapshot readers
+	};
+
+	/**
+	 * @class OnlineLearner
+	 * @brief Trains a network on a SampleSource in a background thread and
+	 *        publishes a ModelSnapshot every publishInterval steps.
+	 *
+	 * Readers call snapshot() or predict() from any thread; they never lock
+	 * and never wait for training. While running, the network itself
+	 * belongs to the training thread.
+	 */
+	class OnlineLearner {
+	public:
+		/**
+		 * @param net Network to train (must outlive the learner; not LBFGS)
+		 * @param source Sample stream (must outlive the learner)
+		 */
+		OnlineLearner(NeuralNetwork& net, SampleSource& source,
+			const OnlineLearnerConfig& config = OnlineLearnerConfig());
+
+		/**
+		 * @brief Calls stop().
+		 */
+		~OnlineLearner();
+
+		OnlineLearner(const OnlineLearner&) = delete;
+		OnlineLearner& operator=(const OnlineLearner&) = delete;
+
+		/**
+		 * @brief Starts the training thread.
+		 */
+		void start();
+
+		/**
+		 * @brief Closes the source, trains on what is left, publishes a final
+		 *        snapshot and joins the thread.
+		 */
+		void stop();
+
+		/**
+		 * @brief Pins the newest snapshot for as long as the guard lives.
+		 */
+		SnapshotCell<ModelSnapshot>::ReadGuard snapshot() const;
+
+		/**
+		 * @brief predict on the newest snapshot.
+		 */
+		Matrix predict(const Matrix& input) const;
+
+		/**
+		 * @return Training steps done so far.
+		 */
+		size_t steps() const { return m_steps.load(std::memory_order_relaxed); }
+
+		/**
+		 * @return Version of the newest snapshot.
+		 */
+		size_t version() const { return m_version.load(std::memory_order_acquire); }
+
+	private:
+		NeuralNetwork& m_net;
+		SampleSource& m_source;
+		OnlineLearnerConfig m_config;
+		SnapshotCell<ModelSnapshot> m_snapshots;
+		std::thread m_thread;
+		std::atomic<size_t> m_steps{ 0 };
+		std::atomic<size_t> m_version{ 0 };
+
+		void run();
+		void publish();
+	};
+
+}  // namespace nn
+
+#endif  // MY_NEURAL_NET_ONLINE_LEARNING_H_
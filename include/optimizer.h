@@ -17,7 +17,8 @@ namespace nn {
 	 */
 	enum class OptimizerType {
 		SGD,
-		Momentum
+		Momentum,
+		LBFGS   ///< Full-batch quasi-Newton over all parameters (see lbfgs.h)
 	};
 
 	/**
@@ -34,6 +35,17 @@ namespace nn {
 		 * @param grad Gradient wrt weights
 		 */
 		virtual void update(Matrix& w, const Matrix& grad) = 0;
+
+		/**
+		 * @brief Changes the learning rate used by subsequent updates
+		 *        (e.g. from a learning-rate schedule).
+		 */
+		virtual void setLearningRate(double lr) = 0;
+
+		/**
+		 * @return Current learning rate.
+		 */
+		virtual double learningRate() const = 0;
 	};
 
 	/**
@@ -52,6 +64,9 @@ namespace nn {
 		 */
 		void update(Matrix& w, const Matrix& grad) override;
 
+		void setLearningRate(double lr) override;
+		double learningRate() const override;
+
 	private:
 		double m_lr;
 	};
@@ -74,6 +89,9 @@ namespace nn {
 		 */
 		void update(Matrix& w, const Matrix& grad) override;
 
+		void setLearningRate(double lr) override;
+		double learningRate() const override;
+
 	private:
 		double m_lr;
 		double m_momentum;
@@ -82,7 +100,8 @@ namespace nn {
 
 	/**
 	 * @brief Factory function for creating an optimizer.
-	 * @param type Which optimizer to create (SGD or Momentum)
+	 * @param type Which optimizer to create (SGD or Momentum; LBFGS needs the
+	 *        whole parameter vector and has no per-tensor form)
 	 * @param lr Learning rate
 	 * @param momentum Momentum factor (only used for Momentum optimizer)
 	 * @return Unique pointer to the optimizer
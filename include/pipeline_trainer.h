@@ -0,0 +1,116 @@
+#ifndef MY_NEURAL_NET_PIPELINE_TRAINER_H_
+#define MY_NEURAL_NET_PIPELINE_TRAINER_H_
+
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "matrix.h"
+#include "neural_network.h"
+#include "threading.h"
+
+/**
+ * @file pipeline_trainer.h
+ * @brief Pipeline-parallel training of one NeuralNetwork across pinned threads.
+ */
+
+namespace nn {
+
+	/**
+	 * @enum PipelineSchedule
+	 * @brief Order in which a stage interleaves micro-batch passes.
+	 */
+	enum class PipelineSchedule {
+		GPipe,     ///< All forwards, then all backwards
+		OneFOneB   ///< Alternate one forward / one backward after a short warmup
+	};
+
+	/**
+	 * @struct PipelineConfig
+	 * @brief Stage, micro-batch and thread placement settings.
+	 */
+	struct PipelineConfig {
+		size_t numStages = 2;       ///< Capped at the number of layers
+		size_t microBatches = 4;    ///< Per trainBatch call (capped at its rows)
+		PipelineSchedule schedule = PipelineSchedule::OneFOneB;
+		bool pinThreads = true;     ///< Pin stage s to core firstCore + s
+		size_t firstCore = 0;
+	};
+
+	/**
+	 * @class PipelineTrainer
+	 * @brief Splits a NeuralNetwork into contiguous layer ranges, one per
+	 *        persistent (optionally core-pinned) stage thread, and streams
+	 *        micro-batches through them.
+	 *
+	 * Activations flow forward and gradients backward through lock-free
+	 * single-producer/single-consumer queues between neighbouring stages.
+	 * The network is not copied: each stage touches only its own layers.
+	 * Gradients of all micro-batches are summed per stage and applied once
+	 * at the end of trainBatch (a synchronous pipeline flush), so one call
+	 * is exactly one optimizer step on the full mini-batch, whichever
+	 * schedule runs it. 1F1B keeps at most (numStages - s) micro-batches of
+	 * activations alive on stage s instead of all of them.
+	 */
+	class PipelineTrainer {
+	public:
+		/**
+		 * @param net Network to train in place (must outlive the trainer; not LBFGS)
+		 * @param config Pipeline settings
+		 */
+		PipelineTrainer(NeuralNetwork& net, const PipelineConfig& config = PipelineConfig());
+		~PipelineTrainer();
+
+		PipelineTrainer(const PipelineTrainer&) = delete;
+		PipelineTrainer& operator=(const PipelineTrainer&) = delete;
+
+		/**
+		 * @brief One optimizer step on a mini-batch, pipelined over the stages.
+		 * @param input (batch x input_dim)
+		 * @param target (batch x output_dim)
+		 * @return Loss averaged over the batch
+		 */
+		double trainBatch(const Matrix& input, const Matrix& target);
+
+		/**
+		 * @return [first, last) layer range of each stage.
+		 */
+		const std::vector<std::pair<size_t, size_t>>& stageLayers() const;
+
+		/**
+		 * @return Largest number of micro-batches whose activations a stage
+		 *         held at once during the last trainBatch.
+		 */
+		size_t peakInFlight() const;
+
+	private:
+		struct Stage;
+
+		NeuralNetwork& m_net;
+		PipelineConfig m_config;
+		std::vector<std::pair<size_t, size_t>> m_ranges;
+		std::vector<std::unique_ptr<Stage>> m_stages;
+		std::vector<std::thread> m_threads;
+
+		// Per-call work, read by the stages
+		std::vector<Matrix> m_microInputs;
+		std::vector<Matrix> m_microTargets;
+		size_t m_totalRows = 0;
+
+		std::mutex m_mutex;
+		std::condition_variable m_startCv;
+		std::condition_variable m_doneCv;
+		size_t m_generation = 0;
+		size_t m_pending = 0;
+		bool m_stop = false;
+
+		void stageMain(size_t s);
+		void runStage(size_t s);
+	};
+
+}  // namespace nn
+
+#endif  // MY_NEURAL_NET_PIPELINE_TRAINER_H_
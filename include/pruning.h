@@ -0,0 +1,128 @@
+#ifndef MY_NEURAL_NET_PRUNING_H_
+#define MY_NEURAL_NET_PRUNING_H_
+
+#include <cstddef>
+#include <vector>
+#include "matrix.h"
+#include "neural_network.h"
+#include "sparse_matrix.h"
+
+/**
+ * @file pruning.h
+ * @brief Magnitude pruning of NeuralNetwork weights and a sparse inference network.
+ */
+
+namespace nn {
+
+	/**
+	 * @brief Zeroes the floor(sparsity * size) smallest-magnitude entries of w.
+	 * @param w Weights to prune in place
+	 * @param sparsity Fraction in [0, 1]
+	 * @return Number of entries zeroed (including ones that already were 0)
+	 */
+	size_t pruneByMagnitude(Matrix& w, double sparsity);
+
+	/**
+	 * @struct PruningSchedule
+	 * @brief Gradual pruning: sparsity rises from 0 to finalSparsity between
+	 *        beginStep and endStep along s(t) = s_f (1 - (1 - p)^3), p the
+	 *        fraction of the window elapsed, so most weights go early while
+	 *        the network can still recover.
+	 */
+	struct PruningSchedule {
+		double finalSparsity = 0.8;
+		size_t beginStep = 0;
+		size_t endStep = 1000;
+		size_t frequency = 100;   ///< Steps between mask updates
+	};
+
+	/**
+	 * @class MagnitudePruner
+	 * @brief Prunes every layer of a network to a target sparsity, one shot or
+	 *        along a PruningSchedule, and keeps pruned weights at zero through
+	 *        later optimizer updates.
+	 */
+	class MagnitudePruner {
+	public:
+		/**
+		 * @param net Network to prune (must outlive the pruner)
+		 * @param schedule Gradual schedule used by step()
+		 */
+		explicit MagnitudePruner(NeuralNetwork& net,
+			const PruningSchedule& schedule = PruningSchedule());
+
+		/**
+		 * @brief Call after every training update: advances the schedule,
+		 *        prunes further when due and re-zeroes pruned weights.
+		 */
+		void step();
+
+		/**
+		 * @brief One-shot: prunes every layer to sparsity now.
+		 */
+		void pruneTo(double sparsity);
+
+		/**
+		 * @return Scheduled sparsity at a step.
+		 */
+		double targetSparsity(size_t step) const;
+
+		/**
+		 * @return Fraction of zero weights over all layers.
+		 */
+		double sparsity() const;
+
+	private:
+		NeuralNetwork& m_net;
+		PruningSchedule m_schedule;
+		size_t m_step = 0;
+		std::vector<std::vector<bool>> m_pruned;   ///< Per layer, per weight
+
+		void applyMasks();
+	};
+
+	/**
+	 * @class SparseNetwork
+	 * @brief Inference-only copy of a (pruned) NeuralNetwork whose sparse
+	 *        layers are stored in CSR and multiplied with sparse kernels.
+	 *        Layers denser than maxDensity stay dense.
+	 */
+	class SparseNetwork {
+	public:
+		/**
+		 * @param net Trained network
+		 * @param maxDensity Layers with at most this fraction of non-zeros go sparse
+		 */
+		explicit SparseNetwork(const NeuralNetwork& net, double maxDensity = 0.5);
+
+		/**
+		 * @brief Forward pass, same result as net.predict.
+		 * @param input (batch x input_dim)
+		 */
+		Matrix predict(const Matrix& input) const;
+
+		/**
+		 * @return True if layer i uses the sparse kernel.
+		 */
+		bool isSparse(size_t i) const;
+
+		/**
+		 * @return Bytes of all weights and biases as stored.
+		 */
+		size_t bytes() const;
+
+	private:
+		struct SparseLayer {
+			bool sparse = false;
+			SparseMatrix sparseWeights;
+			Matrix denseWeights;
+			Matrix biases;
+			ActivationType activation;
+			ActivationPrecision precision;
+		};
+		std::vector<SparseLayer> m_layers;
+	};
+
+}  // namespace nn
+
+#endif  // MY_NEURAL_NET_PRUNING_H_
@@ -0,0 +1,100 @@
+#ifndef MY_NEURAL_NET_RANDOM_H_
+#define MY_NEURAL_NET_RANDOM_H_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include "matrix.h"
+#include "activation.h"
+
+/**
+ * @file random.h
+ * @brief Counter-based random number generation and weight initializers.
+ */
+
+namespace nn {
+
+	/**
+	 * @brief Philox-4x32-10 block function (Salmon et al., SC'11).
+	 *
+	 * Maps a 128-bit counter and a 64-bit key to 128 random bits with no
+	 * hidden state, so any element of a random tensor can be generated
+	 * independently, by any thread, in any order.
+	 * @param counter Four 32-bit counter words
+	 * @param key Two 32-bit key words
+	 * @return Four 32-bit random words
+	 */
+	std::array<uint32_t, 4> philox4x32(std::array<uint32_t, 4> counter,
+		std::array<uint32_t, 2> key);
+
+	/**
+	 * @brief Sets the seed used for matrices created with randomize = true and
+	 *        for networks that are not given an explicit seed. Also restarts
+	 *        the tensor-ID sequence, so a program that builds its models in a
+	 *        fixed order gets bit-identical parameters on every run.
+	 */
+	void setGlobalSeed(uint64_t seed);
+
+	/**
+	 * @return The current global seed.
+	 */
+	uint64_t globalSeed();
+
+	/**
+	 * @brief Hands out a fresh tensor ID for the global seed (thread-safe).
+	 */
+	uint64_t nextTensorId();
+
+	/**
+	 * @brief Derives an independent 64-bit seed from a seed and a stream index
+	 *        (SplitMix64 finalizer).
+	 */
+	uint64_t mixSeed(uint64_t seed, uint64_t stream);
+
+	/**
+	 * @brief Fills m with U[low, high) samples keyed by (seed, tensorId).
+	 *
+	 * Element i depends only on (seed, tensorId, i); large matrices are filled
+	 * in parallel and the result is bit-identical at any thread count.
+	 */
+	void fillUniform(Matrix& m, uint64_t seed, uint64_t tensorId,
+		double low = -1.0, double high = 1.0);
+
+	/**
+	 * @brief Fills m with N(mean, stddev^2) samples keyed by (seed, tensorId),
+	 *        with the same reproducibility guarantees as fillUniform.
+	 */
+	void fillNormal(Matrix& m, uint64_t seed, uint64_t tensorId,
+		double mean = 0.0, double stddev = 1.0);
+
+	/**
+	 * @enum InitType
+	 * @brief Weight initialization schemes.
+	 */
+	enum class InitType {
+		Uniform,        ///< U[-1, 1]
+		XavierUniform,  ///< U[-a, a], a = sqrt(6 / (fanIn + fanOut)) (Glorot & Bengio)
+		HeNormal        ///< N(0, 2 / fanIn) (He et al.)
+	};
+
+	/**
+	 * @brief Initializer matched to an activation: He for ReLU, Xavier for
+	 *        the saturating Sigmoid and Tanh and for Linear.
+	 */
+	InitType defaultInitFor(ActivationType type);
+
+	/**
+	 * @brief Initializes a weight matrix with explicit fan-in/fan-out (for
+	 *        storage layouts that are not plain inDim x outDim).
+	 */
+	void initializeWeights(Matrix& w, InitType type, size_t fanIn, size_t fanOut,
+		uint64_t seed, uint64_t tensorId);
+
+	/**
+	 * @brief Initializes an (inDim x outDim) weight matrix.
+	 */
+	void initializeWeights(Matrix& w, InitType type, uint64_t seed, uint64_t tensorId);
+
+}  // namespace nn
+
+#endif  // MY_NEURAL_NET_RANDOM_H_
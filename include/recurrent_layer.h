@@ -0,0 +1,173 @@
+#ifndef MY_NEURAL_NET_RECURRENT_LAYER_H_
+#define MY_NEURAL_NET_RECURRENT_LAYER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "matrix.h"
+#include "layer.h"
+
+/**
+ * @file recurrent_layer.h
+ * @brief LSTM and GRU layers with hoisted input projections and fused gates.
+ */
+
+namespace nn {
+
+	/**
+	 * @class RecurrentLayer
+	 * @brief Shared machinery of the gated recurrent layers.
+	 *
+	 * Each input row is one sequence of `seqLength` steps of `inputSize`
+	 * features (step-major), so the whole batch is a (batch * seqLength x
+	 * inputSize) matrix in place. The input projection x_t * Wx for every
+	 * step of every sequence is therefore a single GEMM issued before the
+	 * time loop; inside the loop each step issues one GEMM, h_{t-1} * Wh,
+	 * producing all gates at once, followed by one fused pass that adds
+	 * biases, applies the gate nonlinearities and updates the state.
+	 *
+	 * Biases follow the cuDNN convention of separate input (bx) and
+	 * recurrent (bh) vectors. Backward is truncated BPTT: with
+	 * `bpttSteps` > 0 only the last `bpttSteps` steps receive gradients.
+	 * The input-side weight and input gradients are again accumulated
+	 * once over all those steps after the time loop.
+	 */
+	class RecurrentLayer : public Layer {
+	public:
+		size_t outputWidth(const std::vector<size_t>& inputWidths) const override;
+		std::vector<size_t> savedWidths(const std::vector<size_t>& inputWidths) const override;
+		void forward(const std::vector<const Matrix*>& inputs, Matrix& output,
+			const std::vector<Matrix*>& saved, bool training) override;
+		void backward(const std::vector<const Matrix*>& inputs,
+			const std::vector<Matrix*>& saved, Matrix& gradOutput,
+			const std::vector<Matrix*>& gradInputs) override;
+		std::vector<std::pair<Matrix*, Matrix*>> parameters() override;
+
+		size_t hiddenSize() const { return m_hidden; }
+		size_t seqLength() const { return m_seqLength; }
+
+		Matrix& inputWeights() { return m_wx; }       ///< inputSize x (gates * hidden)
+		Matrix& recurrentWeights() { return m_wh; }   ///< hidden x (gates * hidden)
+
+	protected:
+		/**
+		 * @param inputSize Features per step
+		 * @param hiddenSize Hidden units
+		 * @param seqLength Steps per sequence
+		 * @param numGates 4 for LSTM, 3 for GRU
+		 * @param returnSequences Output every step's h (else only the last)
+		 * @param bpttSteps Truncation window (0 = full sequence)
+		 * @param seed Initialization seed
+		 */
+		RecurrentLayer(size_t inputSize, size_t hiddenSize, size_t seqLength, size_t numGates,
+			bool returnSequences, size_t bpttSteps, uint64_t seed);
+
+		/**
+		 * @brief Fused gate kernel for step t over the whole batch.
+		 * @param gates Row s at gates + s * gateStride holds x_t * Wx for the
+		 *        step; overwrite with whatever stepBackward needs
+		 * @param recurrent (batch x gates*hidden) h_{t-1} * Wh (zero at t = 0)
+		 * @param hPrev (batch x hidden), nullptr at t = 0
+		 * @param h (batch x hidden) new hidden state
+		 * @param aux (batch x hidden) layer-specific per-step state
+		 * @param auxPrev aux of step t - 1, nullptr at t = 0
+		 */
+		virtual void stepForward(size_t batch, double* gates, size_t gateStride,
+			const double* recurrent, const double* hPrev, double* h,
+			double* aux, const double* auxPrev) = 0;
+
+		/**
+		 * @brief Gate backward for one step.
+		 * @param gates As left by stepForward; overwrite with dL/d(x_t * Wx)
+		 * @param dh In: dL/dh_t. Out: the part of dL/dh_{t-1} that bypasses Wh
+		 * @param dRecurrent Out: dL/d(h_{t-1} * Wh + bh)
+		 */
+		virtual void stepBackward(size_t batch, double* gates, size_t gateStride,
+			const double* hPrev, const double* h, const double* aux, const double* auxPrev,
+			double* dh, double* dRecurrent) = 0;
+
+		/**
+		 * @brief Resets any state carried between stepBackward calls.
+		 */
+		virtual void beginBackward(size_t batch) { (void)batch; }
+
+		size_t m_input;
+		size_t m_hidden;
+		size_t m_seqLength;
+		size_t m_numGates;
+		bool m_returnSequences;
+		size_t m_bpttSteps;
+
+		Matrix m_wx;
+		Matrix m_wh;
+		Matrix m_bx;        ///< 1 x (gates * hidden)
+		Matrix m_bh;        ///< 1 x (gates * hidden)
+		Matrix m_gradWx;
+		Matrix m_gradWh;
+		Matrix m_gradBx;
+		Matrix m_gradBh;
+
+	private:
+		// Per-batch workspace (grown on demand, never shrunk)
+		std::vector<double> m_recurrent;   ///< batch x gates*hidden
+		std::vector<double> m_dh;          ///< batch x hidden
+		std::vector<double> m_weightT;     ///< Wh^T during the time loop, then Wx^T
+		std::vector<double> m_operandT;    ///< h_{t-1}^T, then the window's X^T
+		std::vector<double> m_product;     ///< GEMM result before it is accumulated
+		std::vector<double> m_windowX;     ///< Inputs of a truncated window, packed
+		std::vector<double> m_windowGates; ///< Gate gradients of a truncated window, packed
+	};
+
+	/**
+	 * @class LSTMLayer
+	 * @brief Long short-term memory (gates i, f, g, o; forget bias starts at 1).
+	 *
+	 * aux is the cell state c_t.
+	 */
+	class LSTMLayer : public RecurrentLayer {
+	public:
+		LSTMLayer(size_t inputSize, size_t hiddenSize, size_t seqLength,
+			bool returnSequences = false, size_t bpttSteps = 0);
+		LSTMLayer(size_t inputSize, size_t hiddenSize, size_t seqLength,
+			bool returnSequences, size_t bpttSteps, uint64_t seed);
+
+	protected:
+		void stepForward(size_t batch, double* gates, size_t gateStride,
+			const double* recurrent, const double* hPrev, double* h,
+			double* aux, const double* auxPrev) override;
+		void stepBackward(size_t batch, double* gates, size_t gateStride,
+			const double* hPrev, const double* h, const double* aux, const double* auxPrev,
+			double* dh, double* dRecurrent) override;
+		void beginBackward(size_t batch) override;
+
+	private:
+		std::vector<double> m_dc;  ///< dL/dc carried to the previous step
+	};
+
+	/**
+	 * @class GRULayer
+	 * @brief Gated recurrent unit (gates r, z, n) with the reset gate applied
+	 *        after the recurrent product, n = tanh(Wx_n x + r * (Wh_n h + bh_n)),
+	 *        as cuDNN does, so every step still needs only one recurrent GEMM.
+	 *
+	 * aux is the recurrent candidate term Wh_n h_{t-1} + bh_n.
+	 */
+	class GRULayer : public RecurrentLayer {
+	public:
+		GRULayer(size_t inputSize, size_t hiddenSize, size_t seqLength,
+			bool returnSequences = false, size_t bpttSteps = 0);
+		GRULayer(size_t inputSize, size_t hiddenSize, size_t seqLength,
+			bool returnSequences, size_t bpttSteps, uint64_t seed);
+
+	protected:
+		void stepForward(size_t batch, double* gates, size_t gateStride,
+			const double* recurrent, const double* hPrev, double* h,
+			double* aux, const double* auxPrev) override;
+		void stepBackward(size_t batch, double* gates, size_t gateStride,
+			const double* hPrev, const double* h, const double* aux, const double* auxPrev,
+			double* dh, double* dRecurrent) override;
+	};
+
+}  // namespace nn
+
+#endif  // MY_NEURAL_NET_RECURRENT_LAYER_H_
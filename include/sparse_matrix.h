@@ -0,0 +1,71 @@
+#ifndef MY_NEURAL_NET_SPARSE_MATRIX_H_
+#define MY_NEURAL_NET_SPARSE_MATRIX_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "matrix.h"
+
+/**
+ * @file sparse_matrix.h
+ * @brief Compressed sparse row storage for pruned weight matrices.
+ */
+
+namespace nn {
+
+	/**
+	 * @class SparseMatrix
+	 * @brief CSR matrix: the non-zeros of row r are values[rowStart[r] ..
+	 *        rowStart[r + 1]) at columns colIndex[...], in increasing column order.
+	 */
+	class SparseMatrix {
+	public:
+		SparseMatrix() = default;
+
+		/**
+		 * @brief Keeps the entries of dense whose magnitude exceeds threshold.
+		 */
+		static SparseMatrix fromDense(const Matrix& dense, double threshold = 0.0);
+
+		/**
+		 * @return Dense copy.
+		 */
+		Matrix toDense() const;
+
+		/**
+		 * @brief Y = X * W for dense X (batch x rows) and this W (rows x cols).
+		 *
+		 * Scatter form: each X(r, k) scales row k of W into row r of Y, so a
+		 * pruned weight costs nothing and Y rows are filled in parallel.
+		 */
+		static void multiply(const Matrix& X, const SparseMatrix& W, Matrix& Y);
+
+		size_t rows() const { return m_rows; }
+		size_t cols() const { return m_cols; }
+
+		/**
+		 * @return Stored entries.
+		 */
+		size_t nonZeros() const { return m_values.size(); }
+
+		/**
+		 * @return nonZeros() / (rows * cols).
+		 */
+		double density() const;
+
+		/**
+		 * @return Storage bytes (values, column indices and row offsets).
+		 */
+		size_t bytes() const;
+
+	private:
+		size_t m_rows = 0;
+		size_t m_cols = 0;
+		std::vector<size_t> m_rowStart;     ///< rows + 1 offsets
+		std::vector<uint32_t> m_colIndex;
+		std::vector<double> m_values;
+	};
+
+}  // namespace nn
+
+#endif  // MY_NEURAL_NET_SPARSE_MATRIX_H_
@@ -0,0 +1,335 @@
+#ifndef MY_NEURAL_NET_STATIC_NEURAL_NETWORK_H_
+#define MY_NEURAL_NET_STATIC_NEURAL_NETWORK_H_
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <tuple>
+#include <utility>
+#include <vector>
+#include "matrix.h"
+#include "activation.h"
+#include "loss.h"
+#include "optimizer.h"
+#include "random.h"
+
+/**
+ * @file static_neural_network.h
+ * @brief A fully-connected network whose topology is fixed at compile time.
+ */
+
+namespace nn {
+
+	/**
+	 * @struct Activations
+	 * @brief Compile-time list of per-layer activations, e.g.
+	 *        Activations<ActivationType::ReLU, ActivationType::Sigmoid>.
+	 */
+	template <ActivationType... Types>
+	struct Activations {};
+
+	namespace detail {
+
+		template <size_t I, size_t... Sizes>
+		constexpr size_t sizeAt() {
+			constexpr size_t values[] = { Sizes... };
+			return values[I];
+		}
+
+		template <size_t I, ActivationType... Types>
+		constexpr ActivationType activationAt() {
+			constexpr ActivationType values[] = { Types... };
+			return values[I];
+		}
+
+		/**
+		 * @struct StaticDenseLayer
+		 * @brief Parameters, optimizer state and cached activations of one layer,
+		 *        all held inline in std::array storage.
+		 */
+		template <size_t In, size_t Out, ActivationType Act>
+		struct StaticDenseLayer {
+			using Traits = ActivationTraits<Act>;
+
+			std::array<double, In * Out> weights{};   ///< Row-major (In x Out)
+			std::array<double, Out> biases{};
+			std::array<double, In * Out> velocityW{}; ///< Momentum state for weights
+			std::array<double, Out> velocityB{};      ///< Momentum state for biases
+			std::array<double, Out> net{};            ///< Pre-activation net input
+			std::array<double, Out> out{};            ///< Post-activation output
+			std::array<double, Out> delta{};          ///< dL/dOut, then dL/dNet
+
+			/**
+			 * @brief net = input * W + b, out = act(net).
+			 */
+			void forward(const double* input) {
+				net.fill(0.0);
+				for (size_t i = 0; i < In; ++i) {
+					const double x = input[i];
+					for (size_t j = 0; j < Out; ++j) {
+						net[j] += x * weights[i * Out + j];
+					}
+				}
+				for (size_t j = 0; j < Out; ++j) {
+					net[j] += biases[j];
+					out[j] = Traits::forward(net[j]);
+				}
+			}
+
+			/**
+			 * @brief Turns delta into dL/dNet and applies the parameter update.
+			 * @param input The input this layer saw during forward
+			 */
+			template <bool UseMomentum>
+			void update(const double* input, double lr, double momentum) {
+				for (size_t j = 0; j < Out; ++j) {
+					delta[j] *= Traits::derivative(net[j]);
+				}
+				for (size_t i = 0; i < In; ++i) {
+					const double x = input[i];
+					for (size_t j = 0; j < Out; ++j) {
+						step<UseMomentum>(weights[i * Out + j], velocityW[i * Out + j],
+							x * delta[j], lr, momentum);
+					}
+				}
+				for (size_t j = 0; j < Out; ++j) {
+					step<UseMomentum>(biases[j], velocityB[j], delta[j], lr, momentum);
+				}
+			}
+
+			/**
+			 * @brief prevDelta = delta * W^T (using the already-updated weights,
+			 *        as NeuralNetwork::trainSample does).
+			 */
+			void propagate(double* prevDelta) const {
+				for (size_t i = 0; i < In; ++i) {
+					double sum = 0.0;
+					for (size_t j = 0; j < Out; ++j) {
+						sum += delta[j] * weights[i * Out + j];
+					}
+					prevDelta[i] = sum;
+				}
+			}
+
+			template <bool UseMomentum>
+			static void step(double& w, double& v, double grad, double lr, double momentum) {
+				if constexpr (UseMomentum) {
+					v = momentum * v - lr * grad;
+					w += v;
+				}
+				else {
+					w -= lr * grad;
+				}
+			}
+		};
+
+		template <typename Seq, typename Acts, size_t... Sizes>
+		struct StaticLayerTuple;
+
+		template <size_t... I, ActivationType... Types, size_t... Sizes>
+		struct StaticLayerTuple<std::index_sequence<I...>, Activations<Types...>, Sizes...> {
+			using type = std::tuple<StaticDenseLayer<
+				sizeAt<I, Sizes...>(),
+				sizeAt<I + 1, Sizes...>(),
+				activationAt<I, Types...>()>...>;
+		};
+
+	}  // namespace detail
+
+	template <typename Acts, size_t... Sizes>
+	class StaticNeuralNetwork;
+
+	/**
+	 * @class StaticNeuralNetwork
+	 * @brief Feed-forward network with compile-time layer sizes and activations,
+	 *        e.g. StaticNeuralNetwork<Activations<ReLU, ReLU, Sigmoid>, 2, 4, 4, 1>.
+	 *
+	 * Training and prediction follow NeuralNetwork exactly (single-sample
+	 * backprop, same loss and optimizer rules), but every buffer lives inside
+	 * the object and every loop has a constant trip count, so a small net does
+	 * no heap allocation and no std::function or parallel-STL dispatch.
+	 */
+	template <ActivationType... Types, size_t... Sizes>
+	class StaticNeuralNetwork<Activations<Types...>, Sizes...> {
+		static_assert(sizeof...(Sizes) >= 2, "Must have at least input & output layer");
+		static_assert(sizeof...(Types) + 1 == sizeof...(Sizes),
+			"Need one activation for each layer except input");
+
+	public:
+		static constexpr size_t kNumLayers = sizeof...(Types);
+		static constexpr size_t kInputSize = detail::sizeAt<0, Sizes...>();
+		static constexpr size_t kOutputSize = detail::sizeAt<kNumLayers, Sizes...>();
+
+		using Input = std::array<double, kInputSize>;
+		using Output = std::array<double, kOutputSize>;
+
+		/**
+		 * @brief Constructs the network with randomly initialized parameters.
+		 * @param lossType e.g. CrossEntropy
+		 * @param optType SGD or Momentum (LBFGS is not supported)
+		 * @param learningRate
+		 * @param momentum
+		 */
+		StaticNeuralNetwork(LossType lossType,
+			OptimizerType optType,
+			double learningRate = 0.1,
+			double momentum = 0.9)
+			: m_lossType(lossType), m_optType(optType),
+			m_learningRate(learningRate), m_momentum(momentum) {
+			assert(optType != OptimizerType::LBFGS && "StaticNeuralNetwork has no L-BFGS path");
+			initLayers<0>(mixSeed(globalSeed(), nextTensorId()));
+		}
+
+		/**
+		 * @brief Forward pass for a single sample.
+		 * @param input Input features
+		 * @return Reference to the output activations (valid until the next call)
+		 */
+		const Output& forward(const Input& input) {
+			forwardFrom<0>(input.data());
+			return std::get<kNumLayers - 1>(m_layers).out;
+		}
+
+		/**
+		 * @brief Forward pass taking/returning Matrix, for drop-in use where
+		 *        NeuralNetwork was used.
+		 * @param input A (1 x input_dim) matrix
+		 * @return The output matrix (1 x output_dim)
+		 */
+		Matrix forward(const Matrix& input) {
+			assert(input.rows() == 1 && input.cols() == kInputSize);
+			Input x;
+			std::copy(input.data().begin(), input.data().end(), x.begin());
+			const Output& y = forward(x);
+			Matrix result(1, kOutputSize);
+			std::copy(y.begin(), y.end(), result.data().begin());
+			return result;
+		}
+
+		/**
+		 * @brief Trains on a single sample via backprop.
+		 * @param input Input features
+		 * @param target Expected outputs
+		 * @return The scalar loss value for this sample
+		 */
+		double trainSample(const Input& input, const Output& target) {
+			const bool momentum = (m_optType == OptimizerType::Momentum);
+			if (m_lossType == LossType::CrossEntropy) {
+				return momentum
+					? train<LossType::CrossEntropy, true>(input.data(), target.data())
+					: train<LossType::CrossEntropy, false>(input.data(), target.data());
+			}
+			return momentum
+				? train<LossType::MSE, true>(input.data(), target.data())
+				: train<LossType::MSE, false>(input.data(), target.data());
+		}
+
+		/**
+		 * @brief Matrix overload of trainSample.
+		 * @param input A (1 x input_dim) matrix
+		 * @param target A (1 x output_dim) matrix
+		 * @return The scalar loss value for this sample
+		 */
+		double trainSample(const Matrix& input, const Matrix& target) {
+			assert(input.rows() == 1 && input.cols() == kInputSize);
+			assert(target.rows() == 1 && target.cols() == kOutputSize);
+			Input x;
+			Output t;
+			std::copy(input.data().begin(), input.data().end(), x.begin());
+			std::copy(target.data().begin(), target.data().end(), t.begin());
+			return trainSample(x, t);
+		}
+
+		/**
+		 * @brief Loads parameters, e.g. a NeuralNetwork's weights() and biases()
+		 *        of the same topology. Momentum state is reset to zero.
+		 * @param weights One (in x out) matrix per layer
+		 * @param biases One (1 x out) matrix per layer
+		 */
+		void setParameters(const std::vector<Matrix>& weights, const std::vector<Matrix>& biases) {
+			assert(weights.size() == kNumLayers && biases.size() == kNumLayers);
+			loadLayers<0>(weights, biases);
+		}
+
+	private:
+		using Layers = typename detail::StaticLayerTuple<
+			std::make_index_sequence<kNumLayers>, Activations<Types...>, Sizes...>::type;
+
+		Layers m_layers;
+		LossType m_lossType;
+		OptimizerType m_optType;
+		double m_learningRate;
+		double m_momentum;
+
+		// Same scheme and tensor IDs as NeuralNetwork::initializeParameters
+		template <size_t I>
+		void initLayers(uint64_t seed) {
+			auto& layer = std::get<I>(m_layers);
+			Matrix w(detail::sizeAt<I, Sizes...>(), detail::sizeAt<I + 1, Sizes...>());
+			initializeWeights(w, defaultInitFor(detail::activationAt<I, Types...>()), seed, 2 * I);
+			std::copy(w.data().begin(), w.data().end(), layer.weights.begin());
+			const double bias = (detail::activationAt<I, Types...>() == ActivationType::ReLU) ? 0.01 : 0.0;
+			layer.biases.fill(bias);
+			if constexpr (I + 1 < kNumLayers) {
+				initLayers<I + 1>(seed);
+			}
+		}
+
+		template <size_t I>
+		void loadLayers(const std::vector<Matrix>& weights, const std::vector<Matrix>& biases) {
+			auto& layer = std::get<I>(m_layers);
+			const Matrix& w = weights[I];
+			const Matrix& b = biases[I];
+			assert(w.data().size() == layer.weights.size() && b.data().size() == layer.biases.size());
+			std::copy(w.data().begin(), w.data().end(), layer.weights.begin());
+			std::copy(b.data().begin(), b.data().end(), layer.biases.begin());
+			layer.velocityW.fill(0.0);
+			layer.velocityB.fill(0.0);
+			if constexpr (I + 1 < kNumLayers) {
+				loadLayers<I + 1>(weights, biases);
+			}
+		}
+
+		template <size_t I>
+		void forwardFrom(const double* input) {
+			auto& layer = std::get<I>(m_layers);
+			layer.forward(input);
+			if constexpr (I + 1 < kNumLayers) {
+				forwardFrom<I + 1>(layer.out.data());
+			}
+		}
+
+		template <size_t I, bool UseMomentum>
+		void backwardFrom(const double* input) {
+			auto& layer = std::get<I>(m_layers);
+			if constexpr (I == 0) {
+				layer.template update<UseMomentum>(input, m_learningRate, m_momentum);
+			}
+			else {
+				auto& prev = std::get<I - 1>(m_layers);
+				layer.template update<UseMomentum>(prev.out.data(), m_learningRate, m_momentum);
+				layer.propagate(prev.delta.data());
+				backwardFrom<I - 1, UseMomentum>(input);
+			}
+		}
+
+		template <LossType Loss, bool UseMomentum>
+		double train(const double* input, const double* target) {
+			forwardFrom<0>(input);
+
+			auto& last = std::get<kNumLayers - 1>(m_layers);
+			double lossVal = 0.0;
+			for (size_t j = 0; j < kOutputSize; ++j) {
+				lossVal += LossTraits<Loss>::value(last.out[j], target[j]);
+				last.delta[j] = LossTraits<Loss>::gradient(last.out[j], target[j]);
+			}
+
+			backwardFrom<kNumLayers - 1, UseMomentum>(input);
+			return lossVal;
+		}
+	};
+
+}  // namespace nn
+
+#endif  // MY_NEURAL_NET_STATIC_NEURAL_NETWORK_H_
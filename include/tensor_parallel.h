@@ -0,0 +1,108 @@
+#ifndef MY_NEURAL_NET_TENSOR_PARALLEL_H_
+#define MY_NEURAL_NET_TENSOR_PARALLEL_H_
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+#include "matrix.h"
+#include "neural_network.h"
+#include "threading.h"
+
+/**
+ * @file tensor_parallel.h
+ * @brief Intra-layer (tensor) parallel training: wide dense layers split by
+ *        output columns across a pinned thread group.
+ */
+
+namespace nn {
+
+	/**
+	 * @struct TensorParallelConfig
+	 * @brief Thread group and sharding settings.
+	 */
+	struct TensorParallelConfig {
+		size_t numThreads = 0;            ///< 0 = one per logical core
+		size_t minShardWeights = 16384;   ///< A layer gets at most weights / this shards
+		bool pinThreads = true;           ///< Pin worker t to core firstCore + t
+		size_t firstCore = 0;
+	};
+
+	/**
+	 * @class TensorParallelTrainer
+	 * @brief Trains a NeuralNetwork with each layer's weights split by output
+	 *        columns, one shard per worker of a ThreadGroup.
+	 *
+	 * Worker j allocates and first-touches shard j of every layer (weights,
+	 * bias, optimizer state and its pre-activations), then is the only thread
+	 * to read or write it: it computes its slice of the layer output, its
+	 * slice of the weight gradient and the optimizer update for its columns,
+	 * so a shard stays in one core's cache (and NUMA node) instead of the
+	 * whole matrix streaming through every core. Output slices are written
+	 * straight into a shared activation, the one gather the next layer needs;
+	 * the input gradients of a layer's shards are partial sums reduced
+	 * row-parallel. Layers too small to benefit keep fewer shards (down to one).
+	 *
+	 * The shards are the live parameters while the trainer exists; the
+	 * network is updated by syncToNetwork and on destruction. Optimizer state
+	 * starts fresh with the network's optimizer type, rate and momentum.
+	 */
+	class TensorParallelTrainer {
+	public:
+		/**
+		 * @param net Network to train (must outlive the trainer; not LBFGS)
+		 * @param config Thread and sharding settings
+		 */
+		explicit TensorParallelTrainer(NeuralNetwork& net,
+			const TensorParallelConfig& config = TensorParallelConfig());
+		~TensorParallelTrainer();
+
+		TensorParallelTrainer(const TensorParallelTrainer&) = delete;
+		TensorParallelTrainer& operator=(const TensorParallelTrainer&) = delete;
+
+		/**
+		 * @brief One optimizer step on a mini-batch.
+		 * @param input (batch x input_dim)
+		 * @param target (batch x output_dim)
+		 * @return Loss averaged over the batch
+		 */
+		double trainBatch(const Matrix& input, const Matrix& target);
+
+		/**
+		 * @brief Forward pass with the sharded parameters.
+		 * @param input (batch x input_dim)
+		 * @return (batch x output_dim)
+		 */
+		Matrix predict(const Matrix& input);
+
+		/**
+		 * @brief Gathers the shards back into the network's weights and biases.
+		 */
+		void syncToNetwork();
+
+		/**
+		 * @return Number of shards layer i is split into.
+		 */
+		size_t numShards(size_t layer) const;
+
+		/**
+		 * @return Number of workers.
+		 */
+		size_t numThreads() const;
+
+	private:
+		struct Shard;
+
+		NeuralNetwork& m_net;
+		ThreadGroup m_group;
+		std::vector<std::vector<std::unique_ptr<Shard>>> m_shards;  ///< [layer][owner]
+		std::vector<Matrix> m_outputs;     ///< Gathered output of each layer
+		std::vector<Matrix> m_gradients;   ///< dL/dOut of each layer
+		double m_loss = 0.0;
+
+		void forwardPass(size_t t, const Matrix& input);
+		void backwardPass(size_t t, const Matrix& input, const Matrix& target);
+	};
+
+}  // namespace nn
+
+#endif  // MY_NEURAL_NET_TENSOR_PARALLEL_H_
@@ -0,0 +1,335 @@
+#ifndef MY_NEURAL_NET_THREADING_H_
+#define MY_NEURAL_NET_THREADING_H_
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <utility>
+#include <vector>
+
+/**
+ * @file threading.h
+ * @brief Thread pinning, worker groups and lock-free primitives for the parallel trainers.
+ */
+
+namespace nn {
+
+	/**
+	 * @brief Restricts the calling thread to one logical core.
+	 * @param core Core index (taken modulo the number of cores)
+	 * @return False where affinity is unsupported or the call fails
+	 */
+	bool pinCurrentThreadToCore(size_t core);
+
+	/**
+	 * @return Number of logical cores (at least 1).
+	 */
+	size_t hardwareConcurrency();
+
+	/**
+	 * @class ThreadGroup
+	 * @brief Fixed set of persistent worker threads, each optionally pinned
+	 *        to its own core, that run one task together at a time.
+	 *
+	 * Because worker t is always the same OS thread on the same core, data a
+	 * task allocates and touches from worker t stays in that core's cache
+	 * and (under first-touch placement) its NUMA node across calls.
+	 */
+	class ThreadGroup {
+	public:
+		/**
+		 * @param numThreads Number of workers (0 = one per logical core)
+		 * @param pinThreads Pin worker t to core firstCore + t
+		 * @param firstCore Core of worker 0
+		 */
+		explicit ThreadGroup(size_t numThreads = 0, bool pinThreads = true, size_t firstCore = 0);
+		~ThreadGroup();
+
+		ThreadGroup(const ThreadGroup&) = delete;
+		ThreadGroup& operator=(const ThreadGroup&) = delete;
+
+		/**
+		 * @return Number of workers.
+		 */
+		size_t size() const;
+
+		/**
+		 * @brief Calls task(t) on every worker t and returns once all are done.
+		 *        Not reentrant: call from outside the group only.
+		 */
+		void run(const std::function<void(size_t)>& task);
+
+		/**
+		 * @brief Blocks until every worker of the running task reaches it.
+		 *        Call only from inside a task, from all workers alike.
+		 */
+		void barrier();
+
+	private:
+		static constexpr size_t kCacheLine = 64;
+
+		std::vector<std::thread> m_threads;
+		bool m_pinThreads;
+		size_t m_firstCore;
+
+		std::mutex m_mutex;
+		std::condition_variable m_startCv;
+		std::condition_variable m_doneCv;
+		const std::function<void(size_t)>* m_task = nullptr;
+		size_t m_generation = 0;
+		size_t m_pending = 0;
+		bool m_stop = false;
+
+		alignas(kCacheLine) std::atomic<size_t> m_barrierCount{ 0 };
+		alignas(kCacheLine) std::atomic<size_t> m_barrierGeneration{ 0 };
+
+		void workerMain(size_t t);
+	};
+
+	/**
+	 * @class SpscQueue
+	 * @brief Bounded lock-free ring buffer for exactly one producer thread
+	 *        and one consumer thread.
+	 *
+	 * Head and tail live on separate cache lines; each side only writes its
+	 * own index, publishing slots with release stores that the other side
+	 * reads with acquire loads.
+	 */
+	template <typename T>
+	class SpscQueue {
+	public:
+		/**
+		 * @param capacity Minimum number of elements held (rounded up to a power of 2)
+		 */
+		explicit SpscQueue(size_t capacity) {
+			size_t size = 2;
+			while (size < capacity + 1) {
+				size <<= 1;
+			}
+			m_slots.resize(size);
+			m_mask = size - 1;
+		}
+
+		SpscQueue(const SpscQueue&) = delete;
+		SpscQueue& operator=(const SpscQueue&) = delete;
+
+		/**
+		 * @brief Producer side. @return False if the queue is full.
+		 */
+		bool tryPush(T&& value) {
+			const size_t tail = m_tail.load(std::memory_order_relaxed);
+			const size_t next = (tail + 1) & m_mask;
+			if (next == m_head.load(std::memory_order_acquire)) {
+				return false;
+			}
+			m_slots[tail] = std::move(value);
+			m_tail.store(next, std::memory_order_release);
+			return true;
+		}
+
+		/**
+		 * @brief Consumer side. @return False if the queue is empty.
+		 */
+		bool tryPop(T& value) {
+			const size_t head = m_head.load(std::memory_order_relaxed);
+			if (head == m_tail.load(std::memory_order_acquire)) {
+				return false;
+			}
+			value = std::move(m_slots[head]);
+			m_head.store((head + 1) & m_mask, std::memory_order_release);
+			return true;
+		}
+
+		/**
+		 * @brief Spins (yielding) until the value is enqueued.
+		 */
+		void push(T value) {
+			while (!tryPush(std::move(value))) {
+				std::this_thread::yield();
+			}
+		}
+
+		/**
+		 * @brief Spins (yielding) until a value is available.
+		 */
+		T pop() {
+			T value;
+			while (!tryPop(value)) {
+				std::this_thread::yield();
+			}
+			return value;
+		}
+
+	private:
+		static constexpr size_t kCacheLine = 64;
+
+		std::vector<T> m_slots;
+		size_t m_mask = 0;
+		alignas(kCacheLine) std::atomic<size_t> m_head{ 0 };  ///< Next slot to pop
+		alignas(kCacheLine) std::atomic<size_t> m_tail{ 0 };  ///< Next slot to push
+	};
+
+	/**
+	 * @class SnapshotCell
+	 * @brief Holds the current immutable version of a T for one writer and
+	 *        many readers. Readers never lock or wait for the writer; the
+	 *        writer frees old versions once no reader holds them.
+	 *
+	 * Reclamation uses hazard pointers: a reader claims a slot, stores the
+	 * pointer it is about to use there and re-checks that it is still
+	 * current. publish() swaps in the new version and deletes retired ones
+	 * that no slot points to; the rest are retried on the next publish.
+	 */
+	template <typename T>
+	class SnapshotCell {
+		struct Slot;
+
+	public:
+		/**
+		 * @brief RAII access to one version; valid until destroyed.
+		 */
+		class ReadGuard {
+		public:
+			ReadGuard(ReadGuard&& other) noexcept : m_slot(other.m_slot), m_value(other.m_value) {
+				other.m_slot = nullptr;
+			}
+			ReadGuard(const ReadGuard&) = delete;
+			ReadGuard& operator=(const ReadGuard&) = delete;
+			ReadGuard& operator=(ReadGuard&&) = delete;
+
+			~ReadGuard() {
+				if (m_slot) {
+					m_slot->hazard.store(nullptr, std::memory_order_release);
+					m_slot->inUse.store(false, std::memory_order_release);
+				}
+			}
+
+			const T* get() const { return m_value; }
+			const T& operator*() const { return *m_value; }
+			const T* operator->() const { return m_value; }
+			explicit operator bool() const { return m_value != nullptr; }
+
+		private:
+			friend class SnapshotCell;
+			Slot* m_slot;
+			const T* m_value;
+
+			ReadGuard(Slot* slot, const T* value) : m_slot(slot), m_value(value) {}
+		};
+
+		/**
+		 * @param maxReaders Readers that may hold a guard at the same time
+		 *        (more spin until a slot frees up)
+		 */
+		explicit SnapshotCell(size_t maxReaders = 64) : m_slots(maxReaders) {
+			assert(maxReaders > 0);
+		}
+
+		SnapshotCell(const SnapshotCell&) = delete;
+		SnapshotCell& operator=(const SnapshotCell&) = delete;
+
+		/**
+		 * @brief Requires that no ReadGuard is alive.
+		 */
+		~SnapshotCell() {
+			delete m_current.load(std::memory_order_acquire);
+			for (const T* p : m_retired) {
+				delete p;
+			}
+		}
+
+		/**
+		 * @brief Writer side: makes value current and reclaims unused old versions.
+		 */
+		void publish(std::unique_ptr<const T> value) {
+			const T* old = m_current.exchange(value.release(), std::memory_order_seq_cst);
+			if (old) {
+				m_retired.push_back(old);
+			}
+			reclaim();
+		}
+
+		/**
+		 * @brief Reader side: pins the current version (null before the first publish).
+		 */
+		ReadGuard read() const {
+			Slot* slot = claimSlot();
+			const T* p = m_current.load(std::memory_order_acquire);
+			for (;;) {
+				slot->hazard.store(p, std::memory_order_seq_cst);
+				// Still current after the hazard became visible: the writer
+				// will see it before freeing p
+				const T* again = m_current.load(std::memory_order_seq_cst);
+				if (again == p) {
+					break;
+				}
+				p = again;
+			}
+			return ReadGuard(slot, p);
+		}
+
+		/**
+		 * @return Old versions still waiting for readers to let go.
+		 */
+		size_t retiredCount() const {
+			return m_retired.size();
+		}
+
+	private:
+		static constexpr size_t kCacheLine = 64;
+
+		struct alignas(kCacheLine) Slot {
+			std::atomic<bool> inUse{ false };
+			std::atomic<const T*> hazard{ nullptr };
+		};
+
+		mutable std::vector<Slot> m_slots;
+		std::atomic<const T*> m_current{ nullptr };
+		std::vector<const T*> m_retired;   ///< Writer-only
+
+		Slot* claimSlot() const {
+			const size_t n = m_slots.size();
+			size_t i = std::hash<std::thread::id>()(std::this_thread::get_id()) % n;
+			for (;; i = (i + 1) % n) {
+				bool expected = false;
+				if (!m_slots[i].inUse.load(std::memory_order_relaxed)
+					&& m_slots[i].inUse.compare_exchange_strong(expected, true, std::memory_order_acquire)) {
+					return &m_slots[i];
+				}
+				if (i + 1 == n) {
+					std::this_thread::yield();
+				}
+			}
+		}
+
+		void reclaim() {
+			std::vector<const T*> hazards;
+			hazards.reserve(m_slots.size());
+			for (const Slot& slot : m_slots) {
+				if (const T* p = slot.hazard.load(std::memory_order_seq_cst)) {
+					hazards.push_back(p);
+				}
+			}
+			size_t kept = 0;
+			for (const T* p : m_retired) {
+				if (std::find(hazards.begin(), hazards.end(), p) != hazards.end()) {
+					m_retired[kept++] = p;
+				}
+				else {
+					delete p;
+				}
+			}
+			m_retired.resize(kept);
+		}
+	};
+
+}  // namespace nn
+
+#endif  // MY_NEURAL_NET_THREADING_H_
@@ -0,0 +1,104 @@
+#ifndef MY_NEURAL_NET_TRAINER_H_
+#define MY_NEURAL_NET_TRAINER_H_
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include "dataset.h"
+#include "lr_schedule.h"
+#include "neural_network.h"
+
+/**
+ * @file trainer.h
+ * @brief Epoch loop around NeuralNetwork with schedules and early stopping.
+ */
+
+namespace nn {
+
+	/**
+	 * @struct TrainerConfig
+	 * @brief Stopping and evaluation settings for Trainer::fit.
+	 */
+	struct TrainerConfig {
+		size_t maxEpochs = 1000;       ///< Hard epoch limit
+		size_t evalInterval = 100;     ///< Epochs between evaluations (>= 1)
+		double targetLoss = -1.0;      ///< Stop once monitored loss <= this (negative disables)
+		double targetAccuracy = -1.0;  ///< Stop once accuracy >= this (negative disables)
+		size_t patience = 0;           ///< Stop after this many evaluations without improvement (0 disables)
+		double minDelta = 1e-6;        ///< Smallest loss decrease counted as improvement
+	};
+
+	/**
+	 * @enum StopReason
+	 * @brief Why Trainer::fit returned.
+	 */
+	enum class StopReason {
+		MaxEpochs,
+		TargetLoss,
+		TargetAccuracy,
+		Stalled
+	};
+
+	/**
+	 * @struct TrainingProgress
+	 * @brief Snapshot passed to the evaluation callback and returned by fit.
+	 */
+	struct TrainingProgress {
+		size_t epoch = 0;           ///< Epochs completed
+		double trainLoss = 0.0;     ///< Mean per-sample training loss of the last epoch
+		double monitoredLoss = 0.0; ///< Mean loss on the held-out set (training set if none)
+		double accuracy = 0.0;      ///< Accuracy on the held-out set (training set if none)
+		double learningRate = 0.0;  ///< Rate used during the last epoch
+	};
+
+	/**
+	 * @struct TrainingResult
+	 * @brief Final state of a Trainer::fit run.
+	 */
+	struct TrainingResult {
+		TrainingProgress progress;
+		StopReason reason = StopReason::MaxEpochs;
+	};
+
+	/**
+	 * @class Trainer
+	 * @brief Runs epochs of NeuralNetwork::trainSample, adjusting the learning
+	 *        rate from a schedule and stopping early once a loss or accuracy
+	 *        target is reached or progress stalls.
+	 *
+	 * The monitored loss and accuracy are only computed every evalInterval
+	 * epochs, with evaluate() (batched, parallel, inference-only).
+	 */
+	class Trainer {
+	public:
+		/**
+		 * @param config Stopping and evaluation settings
+		 * @param schedule Learning-rate schedule (constant rate if null)
+		 */
+		explicit Trainer(const TrainerConfig& config,
+			std::unique_ptr<LearningRateSchedule> schedule = nullptr);
+
+		/**
+		 * @brief Called after every evaluation, e.g. for logging.
+		 */
+		void setEvaluationCallback(std::function<void(const TrainingProgress&)> callback);
+
+		/**
+		 * @brief Trains until a stopping condition is met.
+		 * @param net Network to train (its learning rate is the schedule's base)
+		 * @param train Training samples
+		 * @param validation Held-out samples to monitor (training set if null)
+		 * @return Progress at the last evaluation and the reason for stopping
+		 */
+		TrainingResult fit(NeuralNetwork& net, const Dataset& train,
+			const Dataset* validation = nullptr);
+
+	private:
+		TrainerConfig m_config;
+		std::unique_ptr<LearningRateSchedule> m_schedule;
+		std::function<void(const TrainingProgress&)> m_callback;
+	};
+
+}  // namespace nn
+
+#endif  // MY_NEURAL_NET_TRAINER_H_
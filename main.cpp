@@ -1,4 +1,5 @@
 #include <iostream>
+#include <memory>
 #include <vector>
 #include <string>
 #include "include/matrix.h"
@@ -6,6 +7,8 @@
 #include "include/loss.h"
 #include "include/optimizer.h"
 #include "include/neural_network.h"
+#include "include/trainer.h"
+#include "include/evaluation.h"
 
 using namespace nn;
 
@@ -22,8 +25,10 @@ using namespace nn;
  * @param optType Optimizer type (Momentum, SGD, etc.).
  * @param lr Learning rate.
  * @param momentum Momentum factor (if used by the optimizer).
- * @param epochs Number of training epochs.
- * @param logInterval Print loss every this many epochs.
+ * @param epochs Maximum number of training epochs.
+ * @param logInterval Print loss (and check for early stopping) every this many epochs.
+ * @param targetLoss Stop as soon as the mean loss reaches this (negative disables).
+ * @param schedule Learning-rate schedule (constant rate if null).
  */
 void trainAndTestBinaryFunction(const std::string& name,
     const std::vector<Matrix>& inputs,
@@ -35,28 +40,35 @@ void trainAndTestBinaryFunction(const std::string& name,
     double lr,
     double momentum,
     int epochs,
-    int logInterval = 1000)
+    int logInterval = 1000,
+    double targetLoss = -1.0,
+    std::unique_ptr<LearningRateSchedule> schedule = nullptr)
 {
     // Construct the network
     NeuralNetwork net(layerSizes, activs, lossType, optType, lr, momentum);
 
     // Train
-    for (int e = 1; e <= epochs; ++e) {
-        double totalLoss = 0.0;
-        for (size_t i = 0; i < inputs.size(); ++i) {
-            double lossVal = net.trainSample(inputs[i], targets[i]);
-            totalLoss += lossVal;
-        }
-        if (e % logInterval == 0) {
-            std::cout << name << " | Epoch " << e
-                << " | Loss: " << totalLoss << std::endl;
-        }
+    TrainerConfig config;
+    config.maxEpochs = static_cast<size_t>(epochs);
+    config.evalInterval = static_cast<size_t>(logInterval);
+    config.targetLoss = targetLoss;
+
+    Trainer trainer(config, std::move(schedule));
+    trainer.setEvaluationCallback([&name](const TrainingProgress& progress) {
+        std::cout << name << " | Epoch " << progress.epoch
+            << " | Loss: " << progress.monitoredLoss
+            << " | LR: " << progress.learningRate << std::endl;
+        });
+    TrainingResult result = trainer.fit(net, Dataset{ inputs, targets });
+    if (result.reason == StopReason::TargetLoss) {
+        std::cout << name << " | Reached target loss after "
+            << result.progress.epoch << " epochs" << std::endl;
     }
 
     // Test / Print results
     std::cout << "\n[" << name << "] Final Predictions:\n";
     for (size_t i = 0; i < inputs.size(); ++i) {
-        Matrix out = net.forward(inputs[i]);
+        Matrix out = net.predict(inputs[i]);
         std::cout << "Input: (";
         for (size_t c = 0; c < inputs[i].cols(); ++c) {
             std::cout << inputs[i](0, c);
@@ -65,6 +77,10 @@ void trainAndTestBinaryFunction(const std::string& name,
         std::cout << ") -> " << out(0, 0)
             << " (target: " << targets[i](0, 0) << ")\n";
     }
+    EvaluationResult eval = evaluate(net, Dataset{ inputs, targets },
+        { Metric::Loss, Metric::Accuracy, Metric::AUC });
+    std::cout << "Loss: " << eval.loss << " | Accuracy: " << eval.accuracy
+        << " | AUC: " << eval.auc << "\n";
     std::cout << std::endl;
 }
 
@@ -230,18 +246,18 @@ int main() {
             ActivationType::Sigmoid
         };
 
-        // We'll train for a large number of epochs since it's tricky
-        // and we want it to converge (this might take a while).
-        // on my PC this takes like 2 minutes :)
-        int epochs = 200000;
-        int logInterval = 20000;
+        // It's tricky for first-order methods; full-batch L-BFGS needs a few
+        // hundred iterations (one per epoch) instead of ~100k epochs.
+        int epochs = 2000;
+        int logInterval = 10;
+        double targetLoss = 0.01;
 
         trainAndTestBinaryFunction("4-bit Parity", inputs, targets,
             layerSizes, activs,
             LossType::CrossEntropy,
-            OptimizerType::Momentum,
-            0.05, 0.9,
-            epochs, logInterval);
+            OptimizerType::LBFGS,
+            0.0, 0.0,    // Step lengths come from the line search
+            epochs, logInterval, targetLoss);
     }
 
     std::cout << "All tasks completed.\n";
@@ -1,39 +1,46 @@
 #include "../include/activation.h"
 
-#include <cmath>
-
 namespace nn {
 
     static ActivationFunction sigmoidFunc = {
-        /* forward */ [](double x) {
-          return 1.0 / (1.0 + std::exp(-x));
-        },
-        /* derivative */ [](double x) {
-          double s = 1.0 / (1.0 + std::exp(-x));
-          return s * (1.0 - s);
-        }
+        /* forward */ &ActivationTraits<ActivationType::Sigmoid>::forward,
+        /* derivative */ &ActivationTraits<ActivationType::Sigmoid>::derivative
     };
 
     static ActivationFunction reluFunc = {
-        /* forward */ [](double x) {
-          return (x > 0.0) ? x : 0.0;
-        },
-        /* derivative */ [](double x) {
-          return (x > 0.0) ? 1.0 : 0.0;
-        }
+        /* forward */ &ActivationTraits<ActivationType::ReLU>::forward,
+        /* derivative */ &ActivationTraits<ActivationType::ReLU>::derivative
     };
 
     static ActivationFunction tanhFunc = {
-        /* forward */ [](double x) {
-          return std::tanh(x);
-        },
-        /* derivative */ [](double x) {
-          double t = std::tanh(x);
-          return 1.0 - t * t;
-        }
+        /* forward */ &ActivationTraits<ActivationType::Tanh>::forward,
+        /* derivative */ &ActivationTraits<ActivationType::Tanh>::derivative
+    };
+
+    static ActivationFunction linearFunc = {
+        /* forward */ &ActivationTraits<ActivationType::Linear>::forward,
+        /* derivative */ &ActivationTraits<ActivationType::Linear>::derivative
     };
 
-    ActivationFunction getActivation(ActivationType type) {
+    static ActivationFunction fastSigmoidFunc = {
+        /* forward */ &FastActivationTraits<ActivationType::Sigmoid>::forward,
+        /* derivative */ &FastActivationTraits<ActivationType::Sigmoid>::derivative
+    };
+
+    static ActivationFunction fastTanhFunc = {
+        /* forward */ &FastActivationTraits<ActivationType::Tanh>::forward,
+        /* derivative */ &FastActivationTraits<ActivationType::Tanh>::derivative
+    };
+
+    ActivationFunction getActivation(ActivationType type, ActivationPrecision precision) {
+        if (precision == ActivationPrecision::Fast) {
+            if (type == ActivationType::Sigmoid) {
+                return fastSigmoidFunc;
+            }
+            if (type == ActivationType::Tanh) {
+                return fastTanhFunc;
+            }
+        }
         switch (type) {
         case ActivationType::Sigmoid:
             return sigmoidFunc;
@@ -41,6 +48,8 @@ namespace nn {
             return reluFunc;
         case ActivationType::Tanh:
             return tanhFunc;
+        case ActivationType::Linear:
+            return linearFunc;
         }
         // Default
         return sigmoidFunc;
@@ -0,0 +1,130 @@
+#include "../include/aligned_allocator.h"
+
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <malloc.h>
+#elif defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+namespace nn {
+
+    namespace {
+
+        std::atomic<size_t> g_hugePageThreshold{ size_t(4) << 20 };
+
+        enum class BlockKind : uint32_t {
+            Heap,        ///< Aligned heap block
+            LargePages   ///< Windows VirtualAlloc(MEM_LARGE_PAGES)
+        };
+
+        // Sits in the cache line just before the pointer handed out, so
+        // deallocation does not depend on the threshold at allocation time
+        struct BlockHeader {
+            void* base;
+            BlockKind kind;
+        };
+        static_assert(sizeof(BlockHeader) <= kMatrixAlignment, "Header must fit in one line");
+
+        void* alignedHeapAlloc(size_t alignment, size_t bytes) {
+#if defined(_WIN32)
+            return _aligned_malloc(bytes, alignment);
+#else
+            void* p = nullptr;
+            return posix_memalign(&p, alignment, bytes) == 0 ? p : nullptr;
+#endif
+        }
+
+        void alignedHeapFree(void* p) {
+#if defined(_WIN32)
+            _aligned_free(p);
+#else
+            std::free(p);
+#endif
+        }
+
+    }  // namespace
+
+    void setHugePageThreshold(size_t bytes) {
+        g_hugePageThreshold.store(bytes, std::memory_order_relaxed);
+    }
+
+    size_t hugePageThreshold() {
+        return g_hugePageThreshold.load(std::memory_order_relaxed);
+    }
+
+    void* allocateAligned(size_t bytes) {
+        const size_t total = bytes + kMatrixAlignment;
+        const size_t threshold = hugePageThreshold();
+        void* base = nullptr;
+        BlockKind kind = BlockKind::Heap;
+
+        if (threshold > 0 && bytes >= threshold) {
+            const size_t rounded = (total + kHugePageBytes - 1) / kHugePageBytes * kHugePageBytes;
+#if defined(_WIN32)
+            const size_t largePage = GetLargePageMinimum();
+            if (largePage > 0 && rounded % largePage == 0) {
+                base = VirtualAlloc(nullptr, rounded, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES,
+                    PAGE_READWRITE);
+                if (base) {
+                    kind = BlockKind::LargePages;
+                }
+            }
+#else
+            base = alignedHeapAlloc(kHugePageBytes, rounded);
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+            if (base) {
+                madvise(base, rounded, MADV_HUGEPAGE);
+            }
+#endif
+#endif
+        }
+        if (!base) {
+            base = alignedHeapAlloc(kMatrixAlignment, total);
+            kind = BlockKind::Heap;
+        }
+        if (!base) {
+            throw std::bad_alloc();
+        }
+
+        // The header takes the first line, so even a huge-page block hands
+        // out data at a kMatrixAlignment (not huge-page) boundary
+        char* user = static_cast<char*>(base) + kMatrixAlignment;
+        BlockHeader* header = reinterpret_cast<BlockHeader*>(user) - 1;
+        header->base = base;
+        header->kind = kind;
+        return user;
+    }
+
+    void deallocateAligned(void* p) noexcept {
+        if (!p) {
+            return;
+        }
+        const BlockHeader* header = static_cast<const BlockHeader*>(p) - 1;
+#if defined(_WIN32)
+        if (header->kind == BlockKind::LargePages) {
+            VirtualFree(header->base, 0, MEM_RELEASE);
+            return;
+        }
+#endif
+        alignedHeapFree(header->base);
+    }
+
+    size_t paddedLeadingDimension(size_t cols) {
+        const size_t perLine = kMatrixAlignment / sizeof(double);
+        size_t ld = (cols + perLine - 1) / perLine * perLine;
+        // With a 512-byte multiple, rows start in only a few L1 sets
+        if (ld > 0 && (ld * sizeof(double)) % 512 == 0) {
+            ld += perLine;
+        }
+        return ld;
+    }
+
+}  // namespace nn
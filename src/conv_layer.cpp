@@ -0,0 +1,227 @@
+#include "../include/conv_layer.h"
+#include "../include/random.h"
+
+#include <algorithm>
+#include <cassert>
+
+namespace nn {
+
+    Conv2DLayer::Conv2DLayer(size_t channels, size_t height, size_t width,
+        size_t filters, size_t kernelSize,
+        size_t stride, size_t padding,
+        ActivationType activation,
+        size_t im2colBudgetBytes)
+        : Conv2DLayer(channels, height, width, filters, kernelSize, stride, padding,
+            activation, im2colBudgetBytes, mixSeed(globalSeed(), nextTensorId())) {}
+
+    Conv2DLayer::Conv2DLayer(size_t channels, size_t height, size_t width,
+        size_t filters, size_t kernelSize,
+        size_t stride, size_t padding,
+        ActivationType activation,
+        size_t im2colBudgetBytes,
+        uint64_t seed)
+        : m_channels(channels), m_height(height), m_width(width),
+        m_filters(filters), m_kernel(kernelSize), m_stride(stride), m_padding(padding),
+        m_activation(activation) {
+        assert(stride > 0 && kernelSize > 0);
+        assert(height + 2 * padding >= kernelSize && width + 2 * padding >= kernelSize);
+        m_outH = (height + 2 * padding - kernelSize) / stride + 1;
+        m_outW = (width + 2 * padding - kernelSize) / stride + 1;
+        m_patchSize = channels * kernelSize * kernelSize;
+
+        size_t budgetPixels = im2colBudgetBytes / (m_patchSize * sizeof(double));
+        m_tilePixels = std::min(std::max<size_t>(budgetPixels, 1), m_outH * m_outW);
+
+        m_weights = Matrix(filters, m_patchSize);
+        m_biases = Matrix(1, filters);
+        m_gradW = Matrix(filters, m_patchSize);
+        m_gradB = Matrix(1, filters);
+        initializeWeights(m_weights, defaultInitFor(activation),
+            m_patchSize, filters * kernelSize * kernelSize, seed, 0);
+        if (activation == ActivationType::ReLU) {
+            std::fill(m_biases.data().begin(), m_biases.data().end(), 0.01);
+        }
+
+        m_col.resize(m_patchSize * m_tilePixels);
+        m_tileOut.resize(filters * m_tilePixels);
+        m_tileGradW.resize(filters * m_patchSize);
+        m_weightsT.resize(m_patchSize * filters);
+    }
+
+    size_t Conv2DLayer::outputWidth(const std::vector<size_t>& inputWidths) const {
+        assert(inputWidths.size() == 1 && inputWidths[0] == m_channels * m_height * m_width);
+        return m_filters * m_outH * m_outW;
+    }
+
+    std::vector<size_t> Conv2DLayer::savedWidths(const std::vector<size_t>&) const {
+        return { m_filters * m_outH * m_outW };  // pre-activation net input
+    }
+
+    // col(k, p - p0) for patch element k = (c * kernel + ky) * kernel + kx
+    void Conv2DLayer::im2col(const double* image, size_t p0, size_t count, double* col) const {
+        for (size_t k = 0; k < m_patchSize; ++k) {
+            const size_t c = k / (m_kernel * m_kernel);
+            const size_t ky = (k / m_kernel) % m_kernel;
+            const size_t kx = k % m_kernel;
+            const double* plane = image + c * m_height * m_width;
+            double* row = col + k * count;
+            for (size_t i = 0; i < count; ++i) {
+                const size_t p = p0 + i;
+                const long iy = long((p / m_outW) * m_stride + ky) - long(m_padding);
+                const long ix = long((p % m_outW) * m_stride + kx) - long(m_padding);
+                bool inside = iy >= 0 && ix >= 0 && iy < long(m_height) && ix < long(m_width);
+                row[i] = inside ? plane[iy * m_width + ix] : 0.0;
+            }
+        }
+    }
+
+    // colT(p - p0, k): one receptive field per row
+    void Conv2DLayer::im2colTransposed(const double* image, size_t p0, size_t count, double* colT) const {
+        for (size_t i = 0; i < count; ++i) {
+            const size_t p = p0 + i;
+            const long y0 = long((p / m_outW) * m_stride) - long(m_padding);
+            const long x0 = long((p % m_outW) * m_stride) - long(m_padding);
+            double* row = colT + i * m_patchSize;
+            for (size_t c = 0; c < m_channels; ++c) {
+                const double* plane = image + c * m_height * m_width;
+                for (size_t ky = 0; ky < m_kernel; ++ky) {
+                    const long iy = y0 + long(ky);
+                    for (size_t kx = 0; kx < m_kernel; ++kx) {
+                        const long ix = x0 + long(kx);
+                        bool inside = iy >= 0 && ix >= 0 && iy < long(m_height) && ix < long(m_width);
+                        *row++ = inside ? plane[iy * m_width + ix] : 0.0;
+                    }
+                }
+            }
+        }
+    }
+
+    void Conv2DLayer::col2im(const double* col, size_t p0, size_t count, double* image) const {
+        for (size_t k = 0; k < m_patchSize; ++k) {
+            const size_t c = k / (m_kernel * m_kernel);
+            const size_t ky = (k / m_kernel) % m_kernel;
+            const size_t kx = k % m_kernel;
+            double* plane = image + c * m_height * m_width;
+            const double* row = col + k * count;
+            for (size_t i = 0; i < count; ++i) {
+                const size_t p = p0 + i;
+                const long iy = long((p / m_outW) * m_stride + ky) - long(m_padding);
+                const long ix = long((p % m_outW) * m_stride + kx) - long(m_padding);
+                if (iy >= 0 && ix >= 0 && iy < long(m_height) && ix < long(m_width)) {
+                    plane[iy * m_width + ix] += row[i];
+                }
+            }
+        }
+    }
+
+    void Conv2DLayer::forward(const std::vector<const Matrix*>& inputs, Matrix& output,
+        const std::vector<Matrix*>& saved, bool) {
+        const Matrix& in = *inputs[0];
+        Matrix& net = *saved[0];
+        const size_t pixels = m_outH * m_outW;
+        const size_t inSize = m_channels * m_height * m_width;
+        const size_t outSize = m_filters * pixels;
+        const double* b = m_biases.data().data();
+
+        for (size_t s = 0; s < in.rows(); ++s) {
+            const double* image = in.data().data() + s * inSize;
+            double* z = net.data().data() + s * outSize;
+            for (size_t p0 = 0; p0 < pixels; p0 += m_tilePixels) {
+                const size_t count = std::min(m_tilePixels, pixels - p0);
+                im2col(image, p0, count, m_col.data());
+                // (filters x patch) * (patch x count)
+                Matrix::multiplyStridedBatched(m_weights.data().data(), 0, m_col.data(), 0,
+                    m_tileOut.data(), 0, m_filters, count, m_patchSize, 1);
+                for (size_t f = 0; f < m_filters; ++f) {
+                    const double* t = m_tileOut.data() + f * count;
+                    double* dst = z + f * pixels + p0;
+                    for (size_t i = 0; i < count; ++i) {
+                        dst[i] = t[i] + b[f];
+                    }
+                }
+            }
+        }
+
+        const double* zAll = net.data().data();
+        double* y = output.data().data();
+        const size_t total = in.rows() * outSize;
+        withActivationTraits(m_activation, [&](auto traits) {
+            using Traits = decltype(traits);
+            for (size_t e = 0; e < total; ++e) {
+                y[e] = Traits::forward(zAll[e]);
+            }
+        });
+    }
+
+    void Conv2DLayer::backward(const std::vector<const Matrix*>& inputs,
+        const std::vector<Matrix*>& saved, Matrix& gradOutput,
+        const std::vector<Matrix*>& gradInputs) {
+        const Matrix& in = *inputs[0];
+        const size_t pixels = m_outH * m_outW;
+        const size_t inSize = m_channels * m_height * m_width;
+        const size_t outSize = m_filters * pixels;
+        const size_t batch = in.rows();
+
+        // gradOutput: dL/dOut -> dL/dNet, in place
+        double* delta = gradOutput.data().data();
+        const double* net = saved[0]->data().data();
+        withActivationTraits(m_activation, [&](auto traits) {
+            using Traits = decltype(traits);
+            for (size_t e = 0; e < batch * outSize; ++e) {
+                delta[e] *= Traits::derivative(net[e]);
+            }
+        });
+
+        std::fill(m_gradW.data().begin(), m_gradW.data().end(), 0.0);
+        std::fill(m_gradB.data().begin(), m_gradB.data().end(), 0.0);
+        Matrix* gradIn = gradInputs[0];
+        if (gradIn) {
+            for (size_t f = 0; f < m_filters; ++f) {
+                for (size_t k = 0; k < m_patchSize; ++k) {
+                    m_weightsT[k * m_filters + f] = m_weights(f, k);
+                }
+            }
+        }
+
+        double* dW = m_gradW.data().data();
+        double* dB = m_gradB.data().data();
+        for (size_t s = 0; s < batch; ++s) {
+            const double* image = in.data().data() + s * inSize;
+            const double* d = delta + s * outSize;
+            for (size_t f = 0; f < m_filters; ++f) {
+                for (size_t p = 0; p < pixels; ++p) {
+                    dB[f] += d[f * pixels + p];
+                }
+            }
+
+            for (size_t p0 = 0; p0 < pixels; p0 += m_tilePixels) {
+                const size_t count = std::min(m_tilePixels, pixels - p0);
+                // Contiguous (filters x count) slice of delta
+                for (size_t f = 0; f < m_filters; ++f) {
+                    std::copy(d + f * pixels + p0, d + f * pixels + p0 + count,
+                        m_tileOut.data() + f * count);
+                }
+
+                // dW += delta_tile * col^T, with col^T lowered directly
+                im2colTransposed(image, p0, count, m_col.data());
+                Matrix::multiplyStridedBatched(m_tileOut.data(), 0, m_col.data(), 0,
+                    m_tileGradW.data(), 0, m_filters, m_patchSize, count, 1);
+                for (size_t e = 0; e < m_tileGradW.size(); ++e) {
+                    dW[e] += m_tileGradW[e];
+                }
+
+                // dCol = W^T * delta_tile, scattered back onto the image
+                if (gradIn) {
+                    Matrix::multiplyStridedBatched(m_weightsT.data(), 0, m_tileOut.data(), 0,
+                        m_col.data(), 0, m_patchSize, count, m_filters, 1);
+                    col2im(m_col.data(), p0, count, gradIn->data().data() + s * inSize);
+                }
+            }
+        }
+    }
+
+    std::vector<std::pair<Matrix*, Matrix*>> Conv2DLayer::parameters() {
+        return { { &m_weights, &m_gradW }, { &m_biases, &m_gradB } };
+    }
+
+}  // namespace nn
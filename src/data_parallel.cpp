@@ -0,0 +1,134 @@
+#include "../include/data_parallel.h"
+#include "../include/loss.h"
+
+#include <algorithm>
+#include <cassert>
+
+namespace nn {
+
+    DataParallelTrainer::DataParallelTrainer(NeuralNetwork& net, RingCommunicator& comm, bool overlap)
+        : m_net(net), m_comm(comm), m_overlap(overlap) {
+        assert(net.optimizerType() != OptimizerType::LBFGS && "L-BFGS cannot step per layer");
+        const size_t L = net.numLayers();
+        m_inputs.resize(L);
+        m_nets.resize(L);
+        m_dW.resize(L);
+        m_dB.resize(L);
+        m_buckets.resize(L);
+        for (size_t i = 0; i < L; ++i) {
+            Matrix& W = net.weights()[i];
+            Matrix& b = net.biases()[i];
+            m_healthy = m_healthy && comm.broadcast(W.data().data(), W.data().size())
+                && comm.broadcast(b.data().data(), b.data().size());
+            m_buckets[i].resize(W.data().size() + b.data().size());
+        }
+        if (m_overlap) {
+            m_thread = std::thread([this] { commMain(); });
+        }
+    }
+
+    DataParallelTrainer::~DataParallelTrainer() {
+        if (m_thread.joinable()) {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_stop = true;
+            }
+            m_cv.notify_all();
+            m_thread.join();
+        }
+    }
+
+    bool DataParallelTrainer::reduceBucket(size_t i) {
+        return m_comm.allReduce(m_buckets[i].data(), m_buckets[i].size(), i);
+    }
+
+    void DataParallelTrainer::commMain() {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        for (;;) {
+            m_cv.wait(lock, [&] { return m_stop || !m_queue.empty(); });
+            if (m_queue.empty()) {
+                return;
+            }
+            size_t i = m_queue.front();
+            m_queue.pop_front();
+            lock.unlock();
+            bool ok = reduceBucket(i);
+            lock.lock();
+            m_commFailed = m_commFailed || !ok;
+            ++m_reduced;
+            m_cv.notify_all();
+        }
+    }
+
+    double DataParallelTrainer::trainBatch(const Matrix& input, const Matrix& target) {
+        assert(input.rows() == target.rows() && input.rows() > 0);
+        const size_t L = m_net.numLayers();
+
+        Matrix current = input;
+        Matrix out;
+        for (size_t i = 0; i < L; ++i) {
+            m_inputs[i] = current;
+            m_net.forwardLayer(i, m_inputs[i], m_nets[i], out);
+            current = std::move(out);
+        }
+        const LossFunction lossFunc = getLoss(m_net.lossType());
+        const double loss = lossFunc.forward(current, target);
+        Matrix grad = lossFunc.derivative(current, target);
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_reduced = 0;
+        }
+        for (size_t i = L; i-- > 0;) {
+            m_dW[i] = Matrix();
+            m_dB[i] = Matrix();
+            m_net.accumulateLayerGradients(i, m_inputs[i], m_nets[i], grad, m_dW[i], m_dB[i], i > 0);
+
+            std::vector<double>& bucket = m_buckets[i];
+            std::copy(m_dW[i].data().begin(), m_dW[i].data().end(), bucket.begin());
+            std::copy(m_dB[i].data().begin(), m_dB[i].data().end(), bucket.begin() + m_dW[i].data().size());
+            if (m_overlap) {
+                // Layer i goes on the wire while layer i - 1 backprops
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    m_queue.push_back(i);
+                }
+                m_cv.notify_all();
+            }
+        }
+
+        bool reduced = true;
+        if (m_overlap) {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_cv.wait(lock, [&] { return m_reduced == L; });
+            reduced = !m_commFailed;
+        }
+        else {
+            for (size_t i = L; i-- > 0 && reduced;) {
+                reduced = reduceBucket(i);
+            }
+        }
+        if (!reduced) {
+            // Some buckets hold partial sums: applying any layer would send
+            // the replicas apart, so this step changes nothing
+            m_healthy = false;
+            return loss;
+        }
+
+        // Sum of per-shard means / N = mean over the full batch
+        const double scale = 1.0 / static_cast<double>(m_comm.worldSize());
+        for (size_t i = 0; i < L; ++i) {
+            const std::vector<double>& bucket = m_buckets[i];
+            const size_t nW = m_dW[i].data().size();
+            for (size_t e = 0; e < nW; ++e) {
+                m_dW[i].data()[e] = bucket[e] * scale;
+            }
+            for (size_t e = 0; e < m_dB[i].data().size(); ++e) {
+                m_dB[i].data()[e] = bucket[nW + e] * scale;
+            }
+            m_net.applyLayerGradients(i, m_dW[i], m_dB[i]);
+        }
+        return loss;
+    }
+
+}  // namespace nn
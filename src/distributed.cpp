@@ -0,0 +1,612 @@
+#include "../include/distributed.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <numeric>
+#include <thread>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#include <windows.h>
+#pragma comment(lib, "ws2_32.lib")
+#else
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+extern char** environ;
+#endif
+
+namespace nn {
+
+    namespace {
+
+        const int kIoTimeoutMs = 60000;
+        const size_t kMaxSendChunk = size_t(1) << 20;
+
+#if defined(_WIN32)
+        using SocketHandle = SOCKET;
+        const intptr_t kNoSocket = static_cast<intptr_t>(INVALID_SOCKET);
+
+        void ensureSocketsInitialized() {
+            static bool ok = [] {
+                WSADATA data;
+                return WSAStartup(MAKEWORD(2, 2), &data) == 0;
+            }();
+            (void)ok;
+        }
+
+        void closeSocket(intptr_t s) {
+            closesocket(static_cast<SOCKET>(s));
+        }
+
+        bool wouldBlock() {
+            return WSAGetLastError() == WSAEWOULDBLOCK;
+        }
+
+        int pollSockets(pollfd* fds, size_t n, int timeoutMs) {
+            return WSAPoll(fds, static_cast<ULONG>(n), timeoutMs);
+        }
+
+        void setNonBlocking(intptr_t s) {
+            u_long on = 1;
+            ioctlsocket(static_cast<SOCKET>(s), FIONBIO, &on);
+        }
+
+        const int kSendFlags = 0;
+#else
+        using SocketHandle = int;
+        const intptr_t kNoSocket = -1;
+
+        void ensureSocketsInitialized() {}
+
+        void closeSocket(intptr_t s) {
+            ::close(static_cast<int>(s));
+        }
+
+        bool wouldBlock() {
+            return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+        }
+
+        int pollSockets(pollfd* fds, size_t n, int timeoutMs) {
+            return ::poll(fds, static_cast<nfds_t>(n), timeoutMs);
+        }
+
+        void setNonBlocking(intptr_t s) {
+            int flags = fcntl(static_cast<int>(s), F_GETFL, 0);
+            fcntl(static_cast<int>(s), F_SETFL, flags | O_NONBLOCK);
+        }
+
+#if defined(MSG_NOSIGNAL)
+        const int kSendFlags = MSG_NOSIGNAL;   // A dead peer is an error, not SIGPIPE
+#else
+        const int kSendFlags = 0;
+#endif
+#endif
+
+        SocketHandle handle(intptr_t s) {
+            return static_cast<SocketHandle>(s);
+        }
+
+        // Fills addr for rank's listening endpoint; returns its length (0 if unsupported)
+        int endpointOf(const DistributedConfig& config, size_t rank, sockaddr_storage& addr) {
+            std::memset(&addr, 0, sizeof(addr));
+            if (config.transport == Transport::Tcp) {
+                sockaddr_in& in = reinterpret_cast<sockaddr_in&>(addr);
+                in.sin_family = AF_INET;
+                in.sin_port = htons(static_cast<uint16_t>(config.basePort + rank));
+                if (inet_pton(AF_INET, config.host.c_str(), &in.sin_addr) != 1) {
+                    return 0;
+                }
+                return sizeof(sockaddr_in);
+            }
+#if defined(_WIN32)
+            return 0;
+#else
+            sockaddr_un& un = reinterpret_cast<sockaddr_un&>(addr);
+            un.sun_family = AF_UNIX;
+            std::string path = config.socketDir + "/nn_ring_" + std::to_string(config.basePort)
+                + "_" + std::to_string(rank);
+            if (path.size() >= sizeof(un.sun_path)) {
+                return 0;
+            }
+            std::memcpy(un.sun_path, path.c_str(), path.size() + 1);
+            return sizeof(sockaddr_un);
+#endif
+        }
+
+        int familyOf(const DistributedConfig& config) {
+#if defined(_WIN32)
+            (void)config;
+            return AF_INET;
+#else
+            return config.transport == Transport::Tcp ? AF_INET : AF_UNIX;
+#endif
+        }
+
+        size_t chunkBegin(size_t chunk, size_t count, size_t worldSize) {
+            return chunk * count / worldSize;
+        }
+
+    }  // namespace
+
+    bool DistributedConfig::fromEnvironment(DistributedConfig& config) {
+        const char* rank = std::getenv("NN_RANK");
+        const char* world = std::getenv("NN_WORLD_SIZE");
+        if (!rank || !world) {
+            return false;
+        }
+        config.rank = static_cast<size_t>(std::strtoull(rank, nullptr, 10));
+        config.worldSize = static_cast<size_t>(std::strtoull(world, nullptr, 10));
+        if (const char* port = std::getenv("NN_BASE_PORT")) {
+            config.basePort = static_cast<uint16_t>(std::strtoul(port, nullptr, 10));
+        }
+        if (const char* transport = std::getenv("NN_TRANSPORT")) {
+            config.transport = std::strcmp(transport, "unix") == 0 ? Transport::UnixDomain : Transport::Tcp;
+        }
+        return config.rank < config.worldSize;
+    }
+
+    uint16_t toHalf(double x) {
+        const uint16_t sign = std::signbit(x) ? 0x8000 : 0;
+        const double a = std::fabs(x);
+        if (std::isnan(x)) {
+            return 0x7E00;
+        }
+        if (a >= 65504.0) {
+            return sign | 0x7BFF;
+        }
+        if (a < 0x1p-14) {
+            // Subnormal: multiples of 2^-24; 1024 carries into the smallest normal
+            return sign | static_cast<uint16_t>(std::nearbyint(a * 0x1p24));
+        }
+        int e;
+        std::frexp(a, &e);   // a = f 2^e, f in [0.5, 1)
+        int exponent = e - 1 + 15;
+        double q = std::nearbyint(std::ldexp(a, 11 - e));   // 1.m scaled to [1024, 2048]
+        if (q == 2048.0) {
+            q = 1024.0;
+            ++exponent;
+        }
+        return sign | static_cast<uint16_t>(exponent << 10) | static_cast<uint16_t>(q - 1024.0);
+    }
+
+    double fromHalf(uint16_t h) {
+        const double sign = (h & 0x8000) ? -1.0 : 1.0;
+        const int exponent = (h >> 10) & 0x1F;
+        const int mantissa = h & 0x3FF;
+        if (exponent == 0) {
+            return sign * std::ldexp(mantissa, -24);
+        }
+        if (exponent == 31) {
+            return mantissa ? std::nan("") : sign * HUGE_VAL;
+        }
+        return sign * std::ldexp(1024 + mantissa, exponent - 25);
+    }
+
+    RingCommunicator::RingCommunicator(const DistributedConfig& config) : m_config(config) {
+        assert(config.worldSize > 0 && config.rank < config.worldSize);
+        ensureSocketsInitialized();
+    }
+
+    RingCommunicator::~RingCommunicator() {
+        close();
+    }
+
+    void RingCommunicator::close() {
+        for (intptr_t* s : { &m_listen, &m_next, &m_prev }) {
+            if (*s != kNoSocket) {
+                closeSocket(*s);
+                *s = kNoSocket;
+            }
+        }
+#if !defined(_WIN32)
+        if (m_config.transport == Transport::UnixDomain) {
+            sockaddr_storage addr;
+            if (endpointOf(m_config, m_config.rank, addr)) {
+                ::unlink(reinterpret_cast<sockaddr_un&>(addr).sun_path);
+            }
+        }
+#endif
+    }
+
+    bool RingCommunicator::connect() {
+        const size_t n = m_config.worldSize;
+        if (n == 1) {
+            return true;
+        }
+        const size_t r = m_config.rank;
+        const int family = familyOf(m_config);
+        sockaddr_storage addr;
+
+        // Listen first so the predecessor's connect is queued even before accept
+        int len = endpointOf(m_config, r, addr);
+        if (len == 0) {
+            return false;
+        }
+#if !defined(_WIN32)
+        if (family == AF_UNIX) {
+            ::unlink(reinterpret_cast<sockaddr_un&>(addr).sun_path);
+        }
+#endif
+        m_listen = static_cast<intptr_t>(::socket(family, SOCK_STREAM, 0));
+        if (m_listen == kNoSocket) {
+            return false;
+        }
+        if (family == AF_INET) {
+            int on = 1;
+            setsockopt(handle(m_listen), SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char*>(&on), sizeof(on));
+        }
+        if (::bind(handle(m_listen), reinterpret_cast<sockaddr*>(&addr), len) != 0
+            || ::listen(handle(m_listen), 1) != 0) {
+            close();
+            return false;
+        }
+
+        const auto deadline = std::chrono::steady_clock::now()
+            + std::chrono::milliseconds(m_config.connectTimeoutMs);
+        len = endpointOf(m_config, (r + 1) % n, addr);
+        for (;;) {
+            m_next = static_cast<intptr_t>(::socket(family, SOCK_STREAM, 0));
+            if (m_next != kNoSocket && ::connect(handle(m_next), reinterpret_cast<sockaddr*>(&addr), len) == 0) {
+                break;
+            }
+            if (m_next != kNoSocket) {
+                closeSocket(m_next);
+                m_next = kNoSocket;
+            }
+            if (std::chrono::steady_clock::now() > deadline) {
+                close();
+                return false;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+
+        pollfd pfd = {};
+        pfd.fd = handle(m_listen);
+        pfd.events = POLLIN;
+        auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+            deadline - std::chrono::steady_clock::now()).count();
+        if (pollSockets(&pfd, 1, static_cast<int>(std::max<long long>(remaining, 1))) != 1) {
+            close();
+            return false;
+        }
+        m_prev = static_cast<intptr_t>(::accept(handle(m_listen), nullptr, nullptr));
+        if (m_prev == kNoSocket) {
+            close();
+            return false;
+        }
+
+        if (family == AF_INET) {
+            int on = 1;
+            setsockopt(handle(m_next), IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&on), sizeof(on));
+            setsockopt(handle(m_prev), IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&on), sizeof(on));
+        }
+        setNonBlocking(m_next);
+        setNonBlocking(m_prev);
+
+        // Handshake: the peer behind us must be rank - 1
+        uint64_t mine = r, theirs = 0;
+        if (!exchange(&mine, sizeof(mine), &theirs, sizeof(theirs)) || theirs != (r + n - 1) % n) {
+            close();
+            return false;
+        }
+        m_bytesSent = 0;
+        return true;
+    }
+
+    bool RingCommunicator::exchange(const void* sendData, size_t sendBytes, void* recvData, size_t recvBytes) {
+        if (m_next == kNoSocket || m_prev == kNoSocket) {
+            return false;   // Closed, possibly by an earlier failure
+        }
+        // A failing rank drops out of the ring so its neighbours fail on
+        // their next read instead of waiting out kIoTimeoutMs
+        auto fail = [this] {
+            close();
+            return false;
+        };
+        const char* out = static_cast<const char*>(sendData);
+        char* in = static_cast<char*>(recvData);
+        size_t sent = 0, received = 0;
+        while (sent < sendBytes || received < recvBytes) {
+            pollfd fds[2] = {};
+            size_t count = 0;
+            int sendSlot = -1, recvSlot = -1;
+            if (sent < sendBytes) {
+                fds[count].fd = handle(m_next);
+                fds[count].events = POLLOUT;
+                sendSlot = static_cast<int>(count++);
+            }
+            if (received < recvBytes) {
+                fds[count].fd = handle(m_prev);
+                fds[count].events = POLLIN;
+                recvSlot = static_cast<int>(count++);
+            }
+            if (pollSockets(fds, count, kIoTimeoutMs) <= 0) {
+                return fail();
+            }
+            if (sendSlot >= 0 && fds[sendSlot].revents) {
+                auto k = ::send(handle(m_next), out + sent,
+                    static_cast<int>(std::min(sendBytes - sent, kMaxSendChunk)), kSendFlags);
+                if (k < 0 && !wouldBlock()) {
+                    return fail();
+                }
+                sent += k > 0 ? static_cast<size_t>(k) : 0;
+            }
+            if (recvSlot >= 0 && fds[recvSlot].revents) {
+                auto k = ::recv(handle(m_prev), in + received,
+                    static_cast<int>(std::min(recvBytes - received, kMaxSendChunk)), 0);
+                if (k == 0 || (k < 0 && !wouldBlock())) {
+                    return fail();   // Peer closed or failed
+                }
+                received += k > 0 ? static_cast<size_t>(k) : 0;
+            }
+        }
+        return true;
+    }
+
+    bool RingCommunicator::exchangeMessage(const std::vector<char>& out, std::vector<char>& in) {
+        uint64_t outSize = out.size(), inSize = 0;
+        if (!exchange(&outSize, sizeof(outSize), &inSize, sizeof(inSize))) {
+            return false;
+        }
+        in.resize(static_cast<size_t>(inSize));
+        m_bytesSent += out.size();
+        return exchange(out.data(), out.size(), in.data(), in.size());
+    }
+
+    bool RingCommunicator::allReduce(double* data, size_t count, size_t bucket) {
+        if (m_config.worldSize == 1 || count == 0) {
+            return true;
+        }
+        if (m_config.compression == GradientCompression::TopK) {
+            return topKAllReduce(data, count, bucket);
+        }
+        return ringAllReduce(data, count);
+    }
+
+    bool RingCommunicator::ringAllReduce(double* data, size_t count) {
+        const size_t n = m_config.worldSize;
+        const size_t r = m_config.rank;
+        const bool half = m_config.compression == GradientCompression::Fp16;
+        const size_t maxChunk = (count + n - 1) / n + 1;
+        std::vector<uint16_t> sendHalf(half ? maxChunk : 0), recvHalf(half ? maxChunk : 0);
+        std::vector<double> recvBuf(maxChunk);
+
+        auto step = [&](size_t sendChunk, size_t recvChunk, bool accumulate) {
+            const size_t sb = chunkBegin(sendChunk, count, n), se = chunkBegin(sendChunk + 1, count, n);
+            const size_t rb = chunkBegin(recvChunk, count, n), re = chunkBegin(recvChunk + 1, count, n);
+            bool ok;
+            if (half) {
+                for (size_t i = sb; i < se; ++i) {
+                    sendHalf[i - sb] = toHalf(data[i]);
+                }
+                ok = exchange(sendHalf.data(), (se - sb) * sizeof(uint16_t), recvHalf.data(), (re - rb) * sizeof(uint16_t));
+                for (size_t i = rb; ok && i < re; ++i) {
+                    recvBuf[i - rb] = fromHalf(recvHalf[i - rb]);
+                }
+                m_bytesSent += (se - sb) * sizeof(uint16_t);
+            }
+            else {
+                ok = exchange(data + sb, (se - sb) * sizeof(double), recvBuf.data(), (re - rb) * sizeof(double));
+                m_bytesSent += (se - sb) * sizeof(double);
+            }
+            for (size_t i = rb; ok && i < re; ++i) {
+                data[i] = accumulate ? data[i] + recvBuf[i - rb] : recvBuf[i - rb];
+            }
+            return ok;
+        };
+
+        // Reduce-scatter: afterwards this rank holds the full sum of chunk r + 1
+        for (size_t s = 0; s + 1 < n; ++s) {
+            if (!step((r + n - s) % n, (r + 2 * n - s - 1) % n, true)) {
+                return false;
+            }
+        }
+        if (half) {
+            // Round the owned chunk like the copies other ranks will decode
+            const size_t owned = (r + 1) % n;
+            for (size_t i = chunkBegin(owned, count, n); i < chunkBegin(owned + 1, count, n); ++i) {
+                data[i] = fromHalf(toHalf(data[i]));
+            }
+        }
+        // All-gather: pass the finished chunks around the ring
+        for (size_t s = 0; s + 1 < n; ++s) {
+            if (!step((r + 1 + n - s) % n, (r + n - s) % n, false)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool RingCommunicator::topKAllReduce(double* data, size_t count, size_t bucket) {
+        const size_t n = m_config.worldSize;
+        const size_t r = m_config.rank;
+        std::vector<double>& residual = m_residuals[bucket];
+        residual.resize(count, 0.0);
+
+        // Error feedback: what was not sent last time is added back now
+        for (size_t i = 0; i < count; ++i) {
+            residual[i] += data[i];
+        }
+        size_t k = static_cast<size_t>(std::llround(m_config.topKFraction * static_cast<double>(count)));
+        k = std::min(std::max<size_t>(k, 1), count);
+        std::vector<uint32_t> order(count);
+        std::iota(order.begin(), order.end(), 0u);
+        std::nth_element(order.begin(), order.begin() + (k - 1), order.end(),
+            [&](uint32_t a, uint32_t b) { return std::abs(residual[a]) > std::abs(residual[b]); });
+
+        struct Entry {
+            uint32_t index;
+            float value;
+        };
+        std::vector<char> own(k * sizeof(Entry));
+        for (size_t e = 0; e < k; ++e) {
+            Entry entry = { order[e], static_cast<float>(residual[order[e]]) };
+            residual[entry.index] -= static_cast<double>(entry.value);
+            std::memcpy(own.data() + e * sizeof(Entry), &entry, sizeof(Entry));
+        }
+
+        // Ring all-gather of every rank's sparse message
+        std::vector<std::vector<char>> messages(n);
+        messages[r] = own;
+        for (size_t s = 0; s + 1 < n; ++s) {
+            const std::vector<char>& out = messages[(r + n - s) % n];
+            std::vector<char>& in = messages[(r + 2 * n - s - 1) % n];
+            if (!exchangeMessage(out, in)) {
+                return false;
+            }
+        }
+
+        // Sum in rank order so every rank gets bit-identical results
+        std::fill(data, data + count, 0.0);
+        for (const std::vector<char>& message : messages) {
+            for (size_t off = 0; off + sizeof(Entry) <= message.size(); off += sizeof(Entry)) {
+                Entry entry;
+                std::memcpy(&entry, message.data() + off, sizeof(Entry));
+                if (entry.index < count) {
+                    data[entry.index] += static_cast<double>(entry.value);
+                }
+            }
+        }
+        return true;
+    }
+
+    bool RingCommunicator::broadcast(double* data, size_t count, size_t root) {
+        const size_t n = m_config.worldSize;
+        if (n == 1 || count == 0) {
+            return true;
+        }
+        const size_t r = m_config.rank;
+        const size_t bytes = count * sizeof(double);
+        // Pass along the chain root -> root + 1 -> ... -> root - 1
+        if (r != root && !exchange(nullptr, 0, data, bytes)) {
+            return false;
+        }
+        if ((r + 1) % n != root) {
+            m_bytesSent += bytes;
+            return exchange(data, bytes, nullptr, 0);
+        }
+        return true;
+    }
+
+    std::string currentExecutablePath() {
+#if defined(_WIN32)
+        char buffer[MAX_PATH];
+        DWORD len = GetModuleFileNameA(nullptr, buffer, MAX_PATH);
+        return (len > 0 && len < MAX_PATH) ? std::string(buffer, len) : std::string();
+#elif defined(__linux__)
+        char buffer[4096];
+        ssize_t len = ::readlink("/proc/self/exe", buffer, sizeof(buffer));
+        return (len > 0 && static_cast<size_t>(len) < sizeof(buffer)) ? std::string(buffer, static_cast<size_t>(len)) : std::string();
+#else
+        return std::string();
+#endif
+    }
+
+    size_t launchLocalWorkers(const std::string& executable,
+        const std::vector<std::string>& args, const DistributedConfig& config) {
+        const size_t n = config.worldSize;
+        const std::string transport = config.transport == Transport::UnixDomain ? "unix" : "tcp";
+        auto environmentFor = [&](size_t rank) {
+            return std::vector<std::string>{
+                "NN_RANK=" + std::to_string(rank),
+                "NN_WORLD_SIZE=" + std::to_string(n),
+                "NN_BASE_PORT=" + std::to_string(config.basePort),
+                "NN_TRANSPORT=" + transport };
+        };
+        size_t failed = 0;
+
+#if defined(_WIN32)
+        std::string commandLine = "\"" + executable + "\"";
+        for (const std::string& arg : args) {
+            commandLine += " \"" + arg + "\"";
+        }
+        std::vector<HANDLE> processes;
+        for (size_t rank = 0; rank < n; ++rank) {
+            // Children inherit the parent's environment at creation time
+            for (const std::string& var : environmentFor(rank)) {
+                size_t eq = var.find('=');
+                SetEnvironmentVariableA(var.substr(0, eq).c_str(), var.substr(eq + 1).c_str());
+            }
+            STARTUPINFOA startup = {};
+            startup.cb = sizeof(startup);
+            PROCESS_INFORMATION info = {};
+            std::vector<char> cmd(commandLine.begin(), commandLine.end());
+            cmd.push_back('\0');
+            if (!CreateProcessA(executable.c_str(), cmd.data(), nullptr, nullptr, FALSE, 0,
+                nullptr, nullptr, &startup, &info)) {
+                ++failed;
+                continue;
+            }
+            CloseHandle(info.hThread);
+            processes.push_back(info.hProcess);
+        }
+        for (const char* name : { "NN_RANK", "NN_WORLD_SIZE", "NN_BASE_PORT", "NN_TRANSPORT" }) {
+            SetEnvironmentVariableA(name, nullptr);
+        }
+        for (HANDLE process : processes) {
+            WaitForSingleObject(process, INFINITE);
+            DWORD code = 1;
+            GetExitCodeProcess(process, &code);
+            failed += code != 0;
+            CloseHandle(process);
+        }
+#else
+        std::vector<pid_t> children;
+        for (size_t rank = 0; rank < n; ++rank) {
+            // Build argv and envp before fork: the child may only exec
+            std::vector<std::string> env = environmentFor(rank);
+            std::vector<char*> envp;
+            for (char** e = environ; *e; ++e) {
+                if (std::strncmp(*e, "NN_", 3) != 0) {
+                    envp.push_back(*e);
+                }
+            }
+            for (std::string& var : env) {
+                envp.push_back(&var[0]);
+            }
+            envp.push_back(nullptr);
+            std::vector<std::string> argStore = args;
+            std::vector<char*> argv = { const_cast<char*>(executable.c_str()) };
+            for (std::string& arg : argStore) {
+                argv.push_back(&arg[0]);
+            }
+            argv.push_back(nullptr);
+
+            pid_t pid = fork();
+            if (pid == 0) {
+                execve(executable.c_str(), argv.data(), envp.data());
+                _exit(127);
+            }
+            if (pid < 0) {
+                ++failed;
+                continue;
+            }
+            children.push_back(pid);
+        }
+        for (pid_t pid : children) {
+            int status = 0;
+            if (waitpid(pid, &status, 0) != pid || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+                ++failed;
+            }
+        }
+#endif
+        return failed;
+    }
+
+}  // namespace nn
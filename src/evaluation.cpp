@@ -0,0 +1,198 @@
+#include "../include/evaluation.h"
+#include "../include/execution_backend.h"
+#include "../include/loss.h"
+
+#include <algorithm>
+#include <cassert>
+#include <numeric>
+
+namespace nn {
+
+    namespace {
+
+        /**
+         * @brief What one batch contributes; merged in batch order.
+         */
+        struct PartialMetrics {
+            double lossSum = 0.0;
+            size_t correct = 0;
+            std::vector<size_t> confusion;
+            std::vector<double> scores;   ///< Predictions, row-major, kept for AUC
+            std::vector<size_t> labels;   ///< Actual class of each row, kept for AUC
+        };
+
+        template <typename Traits>
+        double rowLoss(const double* p, const double* t, size_t cols) {
+            double sum = 0.0;
+            for (size_t c = 0; c < cols; ++c) {
+                sum += Traits::value(p[c], t[c]);
+            }
+            return sum;
+        }
+
+        size_t classOf(const double* row, size_t cols) {
+            if (cols == 1) {
+                return row[0] >= 0.5 ? 1 : 0;
+            }
+            return static_cast<size_t>(std::max_element(row, row + cols) - row);
+        }
+
+        /**
+         * @brief Mann-Whitney AUC: probability a random positive outscores a
+         *        random negative, ties counting half.
+         */
+        double aucOf(const std::vector<double>& scores, const std::vector<bool>& positive) {
+            const size_t n = scores.size();
+            std::vector<size_t> order(n);
+            std::iota(order.begin(), order.end(), 0);
+            std::sort(order.begin(), order.end(), [&](size_t a, size_t b) { return scores[a] < scores[b]; });
+
+            double positiveRankSum = 0.0;
+            size_t positives = 0;
+            for (size_t i = 0; i < n;) {
+                size_t j = i;
+                while (j < n && scores[order[j]] == scores[order[i]]) {
+                    ++j;
+                }
+                // Tied scores share the mean of ranks i+1 .. j
+                const double rank = 0.5 * static_cast<double>(i + 1 + j);
+                for (size_t k = i; k < j; ++k) {
+                    if (positive[order[k]]) {
+                        positiveRankSum += rank;
+                        ++positives;
+                    }
+                }
+                i = j;
+            }
+            const size_t negatives = n - positives;
+            if (positives == 0 || negatives == 0) {
+                return 0.5;
+            }
+            const double p = static_cast<double>(positives);
+            return (positiveRankSum - p * (p + 1.0) / 2.0) / (p * static_cast<double>(negatives));
+        }
+
+    }  // namespace
+
+    Matrix stackSamples(const std::vector<Matrix>& rows) {
+        assert(!rows.empty());
+        const size_t cols = rows.front().cols();
+        Matrix stacked(rows.size(), cols);
+        placeMatrix(stacked, TensorRole::Dataset);
+        parallelFor(rows.size(), std::max<size_t>(1, 4096 / std::max<size_t>(cols, 1)),
+            [&](size_t begin, size_t end) {
+                for (size_t i = begin; i < end; ++i) {
+                    assert(rows[i].rows() == 1 && rows[i].cols() == cols);
+                    std::copy(rows[i].data().begin(), rows[i].data().end(),
+                        stacked.data().begin() + i * cols);
+                }
+            });
+        return stacked;
+    }
+
+    EvaluationResult evaluate(const NeuralNetwork& net, const Dataset& data,
+        const std::vector<Metric>& metrics, size_t batchRows) {
+        assert(data.inputs.size() == data.targets.size());
+        auto wants = [&](Metric m) { return std::find(metrics.begin(), metrics.end(), m) != metrics.end(); };
+        const bool wantLoss = wants(Metric::Loss);
+        const bool wantAccuracy = wants(Metric::Accuracy);
+        const bool wantAuc = wants(Metric::AUC);
+        const bool wantConfusion = wants(Metric::ConfusionMatrix);
+
+        EvaluationResult result;
+        result.samples = data.size();
+        if (data.empty()) {
+            return result;
+        }
+        const size_t inDim = data.inputs[0].cols();
+        const size_t outDim = data.targets[0].cols();
+        const size_t classes = (outDim == 1) ? 2 : outDim;
+        result.numClasses = classes;
+
+        const Matrix inputs = stackSamples(data.inputs);
+        const Matrix targets = stackSamples(data.targets);
+
+        batchRows = std::max<size_t>(batchRows, 1);
+        const size_t numBatches = (data.size() + batchRows - 1) / batchRows;
+        std::vector<PartialMetrics> partials(numBatches);
+
+        parallelFor(numBatches, 1, [&](size_t batchBegin, size_t batchEnd) {
+            for (size_t b = batchBegin; b < batchEnd; ++b) {
+                const size_t first = b * batchRows;
+                const size_t rows = std::min(batchRows, data.size() - first);
+                Matrix input(rows, inDim);
+                std::copy(inputs.data().begin() + first * inDim,
+                    inputs.data().begin() + (first + rows) * inDim, input.data().begin());
+                Matrix pred = net.predict(input);
+
+                PartialMetrics& part = partials[b];
+                if (wantConfusion) {
+                    part.confusion.assign(classes * classes, 0);
+                }
+                for (size_t r = 0; r < rows; ++r) {
+                    const double* p = pred.data().data() + r * outDim;
+                    const double* t = targets.data().data() + (first + r) * outDim;
+                    if (wantLoss) {
+                        part.lossSum += (net.lossType() == LossType::CrossEntropy)
+                            ? rowLoss<LossTraits<LossType::CrossEntropy>>(p, t, outDim)
+                            : rowLoss<LossTraits<LossType::MSE>>(p, t, outDim);
+                    }
+                    const size_t actual = classOf(t, outDim);
+                    const size_t predicted = classOf(p, outDim);
+                    part.correct += (actual == predicted) ? 1 : 0;
+                    if (wantConfusion) {
+                        ++part.confusion[actual * classes + predicted];
+                    }
+                    if (wantAuc) {
+                        part.scores.insert(part.scores.end(), p, p + outDim);
+                        part.labels.push_back(actual);
+                    }
+                }
+            }
+        });
+
+        double lossSum = 0.0;
+        size_t correct = 0;
+        std::vector<double> scores;
+        std::vector<size_t> labels;
+        if (wantConfusion) {
+            result.confusion.assign(classes * classes, 0);
+        }
+        for (const PartialMetrics& part : partials) {
+            lossSum += part.lossSum;
+            correct += part.correct;
+            for (size_t k = 0; k < part.confusion.size(); ++k) {
+                result.confusion[k] += part.confusion[k];
+            }
+            scores.insert(scores.end(), part.scores.begin(), part.scores.end());
+            labels.insert(labels.end(), part.labels.begin(), part.labels.end());
+        }
+
+        const double count = static_cast<double>(data.size());
+        if (wantLoss) {
+            result.loss = lossSum / count;
+        }
+        if (wantAccuracy) {
+            result.accuracy = static_cast<double>(correct) / count;
+        }
+        if (wantAuc) {
+            // Binary: the single output scores class 1. Otherwise each class
+            // against the rest, scored by its own output.
+            const size_t curves = (outDim == 1) ? 1 : classes;
+            double sum = 0.0;
+            std::vector<double> column(labels.size());
+            std::vector<bool> positive(labels.size());
+            for (size_t c = 0; c < curves; ++c) {
+                const size_t cls = (outDim == 1) ? 1 : c;
+                for (size_t r = 0; r < labels.size(); ++r) {
+                    column[r] = scores[r * outDim + (outDim == 1 ? 0 : c)];
+                    positive[r] = (labels[r] == cls);
+                }
+                sum += aucOf(column, positive);
+            }
+            result.auc = sum / static_cast<double>(curves);
+        }
+        return result;
+    }
+
+}  // namespace nn
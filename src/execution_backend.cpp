@@ -0,0 +1,222 @@
+#include "../include/execution_backend.h"
+#include "../include/threading.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <execution>
+#include <memory>
+#include <mutex>
+#include <numeric>
+#include <string>
+#include <vector>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#elif defined(__linux__)
+#include <linux/mempolicy.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace nn {
+
+    namespace {
+
+        ExecutionConfig& config() {
+            static ExecutionConfig c;
+            return c;
+        }
+
+        std::unique_ptr<ThreadGroup>& group() {
+            static std::unique_ptr<ThreadGroup> g;
+            return g;
+        }
+
+        // Held while the group runs a loop; callers that miss it go serial
+        std::mutex& groupMutex() {
+            static std::mutex m;
+            return m;
+        }
+
+        thread_local bool t_insideParallelFor = false;
+
+#if defined(__linux__)
+        bool pathExists(const std::string& path) {
+            struct stat st;
+            return stat(path.c_str(), &st) == 0;
+        }
+
+        bool bindPages(void* begin, size_t bytes, int mode, const std::vector<size_t>& nodes) {
+            std::vector<unsigned long> mask(std::max<size_t>(numaNodeCount(), 1) / 64 + 1, 0);
+            for (size_t node : nodes) {
+                mask[node / 64] |= 1UL << (node % 64);
+            }
+            return syscall(SYS_mbind, begin, bytes, mode, mask.data(),
+                mask.size() * 64, MPOL_MF_MOVE) == 0;
+        }
+#endif
+
+    }  // namespace
+
+    void setExecutionConfig(const ExecutionConfig& newConfig) {
+        std::lock_guard<std::mutex> lock(groupMutex());
+        config() = newConfig;
+        group().reset();
+        if (newConfig.backend == ExecutionBackend::PinnedThreads) {
+            group() = std::make_unique<ThreadGroup>(newConfig.numThreads,
+                newConfig.pinThreads, newConfig.firstCore);
+        }
+    }
+
+    const ExecutionConfig& executionConfig() {
+        return config();
+    }
+
+    void parallelFor(size_t count, size_t grain, const std::function<void(size_t, size_t)>& body) {
+        grain = std::max<size_t>(grain, 1);
+        if (count <= grain || t_insideParallelFor) {
+            if (count > 0) {
+                body(0, count);
+            }
+            return;
+        }
+        const size_t maxChunks = (count + grain - 1) / grain;
+
+        if (config().backend == ExecutionBackend::PinnedThreads) {
+            std::unique_lock<std::mutex> lock(groupMutex(), std::try_to_lock);
+            if (!lock.owns_lock() || !group()) {
+                body(0, count);
+                return;
+            }
+            const size_t workers = std::min(group()->size(), maxChunks);
+            group()->run([&](size_t t) {
+                if (t >= workers) {
+                    return;
+                }
+                t_insideParallelFor = true;
+                body(count * t / workers, count * (t + 1) / workers);
+                t_insideParallelFor = false;
+            });
+            return;
+        }
+
+        // A few chunks per core lets the scheduler balance uneven ones
+        const size_t chunks = std::min(maxChunks, 4 * hardwareConcurrency());
+        std::vector<size_t> ids(chunks);
+        std::iota(ids.begin(), ids.end(), 0);
+        std::for_each(std::execution::par, ids.begin(), ids.end(), [&](size_t c) {
+            body(count * c / chunks, count * (c + 1) / chunks);
+        });
+    }
+
+    size_t numaNodeCount() {
+#if defined(_WIN32)
+        ULONG highest = 0;
+        return GetNumaHighestNodeNumber(&highest) ? highest + 1 : 1;
+#elif defined(__linux__)
+        static const size_t count = [] {
+            size_t n = 0;
+            while (pathExists("/sys/devices/system/node/node" + std::to_string(n))) {
+                ++n;
+            }
+            return std::max<size_t>(n, 1);
+        }();
+        return count;
+#else
+        return 1;
+#endif
+    }
+
+    size_t numaNodeOfCore(size_t core) {
+        core %= hardwareConcurrency();
+#if defined(_WIN32)
+        USHORT node = 0;
+        PROCESSOR_NUMBER processor = {};
+        processor.Group = static_cast<WORD>(core / 64);
+        processor.Number = static_cast<BYTE>(core % 64);
+        return GetNumaProcessorNodeEx(&processor, &node) ? node : 0;
+#elif defined(__linux__)
+        for (size_t n = 0; n < numaNodeCount(); ++n) {
+            if (pathExists("/sys/devices/system/node/node" + std::to_string(n) +
+                "/cpu" + std::to_string(core))) {
+                return n;
+            }
+        }
+        return 0;
+#else
+        (void)core;
+        return 0;
+#endif
+    }
+
+    bool placeMemory(void* data, size_t bytes, NumaPolicy policy) {
+#if defined(__linux__)
+        const size_t nodes = numaNodeCount();
+        if (nodes <= 1) {
+            return false;
+        }
+        // mbind works on whole pages; partial pages at the ends stay put
+        const uintptr_t page = static_cast<uintptr_t>(sysconf(_SC_PAGESIZE));
+        const uintptr_t begin = (reinterpret_cast<uintptr_t>(data) + page - 1) / page * page;
+        const uintptr_t end = (reinterpret_cast<uintptr_t>(data) + bytes) / page * page;
+        if (end <= begin) {
+            return false;
+        }
+        const size_t pages = (end - begin) / page;
+        const ExecutionConfig& cfg = config();
+
+        switch (policy) {
+        case NumaPolicy::Interleave: {
+            std::vector<size_t> all(nodes);
+            std::iota(all.begin(), all.end(), 0);
+            return bindPages(reinterpret_cast<void*>(begin), end - begin, MPOL_INTERLEAVE, all);
+        }
+        case NumaPolicy::Bind:
+            return bindPages(reinterpret_cast<void*>(begin), end - begin, MPOL_BIND,
+                { cfg.bindNode % nodes });
+        case NumaPolicy::FirstTouch: {
+            // Threads that float have no home node to place on
+            if (cfg.backend != ExecutionBackend::PinnedThreads || !cfg.pinThreads || !group()) {
+                return false;
+            }
+            // Same bands as parallelFor hands to each worker
+            const size_t workers = group()->size();
+            bool ok = true;
+            for (size_t t = 0; t < workers; ++t) {
+                const size_t first = pages * t / workers;
+                const size_t last = pages * (t + 1) / workers;
+                if (first < last) {
+                    ok &= bindPages(reinterpret_cast<void*>(begin + first * page), (last - first) * page,
+                        MPOL_PREFERRED, { numaNodeOfCore(cfg.firstCore + t) });
+                }
+            }
+            return ok;
+        }
+        }
+        return false;
+#else
+        // Windows can only place memory at allocation (VirtualAllocExNuma)
+        (void)data;
+        (void)bytes;
+        (void)policy;
+        return false;
+#endif
+    }
+
+    bool placeMatrix(Matrix& m, TensorRole role) {
+        const ExecutionConfig& cfg = config();
+        NumaPolicy policy = cfg.weightPolicy;
+        if (role == TensorRole::Activations) {
+            policy = cfg.activationPolicy;
+        }
+        else if (role == TensorRole::Dataset) {
+            policy = cfg.datasetPolicy;
+        }
+        return placeMemory(m.data().data(), m.data().size() * sizeof(double), policy);
+    }
+
+}  // namespace nn
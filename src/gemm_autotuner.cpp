@@ -0,0 +1,480 @@
+#include "../include/gemm_autotuner.h"
+#include "../include/execution_backend.h"
+#include "../include/matrix.h"
+#include "../include/threading.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <limits>
+#include <mutex>
+#include <shared_mutex>
+#include <sstream>
+#include <unordered_map>
+
+namespace nn {
+
+    namespace {
+
+        // Multiply-adds below which a band is not worth its own task.
+        constexpr size_t kTaskWorkThreshold = 16 * 16 * 16;
+
+        // A tuned plan must beat the default by this much to replace it, so
+        // timing noise does not churn the cache.
+        constexpr double kMinSpeedup = 1.03;
+
+        struct ShapeKey {
+            size_t M, N, K;
+            bool operator==(const ShapeKey& o) const { return M == o.M && N == o.N && K == o.K; }
+        };
+
+        struct ShapeHash {
+            size_t operator()(const ShapeKey& s) const {
+                size_t h = s.M;
+                h = h * 1000003u ^ s.N;
+                h = h * 1000003u ^ s.K;
+                return h;
+            }
+        };
+
+        GemmTunerConfig& config() {
+            static GemmTunerConfig c;
+            return c;
+        }
+
+        std::unordered_map<ShapeKey, GemmPlan, ShapeHash>& cache() {
+            static std::unordered_map<ShapeKey, GemmPlan, ShapeHash> c;
+            return c;
+        }
+
+        std::shared_mutex& cacheMutex() {
+            static std::shared_mutex m;
+            return m;
+        }
+
+        // Lets the hot path skip the lock while nothing is cached
+        std::atomic<size_t> g_cacheSize{ 0 };
+
+        // One benchmark at a time: concurrent ones would time each other
+        std::mutex& tuneMutex() {
+            static std::mutex m;
+            return m;
+        }
+
+        bool lookup(const ShapeKey& key, GemmPlan& plan) {
+            if (g_cacheSize.load(std::memory_order_acquire) == 0) {
+                return false;
+            }
+            std::shared_lock<std::shared_mutex> lock(cacheMutex());
+            auto it = cache().find(key);
+            if (it == cache().end()) {
+                return false;
+            }
+            plan = it->second;
+            return true;
+        }
+
+        void store(const ShapeKey& key, const GemmPlan& plan) {
+            std::unique_lock<std::shared_mutex> lock(cacheMutex());
+            cache()[key] = plan;
+            g_cacheSize.store(cache().size(), std::memory_order_release);
+        }
+
+        /**
+         * @brief Rows [rowBegin, rowEnd), columns [colBegin, colEnd) of C += A * B
+         *        over k in [kBegin, kEnd), one row of C at a time.
+         */
+        void rowStream(const double* A, const double* B, double* C, size_t N, size_t K,
+            size_t rowBegin, size_t rowEnd, size_t colBegin, size_t colEnd, size_t kBegin, size_t kEnd) {
+            for (size_t i = rowBegin; i < rowEnd; ++i) {
+                double* c = C + i * N;
+                const double* a = A + i * K;
+                for (size_t k = kBegin; k < kEnd; ++k) {
+                    const double aik = a[k];
+                    const double* b = B + k * N;
+                    for (size_t j = colBegin; j < colEnd; ++j) {
+                        c[j] += aik * b[j];
+                    }
+                }
+            }
+        }
+
+        /**
+         * @brief As rowStream, but four rows of C per pass so each row of B
+         *        is loaded once for all four.
+         */
+        void registerTile(const double* A, const double* B, double* C, size_t N, size_t K,
+            size_t rowBegin, size_t rowEnd, size_t colBegin, size_t colEnd, size_t kBegin, size_t kEnd) {
+            size_t i = rowBegin;
+            for (; i + 4 <= rowEnd; i += 4) {
+                double* c0 = C + i * N;
+                double* c1 = c0 + N;
+                double* c2 = c1 + N;
+                double* c3 = c2 + N;
+                const double* a0 = A + i * K;
+                const double* a1 = a0 + K;
+                const double* a2 = a1 + K;
+                const double* a3 = a2 + K;
+                for (size_t k = kBegin; k < kEnd; ++k) {
+                    const double x0 = a0[k], x1 = a1[k], x2 = a2[k], x3 = a3[k];
+                    const double* b = B + k * N;
+                    for (size_t j = colBegin; j < colEnd; ++j) {
+                        const double bj = b[j];
+                        c0[j] += x0 * bj;
+                        c1[j] += x1 * bj;
+                        c2[j] += x2 * bj;
+                        c3[j] += x3 * bj;
+                    }
+                }
+            }
+            rowStream(A, B, C, N, K, i, rowEnd, colBegin, colEnd, kBegin, kEnd);
+        }
+
+        /**
+         * @brief Rows [rowBegin, rowEnd), columns [colBegin, colEnd) of C = A * B.
+         */
+        void gemmRange(const GemmPlan& plan, const double* A, const double* B, double* C,
+            size_t N, size_t K, size_t rowBegin, size_t rowEnd, size_t colBegin, size_t colEnd) {
+            for (size_t i = rowBegin; i < rowEnd; ++i) {
+                std::fill(C + i * N + colBegin, C + i * N + colEnd, 0.0);
+            }
+            switch (plan.kernel) {
+            case GemmKernel::RowStream:
+                rowStream(A, B, C, N, K, rowBegin, rowEnd, colBegin, colEnd, 0, K);
+                break;
+            case GemmKernel::RegisterTile:
+                registerTile(A, B, C, N, K, rowBegin, rowEnd, colBegin, colEnd, 0, K);
+                break;
+            case GemmKernel::Blocked: {
+                // A blockK x blockN tile of B stays in cache across all rows;
+                // k blocks run in increasing order, so sums keep their order
+                const size_t bn = std::max<size_t>(plan.blockN, 1);
+                const size_t bk = std::max<size_t>(plan.blockK, 1);
+                for (size_t j = colBegin; j < colEnd; j += bn) {
+                    const size_t jEnd = std::min(j + bn, colEnd);
+                    for (size_t k = 0; k < K; k += bk) {
+                        registerTile(A, B, C, N, K, rowBegin, rowEnd, j, jEnd, k, std::min(k + bk, K));
+                    }
+                }
+                break;
+            }
+            }
+        }
+
+        const char* kernelName(GemmKernel kernel) {
+            switch (kernel) {
+            case GemmKernel::RegisterTile: return "RegisterTile";
+            case GemmKernel::Blocked: return "Blocked";
+            default: return "RowStream";
+            }
+        }
+
+        bool parseKernel(const std::string& name, GemmKernel& kernel) {
+            for (GemmKernel k : { GemmKernel::RowStream, GemmKernel::RegisterTile, GemmKernel::Blocked }) {
+                if (name == kernelName(k)) {
+                    kernel = k;
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        /**
+         * @brief Benchmarks the candidates for a shape. Caller holds tuneMutex.
+         */
+        GemmPlan tuneLocked(const ShapeKey& key) {
+            const size_t M = key.M, N = key.N, K = key.K;
+            const double budget = config().secondsPerShape;
+
+            // Scratch operands; deterministic so tuning never advances the RNG
+            Matrix::Storage a(M * K), b(K * N), c(M * N);
+            for (size_t e = 0; e < a.size(); ++e) {
+                a[e] = 0.25 * static_cast<double>(e % 7) - 0.75;
+            }
+            for (size_t e = 0; e < b.size(); ++e) {
+                b[e] = 0.125 * static_cast<double>(e % 11) - 0.625;
+            }
+
+            using Clock = std::chrono::steady_clock;
+            auto timeOnce = [&](const GemmPlan& plan) {
+                const Clock::time_point start = Clock::now();
+                runGemm(plan, a.data(), b.data(), c.data(), M, N, K);
+                return std::chrono::duration<double>(Clock::now() - start).count();
+            };
+
+            const std::vector<GemmPlan> candidates = gemmCandidates(M, N, K);
+            const Clock::time_point start = Clock::now();
+            GemmPlan fallback = candidates.front();
+            timeOnce(fallback);   // Warm-up: page faults, caches, thread wake-up
+            const double first = timeOnce(fallback);
+
+            // Best of a few runs while the budget allows all candidates that
+            // many; very large shapes get one run each
+            const double perRun = first * static_cast<double>(candidates.size());
+            const int reps = std::max(1, std::min(5, static_cast<int>(budget / std::max(perRun, 1e-9))));
+
+            GemmPlan best = fallback;
+            best.seconds = std::numeric_limits<double>::max();
+            for (size_t p = 0; p < candidates.size(); ++p) {
+                if (p > 0 && std::chrono::duration<double>(Clock::now() - start).count() > budget) {
+                    break;
+                }
+                GemmPlan plan = candidates[p];
+                plan.seconds = (p == 0) ? first : std::numeric_limits<double>::max();
+                for (int r = (p == 0) ? 1 : 0; r < reps; ++r) {
+                    plan.seconds = std::min(plan.seconds, timeOnce(plan));
+                }
+                if (p == 0) {
+                    fallback = plan;
+                }
+                if (plan.seconds < best.seconds) {
+                    best = plan;
+                }
+            }
+            if (best.seconds * kMinSpeedup > fallback.seconds) {
+                best = fallback;
+            }
+            store(key, best);
+            return best;
+        }
+
+        void saveConfiguredCache() {
+            if (!config().cachePath.empty()) {
+                saveGemmCache(config().cachePath);
+            }
+        }
+
+    }  // namespace
+
+    bool setGemmTunerConfig(const GemmTunerConfig& newConfig) {
+        config() = newConfig;
+        if (newConfig.cachePath.empty()) {
+            return true;
+        }
+        return loadGemmCache(newConfig.cachePath);
+    }
+
+    const GemmTunerConfig& gemmTunerConfig() {
+        return config();
+    }
+
+    GemmPlan gemmPlan(size_t M, size_t N, size_t K) {
+        const GemmTunerConfig& cfg = config();
+        if (cfg.mode == GemmTuning::Off || M * N * K < cfg.minWork) {
+            return GemmPlan();
+        }
+        const ShapeKey key{ M, N, K };
+        GemmPlan plan;
+        if (lookup(key, plan)) {
+            return plan;
+        }
+        if (cfg.mode == GemmTuning::Online) {
+            // Another thread tuning: use the default rather than wait
+            std::unique_lock<std::mutex> lock(tuneMutex(), std::try_to_lock);
+            if (lock.owns_lock()) {
+                if (!lookup(key, plan)) {
+                    plan = tuneLocked(key);
+                    saveConfiguredCache();
+                }
+                return plan;
+            }
+        }
+        return GemmPlan();
+    }
+
+    GemmPlan tuneGemm(size_t M, size_t N, size_t K) {
+        std::lock_guard<std::mutex> lock(tuneMutex());
+        GemmPlan plan = tuneLocked(ShapeKey{ M, N, K });
+        saveConfiguredCache();
+        return plan;
+    }
+
+    size_t tuneGemmForNetwork(const NeuralNetwork& net, size_t batchRows) {
+        std::vector<ShapeKey> shapes;
+        for (size_t i = 0; i < net.numLayers(); ++i) {
+            const size_t in = net.weights()[i].rows();
+            const size_t out = net.weights()[i].cols();
+            shapes.push_back({ batchRows, out, in });      // X W
+            shapes.push_back({ in, out, batchRows });      // X^T dY
+            if (i > 0) {
+                shapes.push_back({ batchRows, in, out });  // dY W^T
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(tuneMutex());
+        size_t tuned = 0;
+        for (size_t s = 0; s < shapes.size(); ++s) {
+            const ShapeKey& key = shapes[s];
+            GemmPlan plan;
+            if (key.M * key.N * key.K < config().minWork || lookup(key, plan)) {
+                continue;
+            }
+            tuneLocked(key);
+            ++tuned;
+        }
+        if (tuned > 0) {
+            saveConfiguredCache();
+        }
+        return tuned;
+    }
+
+    std::vector<GemmPlan> gemmCandidates(size_t M, size_t N, size_t K) {
+        std::vector<GemmPlan> candidates(1);   // Default plan first
+
+        const size_t threads = hardwareConcurrency();
+        std::vector<size_t> taskCounts = { threads };
+        for (size_t t = threads / 2; t >= 1; t /= 2) {
+            taskCounts.push_back(t);
+        }
+        taskCounts.erase(std::unique(taskCounts.begin(), taskCounts.end()), taskCounts.end());
+
+        std::vector<GemmPlan> kernels(1);
+        if (M >= 4) {
+            kernels.push_back(GemmPlan());
+            kernels.back().kernel = GemmKernel::RegisterTile;
+            const size_t blocks[][2] = { { 64, 256 }, { 128, 512 }, { 256, 128 } };
+            for (const auto& block : blocks) {
+                if (block[0] < K || block[1] < N) {
+                    kernels.push_back(GemmPlan());
+                    kernels.back().kernel = GemmKernel::Blocked;
+                    kernels.back().blockK = block[0];
+                    kernels.back().blockN = block[1];
+                }
+            }
+        }
+
+        const size_t work = M * N * K;
+        for (const GemmPlan& kernel : kernels) {
+            for (GemmAxis axis : { GemmAxis::Rows, GemmAxis::Columns }) {
+                // Column bands narrower than a few cache lines share lines of C
+                const size_t limit = (axis == GemmAxis::Rows) ? M : std::max<size_t>(1, N / 16);
+                for (size_t t : taskCounts) {
+                    if (t > limit || (t > 1 && work / t < kTaskWorkThreshold)
+                        || (t == 1 && axis == GemmAxis::Columns)) {
+                        continue;
+                    }
+                    GemmPlan plan = kernel;
+                    plan.axis = axis;
+                    plan.tasks = t;
+                    candidates.push_back(plan);
+                }
+            }
+        }
+        return candidates;
+    }
+
+    void runGemm(const GemmPlan& plan, const double* A, const double* B, double* C,
+        size_t M, size_t N, size_t K) {
+        if (M == 0 || N == 0) {
+            return;
+        }
+        if (plan.tasks == 1) {
+            gemmRange(plan, A, B, C, N, K, 0, M, 0, N);
+            return;
+        }
+        if (plan.axis == GemmAxis::Rows) {
+            // Untuned: enough rows per task for kTaskWorkThreshold multiply-adds
+            const size_t grain = plan.tasks == 0
+                ? std::max<size_t>(1, kTaskWorkThreshold / std::max<size_t>(1, N * K))
+                : (M + plan.tasks - 1) / plan.tasks;
+            parallelFor(M, grain, [&](size_t begin, size_t end) {
+                gemmRange(plan, A, B, C, N, K, begin, end, 0, N);
+            });
+        }
+        else {
+            const size_t grain = plan.tasks == 0
+                ? std::max<size_t>(1, kTaskWorkThreshold / std::max<size_t>(1, M * K))
+                : (N + plan.tasks - 1) / plan.tasks;
+            parallelFor(N, grain, [&](size_t begin, size_t end) {
+                gemmRange(plan, A, B, C, N, K, 0, M, begin, end);
+            });
+        }
+    }
+
+    bool loadGemmCache(const std::string& path) {
+        std::ifstream in(path);
+        if (!in) {
+            return false;
+        }
+        std::vector<std::pair<ShapeKey, GemmPlan>> entries;
+        bool sawCores = false;
+        std::string line;
+        while (std::getline(in, line)) {
+            if (line.empty() || line[0] == '#') {
+                continue;
+            }
+            std::istringstream fields(line);
+            if (!sawCores) {
+                // Plans are only meaningful on the core count they were timed on
+                std::string tag;
+                size_t cores = 0;
+                if (!(fields >> tag >> cores) || tag != "cores" || cores != hardwareConcurrency()) {
+                    return false;
+                }
+                sawCores = true;
+                continue;
+            }
+            ShapeKey key{};
+            GemmPlan plan;
+            std::string kernel, axis;
+            if (!(fields >> key.M >> key.N >> key.K >> kernel >> axis
+                >> plan.tasks >> plan.blockK >> plan.blockN >> plan.seconds)
+                || !parseKernel(kernel, plan.kernel) || (axis != "Rows" && axis != "Columns")) {
+                return false;
+            }
+            plan.axis = (axis == "Rows") ? GemmAxis::Rows : GemmAxis::Columns;
+            entries.emplace_back(key, plan);
+        }
+        if (!sawCores) {
+            return false;
+        }
+        for (const auto& entry : entries) {
+            store(entry.first, entry.second);
+        }
+        return true;
+    }
+
+    bool saveGemmCache(const std::string& path) {
+        const std::string tmp = path + ".tmp";
+        {
+            std::ofstream out(tmp);
+            if (!out) {
+                return false;
+            }
+            out << "# GEMM tuning cache: M N K kernel axis tasks blockK blockN seconds\n";
+            out << "cores " << hardwareConcurrency() << "\n";
+            out.precision(6);
+            std::shared_lock<std::shared_mutex> lock(cacheMutex());
+            for (const auto& entry : cache()) {
+                const ShapeKey& key = entry.first;
+                const GemmPlan& plan = entry.second;
+                out << key.M << ' ' << key.N << ' ' << key.K << ' '
+                    << kernelName(plan.kernel) << ' '
+                    << (plan.axis == GemmAxis::Rows ? "Rows" : "Columns") << ' '
+                    << plan.tasks << ' ' << plan.blockK << ' ' << plan.blockN << ' '
+                    << plan.seconds << "\n";
+            }
+            if (!out.flush()) {
+                return false;
+            }
+        }
+        // Readers never see a half-written cache
+#if defined(_WIN32)
+        std::remove(path.c_str());   // rename does not replace on Windows
+#endif
+        return std::rename(tmp.c_str(), path.c_str()) == 0;
+    }
+
+    void clearGemmCache() {
+        std::unique_lock<std::shared_mutex> lock(cacheMutex());
+        cache().clear();
+        g_cacheSize.store(0, std::memory_order_release);
+    }
+
+    size_t gemmCacheSize() {
+        return g_cacheSize.load(std::memory_order_acquire);
+    }
+
+}  // namespace nn
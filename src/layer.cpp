@@ -0,0 +1,438 @@
+#include "../include/layer.h"
+#include "../include/random.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+namespace nn {
+
+    namespace {
+
+        // dst (cols x rows) = src (rows x cols)^T
+        void transposeInto(const double* src, size_t rows, size_t cols, std::vector<double>& dst) {
+            if (dst.size() < rows * cols) {
+                dst.resize(rows * cols);
+            }
+            for (size_t r = 0; r < rows; ++r) {
+                for (size_t c = 0; c < cols; ++c) {
+                    dst[c * rows + r] = src[r * cols + c];
+                }
+            }
+        }
+
+    }  // namespace
+
+    // -------------------- DenseLayer --------------------
+
+    DenseLayer::DenseLayer(size_t inDim, size_t outDim, ActivationType activation)
+        : DenseLayer(inDim, outDim, activation, mixSeed(globalSeed(), nextTensorId())) {}
+
+    DenseLayer::DenseLayer(size_t inDim, size_t outDim, ActivationType activation, uint64_t seed)
+        : m_activation(activation),
+        m_weights(inDim, outDim),
+        m_biases(1, outDim),
+        m_gradW(inDim, outDim),
+        m_gradB(1, outDim) {
+        initializeWeights(m_weights, defaultInitFor(activation), seed, 0);
+        // Same small positive ReLU bias as NeuralNetwork::initializeParameters
+        if (activation == ActivationType::ReLU) {
+            std::fill(m_biases.data().begin(), m_biases.data().end(), 0.01);
+        }
+    }
+
+    size_t DenseLayer::outputWidth(const std::vector<size_t>& inputWidths) const {
+        assert(inputWidths.size() == 1 && inputWidths[0] == m_weights.rows());
+        return m_weights.cols();
+    }
+
+    std::vector<size_t> DenseLayer::savedWidths(const std::vector<size_t>&) const {
+        return { m_weights.cols() };  // pre-activation net input
+    }
+
+    void DenseLayer::forward(const std::vector<const Matrix*>& inputs, Matrix& output,
+        const std::vector<Matrix*>& saved, bool) {
+        const Matrix& in = *inputs[0];
+        Matrix& net = *saved[0];
+        const size_t batch = in.rows();
+        const size_t inDim = m_weights.rows();
+        const size_t outDim = m_weights.cols();
+
+        // GEMM straight into the planned buffer, no temporaries
+        Matrix::multiplyStridedBatched(in.data().data(), 0, m_weights.data().data(), 0,
+            net.data().data(), 0, batch, outDim, inDim, 1);
+
+        const double* b = m_biases.data().data();
+        double* z = net.data().data();
+        double* y = output.data().data();
+        withActivationTraits(m_activation, m_precision, [&](auto traits) {
+            using Traits = decltype(traits);
+            for (size_t r = 0; r < batch; ++r) {
+                for (size_t j = 0; j < outDim; ++j) {
+                    size_t e = r * outDim + j;
+                    z[e] += b[j];
+                    y[e] = Traits::forward(z[e]);
+                }
+            }
+        });
+    }
+
+    void DenseLayer::backward(const std::vector<const Matrix*>& inputs,
+        const std::vector<Matrix*>& saved, Matrix& gradOutput,
+        const std::vector<Matrix*>& gradInputs) {
+        const Matrix& in = *inputs[0];
+        const size_t batch = in.rows();
+        const size_t inDim = m_weights.rows();
+        const size_t outDim = m_weights.cols();
+
+        // gradOutput: dL/dOut -> dL/dNet, in place
+        double* delta = gradOutput.data().data();
+        const double* net = saved[0]->data().data();
+        withActivationTraits(m_activation, m_precision, [&](auto traits) {
+            using Traits = decltype(traits);
+            for (size_t e = 0; e < batch * outDim; ++e) {
+                delta[e] *= Traits::derivative(net[e]);
+            }
+        });
+
+        // dW = in^T * delta, one (inDim x batch) * (batch x outDim) GEMM
+        const double* x = in.data().data();
+        transposeInto(x, batch, inDim, m_transposed);
+        Matrix::multiplyStridedBatched(m_transposed.data(), 0, delta, 0,
+            m_gradW.data().data(), 0, inDim, outDim, batch, 1);
+
+        // dB = column sums of delta
+        double* dB = m_gradB.data().data();
+        std::fill(m_gradB.data().begin(), m_gradB.data().end(), 0.0);
+        for (size_t r = 0; r < batch; ++r) {
+            const double* dr = delta + r * outDim;
+            for (size_t j = 0; j < outDim; ++j) {
+                dB[j] += dr[j];
+            }
+        }
+
+        // dIn += delta * W^T
+        if (gradInputs[0]) {
+            transposeInto(m_weights.data().data(), inDim, outDim, m_transposed);
+            if (m_product.size() < batch * inDim) {
+                m_product.resize(batch * inDim);
+            }
+            Matrix::multiplyStridedBatched(delta, 0, m_transposed.data(), 0,
+                m_product.data(), 0, batch, inDim, outDim, 1);
+            double* g = gradInputs[0]->data().data();
+            for (size_t e = 0; e < batch * inDim; ++e) {
+                g[e] += m_product[e];
+            }
+        }
+    }
+
+    std::vector<std::pair<Matrix*, Matrix*>> DenseLayer::parameters() {
+        return { { &m_weights, &m_gradW }, { &m_biases, &m_gradB } };
+    }
+
+    // -------------------- DropoutLayer --------------------
+
+    DropoutLayer::DropoutLayer(double rate)
+        : DropoutLayer(rate, mixSeed(globalSeed(), nextTensorId())) {}
+
+    DropoutLayer::DropoutLayer(double rate, uint64_t seed)
+        : m_rate(rate), m_seed(seed) {
+        assert(rate >= 0.0 && rate < 1.0);
+    }
+
+    size_t DropoutLayer::outputWidth(const std::vector<size_t>& inputWidths) const {
+        assert(inputWidths.size() == 1);
+        return inputWidths[0];
+    }
+
+    std::vector<size_t> DropoutLayer::savedWidths(const std::vector<size_t>& inputWidths) const {
+        return { inputWidths[0] };  // scaled keep mask
+    }
+
+    void DropoutLayer::forward(const std::vector<const Matrix*>& inputs, Matrix& output,
+        const std::vector<Matrix*>& saved, bool training) {
+        const Matrix::Storage& x = inputs[0]->data();
+        Matrix::Storage& y = output.data();
+        if (!training) {
+            y = x;
+            return;
+        }
+
+        Matrix& mask = *saved[0];
+        fillUniform(mask, m_seed, m_step++, 0.0, 1.0);
+        const double scale = 1.0 / (1.0 - m_rate);
+        Matrix::Storage& m = mask.data();
+        for (size_t e = 0; e < x.size(); ++e) {
+            m[e] = (m[e] >= m_rate) ? scale : 0.0;
+            y[e] = x[e] * m[e];
+        }
+    }
+
+    void DropoutLayer::backward(const std::vector<const Matrix*>&,
+        const std::vector<Matrix*>& saved, Matrix& gradOutput,
+        const std::vector<Matrix*>& gradInputs) {
+        if (!gradInputs[0]) {
+            return;
+        }
+        const Matrix::Storage& m = saved[0]->data();
+        const Matrix::Storage& g = gradOutput.data();
+        Matrix::Storage& dx = gradInputs[0]->data();
+        for (size_t e = 0; e < g.size(); ++e) {
+            dx[e] += g[e] * m[e];
+        }
+    }
+
+    // -------------------- LayerNormLayer --------------------
+
+    LayerNormLayer::LayerNormLayer(size_t width, double epsilon)
+        : m_epsilon(epsilon),
+        m_gamma(1, width),
+        m_beta(1, width),
+        m_gradGamma(1, width),
+        m_gradBeta(1, width) {
+        std::fill(m_gamma.data().begin(), m_gamma.data().end(), 1.0);
+    }
+
+    size_t LayerNormLayer::outputWidth(const std::vector<size_t>& inputWidths) const {
+        assert(inputWidths.size() == 1 && inputWidths[0] == m_gamma.cols());
+        return inputWidths[0];
+    }
+
+    std::vector<size_t> LayerNormLayer::savedWidths(const std::vector<size_t>&) const {
+        return { 2 };  // per-row mean and 1/stddev
+    }
+
+    void LayerNormLayer::forward(const std::vector<const Matrix*>& inputs, Matrix& output,
+        const std::vector<Matrix*>& saved, bool) {
+        const Matrix& in = *inputs[0];
+        const size_t batch = in.rows();
+        const size_t width = in.cols();
+        const double* gamma = m_gamma.data().data();
+        const double* beta = m_beta.data().data();
+        Matrix& stats = *saved[0];
+
+        for (size_t r = 0; r < batch; ++r) {
+            const double* x = in.data().data() + r * width;
+            double* y = output.data().data() + r * width;
+
+            // Single Welford pass for mean and variance, then one sweep that
+            // normalizes, scales and shifts
+            double mean = 0.0;
+            double m2 = 0.0;
+            for (size_t j = 0; j < width; ++j) {
+                double d = x[j] - mean;
+                mean += d / static_cast<double>(j + 1);
+                m2 += d * (x[j] - mean);
+            }
+            double rstd = 1.0 / std::sqrt(m2 / static_cast<double>(width) + m_epsilon);
+
+            for (size_t j = 0; j < width; ++j) {
+                y[j] = (x[j] - mean) * rstd * gamma[j] + beta[j];
+            }
+            stats(r, 0) = mean;
+            stats(r, 1) = rstd;
+        }
+    }
+
+    void LayerNormLayer::backward(const std::vector<const Matrix*>& inputs,
+        const std::vector<Matrix*>& saved, Matrix& gradOutput,
+        const std::vector<Matrix*>& gradInputs) {
+        const Matrix& in = *inputs[0];
+        const Matrix& stats = *saved[0];
+        const size_t batch = in.rows();
+        const size_t width = in.cols();
+        const double* gamma = m_gamma.data().data();
+        double* dGamma = m_gradGamma.data().data();
+        double* dBeta = m_gradBeta.data().data();
+        std::fill(m_gradGamma.data().begin(), m_gradGamma.data().end(), 0.0);
+        std::fill(m_gradBeta.data().begin(), m_gradBeta.data().end(), 0.0);
+
+        for (size_t r = 0; r < batch; ++r) {
+            const double* x = in.data().data() + r * width;
+            const double* g = gradOutput.data().data() + r * width;
+            const double mean = stats(r, 0);
+            const double rstd = stats(r, 1);
+
+            // dxhat = g * gamma; dx = rstd * (dxhat - mean(dxhat) - xhat * mean(dxhat * xhat)).
+            // Both reductions and the parameter gradients share one pass.
+            double sumD = 0.0;
+            double sumDX = 0.0;
+            for (size_t j = 0; j < width; ++j) {
+                double xhat = (x[j] - mean) * rstd;
+                double dxhat = g[j] * gamma[j];
+                dGamma[j] += g[j] * xhat;
+                dBeta[j] += g[j];
+                sumD += dxhat;
+                sumDX += dxhat * xhat;
+            }
+            if (!gradInputs[0]) {
+                continue;
+            }
+            const double invWidth = 1.0 / static_cast<double>(width);
+            double* dx = gradInputs[0]->data().data() + r * width;
+            for (size_t j = 0; j < width; ++j) {
+                double xhat = (x[j] - mean) * rstd;
+                double dxhat = g[j] * gamma[j];
+                dx[j] += rstd * (dxhat - sumD * invWidth - xhat * sumDX * invWidth);
+            }
+        }
+    }
+
+    std::vector<std::pair<Matrix*, Matrix*>> LayerNormLayer::parameters() {
+        return { { &m_gamma, &m_gradGamma }, { &m_beta, &m_gradBeta } };
+    }
+
+    // -------------------- BatchNormLayer --------------------
+
+    BatchNormLayer::BatchNormLayer(size_t width, double momentum, double epsilon)
+        : m_momentum(momentum),
+        m_epsilon(epsilon),
+        m_gamma(1, width),
+        m_beta(1, width),
+        m_gradGamma(1, width),
+        m_gradBeta(1, width),
+        m_runningMean(1, width),
+        m_runningVar(1, width),
+        m_batchMean(1, width),
+        m_batchRstd(1, width) {
+        std::fill(m_gamma.data().begin(), m_gamma.data().end(), 1.0);
+        std::fill(m_runningVar.data().begin(), m_runningVar.data().end(), 1.0);
+    }
+
+    size_t BatchNormLayer::outputWidth(const std::vector<size_t>& inputWidths) const {
+        assert(inputWidths.size() == 1 && inputWidths[0] == m_gamma.cols());
+        return inputWidths[0];
+    }
+
+    void BatchNormLayer::forward(const std::vector<const Matrix*>& inputs, Matrix& output,
+        const std::vector<Matrix*>&, bool training) {
+        const Matrix& in = *inputs[0];
+        const size_t batch = in.rows();
+        const size_t width = in.cols();
+        const double* gamma = m_gamma.data().data();
+        const double* beta = m_beta.data().data();
+        double* mean = m_batchMean.data().data();
+        double* rstd = m_batchRstd.data().data();
+
+        if (training) {
+            // Welford over rows, all features at once (rstd holds M2 until the end)
+            std::fill(mean, mean + width, 0.0);
+            std::fill(rstd, rstd + width, 0.0);
+            for (size_t r = 0; r < batch; ++r) {
+                const double* x = in.data().data() + r * width;
+                const double inv = 1.0 / static_cast<double>(r + 1);
+                for (size_t j = 0; j < width; ++j) {
+                    double d = x[j] - mean[j];
+                    mean[j] += d * inv;
+                    rstd[j] += d * (x[j] - mean[j]);
+                }
+            }
+            double* runMean = m_runningMean.data().data();
+            double* runVar = m_runningVar.data().data();
+            const double n = static_cast<double>(batch);
+            for (size_t j = 0; j < width; ++j) {
+                double var = rstd[j] / n;
+                double unbiased = (batch > 1) ? rstd[j] / (n - 1.0) : var;
+                runMean[j] += m_momentum * (mean[j] - runMean[j]);
+                runVar[j] += m_momentum * (unbiased - runVar[j]);
+                rstd[j] = 1.0 / std::sqrt(var + m_epsilon);
+            }
+        }
+        else {
+            const double* runMean = m_runningMean.data().data();
+            const double* runVar = m_runningVar.data().data();
+            for (size_t j = 0; j < width; ++j) {
+                mean[j] = runMean[j];
+                rstd[j] = 1.0 / std::sqrt(runVar[j] + m_epsilon);
+            }
+        }
+
+        // Fold normalization, scale and shift into y = x * a + c
+        for (size_t r = 0; r < batch; ++r) {
+            const double* x = in.data().data() + r * width;
+            double* y = output.data().data() + r * width;
+            for (size_t j = 0; j < width; ++j) {
+                double a = rstd[j] * gamma[j];
+                y[j] = x[j] * a + (beta[j] - mean[j] * a);
+            }
+        }
+    }
+
+    void BatchNormLayer::backward(const std::vector<const Matrix*>& inputs,
+        const std::vector<Matrix*>&, Matrix& gradOutput,
+        const std::vector<Matrix*>& gradInputs) {
+        const Matrix& in = *inputs[0];
+        const size_t batch = in.rows();
+        const size_t width = in.cols();
+        const double* gamma = m_gamma.data().data();
+        const double* mean = m_batchMean.data().data();
+        const double* rstd = m_batchRstd.data().data();
+        double* sumG = m_gradBeta.data().data();      // dBeta = sum g
+        double* sumGX = m_gradGamma.data().data();    // dGamma = sum g * xhat
+        std::fill(sumG, sumG + width, 0.0);
+        std::fill(sumGX, sumGX + width, 0.0);
+
+        // Pass 1: both per-feature reductions, which are also the parameter gradients
+        for (size_t r = 0; r < batch; ++r) {
+            const double* x = in.data().data() + r * width;
+            const double* g = gradOutput.data().data() + r * width;
+            for (size_t j = 0; j < width; ++j) {
+                sumG[j] += g[j];
+                sumGX[j] += g[j] * (x[j] - mean[j]) * rstd[j];
+            }
+        }
+        if (!gradInputs[0]) {
+            return;
+        }
+
+        // Pass 2: dx = gamma * rstd / N * (N * g - sum g - xhat * sum(g * xhat))
+        const double n = static_cast<double>(batch);
+        for (size_t r = 0; r < batch; ++r) {
+            const double* x = in.data().data() + r * width;
+            const double* g = gradOutput.data().data() + r * width;
+            double* dx = gradInputs[0]->data().data() + r * width;
+            for (size_t j = 0; j < width; ++j) {
+                double xhat = (x[j] - mean[j]) * rstd[j];
+                dx[j] += gamma[j] * rstd[j] / n * (n * g[j] - sumG[j] - xhat * sumGX[j]);
+            }
+        }
+    }
+
+    std::vector<std::pair<Matrix*, Matrix*>> BatchNormLayer::parameters() {
+        return { { &m_gamma, &m_gradGamma }, { &m_beta, &m_gradBeta } };
+    }
+
+    // -------------------- ResidualLayer --------------------
+
+    size_t ResidualLayer::outputWidth(const std::vector<size_t>& inputWidths) const {
+        assert(inputWidths.size() == 2 && inputWidths[0] == inputWidths[1] &&
+            "Residual inputs must have the same width");
+        return inputWidths[0];
+    }
+
+    void ResidualLayer::forward(const std::vector<const Matrix*>& inputs, Matrix& output,
+        const std::vector<Matrix*>&, bool) {
+        const Matrix::Storage& a = inputs[0]->data();
+        const Matrix::Storage& b = inputs[1]->data();
+        Matrix::Storage& y = output.data();
+        for (size_t e = 0; e < y.size(); ++e) {
+            y[e] = a[e] + b[e];
+        }
+    }
+
+    void ResidualLayer::backward(const std::vector<const Matrix*>&,
+        const std::vector<Matrix*>&, Matrix& gradOutput,
+        const std::vector<Matrix*>& gradInputs) {
+        const Matrix::Storage& g = gradOutput.data();
+        for (Matrix* gradIn : gradInputs) {
+            if (!gradIn) {
+                continue;
+            }
+            Matrix::Storage& dx = gradIn->data();
+            for (size_t e = 0; e < g.size(); ++e) {
+                dx[e] += g[e];
+            }
+        }
+    }
+
+}  // namespace nn
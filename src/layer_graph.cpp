@@ -0,0 +1,278 @@
+#include "../include/layer_graph.h"
+#include "../include/execution_backend.h"
+
+#include <algorithm>
+#include <cassert>
+#include <numeric>
+
+namespace nn {
+
+    MemoryPlan planMemory(const std::vector<TensorLifetime>& tensors) {
+        std::vector<size_t> order(tensors.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+            return tensors[a].elements > tensors[b].elements;
+        });
+
+        MemoryPlan plan;
+        plan.bufferOf.assign(tensors.size(), 0);
+        std::vector<std::vector<size_t>> tenants;
+
+        for (size_t t : order) {
+            const TensorLifetime& cur = tensors[t];
+            size_t chosen = tenants.size();
+            for (size_t b = 0; b < tenants.size() && chosen == tenants.size(); ++b) {
+                bool overlaps = std::any_of(tenants[b].begin(), tenants[b].end(), [&](size_t u) {
+                    return !(cur.lastUse < tensors[u].firstUse || tensors[u].lastUse < cur.firstUse);
+                });
+                if (!overlaps) {
+                    chosen = b;
+                }
+            }
+            if (chosen == tenants.size()) {
+                // Visiting largest first means the first tenant sizes the buffer
+                tenants.emplace_back();
+                plan.bufferElements.push_back(cur.elements);
+            }
+            tenants[chosen].push_back(t);
+            plan.bufferOf[t] = chosen;
+        }
+        return plan;
+    }
+
+    LayerGraph::LayerGraph(size_t inputWidth,
+        LossType lossType,
+        OptimizerType optType,
+        double learningRate,
+        double momentum)
+        : m_lossType(lossType),
+        m_optType(optType),
+        m_learningRate(learningRate),
+        m_momentum(momentum) {
+        m_nodes.push_back({ nullptr, {}, inputWidth, {} });
+    }
+
+    size_t LayerGraph::add(std::unique_ptr<Layer> layer, const std::vector<size_t>& inputs) {
+        assert(layer && inputs.size() == layer->numInputs());
+        std::vector<size_t> widths;
+        for (size_t in : inputs) {
+            assert(in < m_nodes.size() && "Layers may only consume earlier nodes");
+            widths.push_back(m_nodes[in].width);
+        }
+
+        for (const auto& param : layer->parameters()) {
+            m_parameters.push_back(param);
+            m_optimizers.push_back(createOptimizer(m_optType, m_learningRate, m_momentum));
+        }
+
+        size_t width = layer->outputWidth(widths);
+        std::vector<size_t> saved = layer->savedWidths(widths);
+        m_nodes.push_back({ std::move(layer), inputs, width, std::move(saved) });
+        m_batchSize = 0;  // plan is stale
+        return m_nodes.size() - 1;
+    }
+
+    size_t LayerGraph::add(std::unique_ptr<Layer> layer) {
+        return add(std::move(layer), std::vector<size_t>{ m_nodes.size() - 1 });
+    }
+
+    size_t LayerGraph::outputWidth(size_t node) const {
+        return m_nodes[node].width;
+    }
+
+    Layer& LayerGraph::layer(size_t node) {
+        assert(node > 0 && node < m_nodes.size());
+        return *m_nodes[node].layer;
+    }
+
+    void LayerGraph::compile(size_t batchSize, bool training) {
+        const size_t N = m_nodes.size() - 1;
+        assert(N >= 1 && batchSize > 0);
+
+        std::vector<size_t> lastConsumer(N + 1, 0);
+        for (size_t i = 1; i <= N; ++i) {
+            for (size_t in : m_nodes[i].inputs) {
+                lastConsumer[in] = std::max(lastConsumer[in], i);
+            }
+        }
+
+        // Timeline: forward of node i at step i, loss at N + 1, then the
+        // backward of node i at 2N + 2 - i (reverse order).
+        auto backwardStep = [N](size_t i) { return 2 * N + 2 - i; };
+
+        std::vector<TensorLifetime> tensors;
+        std::vector<size_t> actTensor(N + 1);
+        std::vector<std::vector<size_t>> savedTensors(N + 1);
+        std::vector<size_t> gradTensor(N + 1, 0);
+
+        for (size_t i = 0; i <= N; ++i) {
+            const Node& node = m_nodes[i];
+            assert((i == N || lastConsumer[i] > 0) &&
+                "Every node except the output must feed another layer");
+
+            size_t last = i;
+            for (size_t c = i + 1; c <= N; ++c) {
+                const std::vector<size_t>& ins = m_nodes[c].inputs;
+                if (std::find(ins.begin(), ins.end(), i) == ins.end()) {
+                    continue;
+                }
+                last = std::max(last, c);
+                if (training && m_nodes[c].layer->needsInputsForBackward()) {
+                    last = std::max(last, backwardStep(c));
+                }
+            }
+            if (i == N && training) {
+                last = N + 1;  // read by the loss
+            }
+            actTensor[i] = tensors.size();
+            tensors.push_back({ batchSize * node.width, i, last });
+
+            for (size_t w : node.savedWidths) {
+                savedTensors[i].push_back(tensors.size());
+                tensors.push_back({ batchSize * w, i, training ? backwardStep(i) : i });
+            }
+
+            if (training && i > 0) {
+                // Born when the loss or the first (latest) consumer's backward
+                // starts accumulating into it
+                size_t first = (i == N) ? N + 1 : backwardStep(lastConsumer[i]);
+                gradTensor[i] = tensors.size();
+                tensors.push_back({ batchSize * node.width, first, backwardStep(i) });
+            }
+        }
+
+        MemoryPlan plan = planMemory(tensors);
+        m_buffers.clear();
+        m_buffers.reserve(plan.bufferElements.size());
+        m_plannedBytes = 0;
+        for (size_t elements : plan.bufferElements) {
+            m_buffers.emplace_back(elements, 1);
+            placeMatrix(m_buffers.back(), TensorRole::Activations);
+            m_plannedBytes += elements * sizeof(double);
+        }
+        m_unplannedBytes = 0;
+        for (const TensorLifetime& t : tensors) {
+            m_unplannedBytes += t.elements * sizeof(double);
+        }
+        auto bufferFor = [&](size_t tensor) { return &m_buffers[plan.bufferOf[tensor]]; };
+
+        m_steps.clear();
+        for (size_t i = 1; i <= N; ++i) {
+            const Node& node = m_nodes[i];
+            Step step;
+            step.layer = node.layer.get();
+            step.outputWidth = node.width;
+            step.savedWidths = node.savedWidths;
+            step.output = bufferFor(actTensor[i]);
+            for (size_t in : node.inputs) {
+                step.inputs.push_back(bufferFor(actTensor[in]));
+            }
+            for (size_t t : savedTensors[i]) {
+                step.saved.push_back(bufferFor(t));
+            }
+            step.gradOutput = training ? bufferFor(gradTensor[i]) : nullptr;
+            for (size_t in : node.inputs) {
+                Matrix* grad = (training && in > 0) ? bufferFor(gradTensor[in]) : nullptr;
+                step.gradInputs.push_back(grad);
+                bool firstWriter = grad && lastConsumer[in] == i;
+                bool listed = std::any_of(step.zeroGrads.begin(), step.zeroGrads.end(),
+                    [grad](const std::pair<Matrix*, size_t>& z) { return z.first == grad; });
+                if (firstWriter && !listed) {
+                    step.zeroGrads.emplace_back(grad, m_nodes[in].width);
+                }
+            }
+            m_steps.push_back(std::move(step));
+        }
+
+        m_inputBuffer = bufferFor(actTensor[0]);
+        m_outputGrad = training ? bufferFor(gradTensor[N]) : nullptr;
+        m_batchSize = batchSize;
+        m_training = training;
+    }
+
+    const Matrix& LayerGraph::forward(const Matrix& input) {
+        ensureCompiled(input.rows(), m_training);
+        runForward(input, false);
+        return *m_steps.back().output;
+    }
+
+    double LayerGraph::trainBatch(const Matrix& input, const Matrix& target) {
+        ensureCompiled(input.rows(), true);
+        runForward(input, true);
+        double lossVal = computeOutputGradient(target);
+
+        for (size_t s = m_steps.size(); s-- > 0;) {
+            Step& step = m_steps[s];
+            for (auto& [grad, width] : step.zeroGrads) {
+                grad->resize(m_batchSize, width);
+                std::fill(grad->data().begin(), grad->data().end(), 0.0);
+            }
+            step.layer->backward(step.inputs, step.saved, *step.gradOutput, step.gradInputs);
+        }
+
+        for (size_t p = 0; p < m_parameters.size(); ++p) {
+            m_optimizers[p]->update(*m_parameters[p].first, *m_parameters[p].second);
+        }
+        return lossVal;
+    }
+
+    size_t LayerGraph::plannedBytes() const { return m_plannedBytes; }
+
+    size_t LayerGraph::unplannedBytes() const { return m_unplannedBytes; }
+
+    size_t LayerGraph::numBuffers() const { return m_buffers.size(); }
+
+    void LayerGraph::setLearningRate(double lr) {
+        m_learningRate = lr;
+        for (auto& opt : m_optimizers) {
+            opt->setLearningRate(lr);
+        }
+    }
+
+    double LayerGraph::learningRate() const { return m_learningRate; }
+
+    void LayerGraph::ensureCompiled(size_t batchSize, bool training) {
+        if (batchSize != m_batchSize || (training && !m_training)) {
+            compile(batchSize, training || m_training);
+        }
+    }
+
+    void LayerGraph::runForward(const Matrix& input, bool training) {
+        assert(input.cols() == m_nodes[0].width);
+        m_inputBuffer->resize(m_batchSize, input.cols());
+        std::copy(input.data().begin(), input.data().end(), m_inputBuffer->data().begin());
+
+        for (Step& step : m_steps) {
+            step.output->resize(m_batchSize, step.outputWidth);
+            for (size_t k = 0; k < step.saved.size(); ++k) {
+                step.saved[k]->resize(m_batchSize, step.savedWidths[k]);
+            }
+            step.layer->forward(step.inputs, *step.output, step.saved, training);
+        }
+    }
+
+    double LayerGraph::computeOutputGradient(const Matrix& target) {
+        const Matrix& pred = *m_steps.back().output;
+        assert(target.rows() == pred.rows() && target.cols() == pred.cols());
+        m_outputGrad->resize(pred.rows(), pred.cols());
+
+        const double invBatch = 1.0 / static_cast<double>(pred.rows());
+        const Matrix::Storage& p = pred.data();
+        const Matrix::Storage& t = target.data();
+        Matrix::Storage& g = m_outputGrad->data();
+        auto compute = [&](auto traits) {
+            using Traits = decltype(traits);
+            double sum = 0.0;
+            for (size_t e = 0; e < p.size(); ++e) {
+                sum += Traits::value(p[e], t[e]);
+                g[e] = Traits::gradient(p[e], t[e]) * invBatch;
+            }
+            return sum * invBatch;
+        };
+        if (m_lossType == LossType::CrossEntropy) {
+            return compute(LossTraits<LossType::CrossEntropy>{});
+        }
+        return compute(LossTraits<LossType::MSE>{});
+    }
+
+}  // namespace nn
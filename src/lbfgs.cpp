@@ -0,0 +1,200 @@
+#include "../include/lbfgs.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+namespace nn {
+
+    namespace {
+
+        double dot(const std::vector<double>& a, const std::vector<double>& b) {
+            return std::inner_product(a.begin(), a.end(), b.begin(), 0.0);
+        }
+
+        /**
+         * @brief Minimizer of the quadratic through (a, fa) with slope da at a
+         *        and (b, fb), kept inside the middle 80% of [a, b].
+         */
+        double interpolate(double a, double fa, double da, double b, double fb) {
+            const double width = b - a;
+            const double denom = 2.0 * (fb - fa - da * width);
+            double t = (denom > 0.0) ? a - da * width * width / denom : 0.5 * (a + b);
+            const double lo = std::min(a, b) + 0.1 * std::abs(width);
+            const double hi = std::max(a, b) - 0.1 * std::abs(width);
+            return std::isfinite(t) ? std::min(std::max(t, lo), hi) : 0.5 * (a + b);
+        }
+
+    }  // namespace
+
+    Lbfgs::Lbfgs(const LbfgsConfig& config) : m_config(config) {}
+
+    void Lbfgs::reset() {
+        m_s.clear();
+        m_y.clear();
+        m_rho.clear();
+    }
+
+    void Lbfgs::direction(const std::vector<double>& grad, std::vector<double>& dir) const {
+        // Two-loop recursion: dir = -H grad
+        dir = grad;
+        const size_t m = m_s.size();
+        std::vector<double> alpha(m);
+        for (size_t k = m; k-- > 0;) {
+            alpha[k] = m_rho[k] * dot(m_s[k], dir);
+            for (size_t i = 0; i < dir.size(); ++i) {
+                dir[i] -= alpha[k] * m_y[k][i];
+            }
+        }
+        // H0 = gamma I scaled by the newest pair
+        const double gamma = m > 0 ? dot(m_s.back(), m_y.back()) / dot(m_y.back(), m_y.back()) : 1.0;
+        for (double& d : dir) {
+            d *= gamma;
+        }
+        for (size_t k = 0; k < m; ++k) {
+            const double beta = m_rho[k] * dot(m_y[k], dir);
+            for (size_t i = 0; i < dir.size(); ++i) {
+                dir[i] += (alpha[k] - beta) * m_s[k][i];
+            }
+        }
+        for (double& d : dir) {
+            d = -d;
+        }
+    }
+
+    double Lbfgs::step(std::vector<double>& x, const Objective& objective) {
+        std::vector<double> grad;
+        const double f0 = objective(x, grad);
+        ++m_evaluations;
+
+        std::vector<double> dir;
+        direction(grad, dir);
+        double d0 = dot(grad, dir);
+        if (!(d0 < 0.0)) {
+            // Not a descent direction: restart from steepest descent
+            reset();
+            dir = grad;
+            for (double& d : dir) {
+                d = -d;
+            }
+            d0 = dot(grad, dir);
+        }
+        if (d0 == 0.0) {
+            return f0;   // Stationary point
+        }
+
+        // Without curvature information, a first step of unit length
+        double alpha = m_s.empty() ? std::min(1.0, 1.0 / std::sqrt(-d0)) : 1.0;
+
+        std::vector<double> trial(x.size());
+        std::vector<double> trialGrad;
+        double trialF = f0;
+        auto evaluate = [&](double a, double& slope) {
+            for (size_t i = 0; i < x.size(); ++i) {
+                trial[i] = x[i] + a * dir[i];
+            }
+            trialF = objective(trial, trialGrad);
+            ++m_evaluations;
+            slope = dot(trialGrad, dir);
+            return trialF;
+        };
+        auto sufficient = [&](double a, double f) {
+            return f <= f0 + m_config.c1 * a * d0;
+        };
+        auto curvature = [&](double slope) {
+            return std::abs(slope) <= -m_config.c2 * d0;
+        };
+
+        // Strong Wolfe line search: bracket, then zoom (Nocedal & Wright 3.5-3.6)
+        bool accepted = false;
+        double prevAlpha = 0.0, prevF = f0, prevSlope = d0;
+        double lo = 0.0, loF = f0, loSlope = d0, hi = 0.0, hiF = f0;
+        bool zoom = false;
+        size_t evals = 0;
+        while (evals < m_config.maxLineSearchSteps) {
+            double slope;
+            double f = evaluate(alpha, slope);
+            ++evals;
+            if (!sufficient(alpha, f) || (evals > 1 && f >= prevF)) {
+                lo = prevAlpha; loF = prevF; loSlope = prevSlope;
+                hi = alpha; hiF = f;
+                zoom = true;
+                break;
+            }
+            if (curvature(slope)) {
+                accepted = true;
+                break;
+            }
+            if (slope >= 0.0) {
+                lo = alpha; loF = f; loSlope = slope;
+                hi = prevAlpha; hiF = prevF;
+                zoom = true;
+                break;
+            }
+            // Still descending: remember the step so running out of
+            // evaluations while expanding keeps it
+            lo = alpha; loF = f; loSlope = slope;
+            prevAlpha = alpha;
+            prevF = f;
+            prevSlope = slope;
+            alpha *= 2.0;
+        }
+        while (zoom && evals < m_config.maxLineSearchSteps) {
+            alpha = interpolate(lo, loF, loSlope, hi, hiF);
+            double slope;
+            double f = evaluate(alpha, slope);
+            ++evals;
+            if (!sufficient(alpha, f) || f >= loF) {
+                hi = alpha;
+                hiF = f;
+            }
+            else {
+                if (curvature(slope)) {
+                    accepted = true;
+                    break;
+                }
+                if (slope * (hi - lo) >= 0.0) {
+                    hi = lo;
+                    hiF = loF;
+                }
+                lo = alpha;
+                loF = f;
+                loSlope = slope;
+            }
+        }
+        if (!accepted) {
+            // Out of evaluations: settle for the best decrease found, if any
+            if (lo > 0.0 && loF < f0) {
+                double slope;
+                evaluate(lo, slope);
+                alpha = lo;
+            }
+            else {
+                reset();
+                return f0;
+            }
+        }
+
+        // Curvature pair; skipped if it would break positive definiteness
+        std::vector<double> s(x.size()), y(x.size());
+        for (size_t i = 0; i < x.size(); ++i) {
+            s[i] = trial[i] - x[i];
+            y[i] = trialGrad[i] - grad[i];
+        }
+        const double sy = dot(s, y);
+        if (sy > 1e-12 * std::sqrt(dot(s, s) * dot(y, y))) {
+            m_s.push_back(std::move(s));
+            m_y.push_back(std::move(y));
+            m_rho.push_back(1.0 / sy);
+            if (m_s.size() > m_config.historySize) {
+                m_s.pop_front();
+                m_y.pop_front();
+                m_rho.pop_front();
+            }
+        }
+        x.swap(trial);
+        ++m_iterations;
+        return trialF;
+    }
+
+}  // namespace nn
@@ -14,8 +14,7 @@ namespace nn {
             double sum = 0.0;
             size_t count = pred.rows() * pred.cols();
             for (size_t i = 0; i < count; ++i) {
-              double diff = pred.data()[i] - truth.data()[i];
-              sum += 0.5 * diff * diff;
+              sum += LossTraits<LossType::MSE>::value(pred.data()[i], truth.data()[i]);
             }
             return sum / static_cast<double>(pred.rows());
           },
@@ -24,7 +23,7 @@ namespace nn {
           Matrix grad(pred.rows(), pred.cols());
           size_t count = pred.rows() * pred.cols();
           for (size_t i = 0; i < count; ++i) {
-            grad.data()[i] = (pred.data()[i] - truth.data()[i])
+            grad.data()[i] = LossTraits<LossType::MSE>::gradient(pred.data()[i], truth.data()[i])
                              / static_cast<double>(pred.rows());
           }
           return grad;
@@ -38,12 +37,8 @@ namespace nn {
             double sum = 0.0;
             size_t count = pred.rows() * pred.cols();
             for (size_t i = 0; i < count; ++i) {
-              double p = pred.data()[i];
-              double t = truth.data()[i];
-              // clamp
-              if (p < 1e-12) p = 1e-12;
-              if (p > 1.0 - 1e-12) p = 1.0 - 1e-12;
-              sum += -(t * std::log(p) + (1.0 - t) * std::log(1.0 - p));
+              // prediction is clamped away from 0 and 1 inside the traits
+              sum += LossTraits<LossType::CrossEntropy>::value(pred.data()[i], truth.data()[i]);
             }
             return sum / static_cast<double>(pred.rows());
           },
@@ -52,11 +47,7 @@ namespace nn {
           Matrix grad(pred.rows(), pred.cols());
           size_t count = pred.rows() * pred.cols();
           for (size_t i = 0; i < count; ++i) {
-            double p = pred.data()[i];
-            double t = truth.data()[i];
-            if (p < 1e-12) p = 1e-12;
-            if (p > 1.0 - 1e-12) p = 1.0 - 1e-12;
-            grad.data()[i] = (p - t) / (p * (1.0 - p))
+            grad.data()[i] = LossTraits<LossType::CrossEntropy>::gradient(pred.data()[i], truth.data()[i])
                              / static_cast<double>(pred.rows());
           }
           return grad;
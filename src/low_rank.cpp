@@ -0,0 +1,237 @@
+#include "../include/low_rank.h"
+#include "../include/evaluation.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <numeric>
+
+namespace nn {
+
+    namespace {
+
+        const int kMaxSweeps = 60;
+
+        // Largest rank at which in -> r -> out costs fewer weights than in -> out
+        size_t maxUsefulRank(size_t in, size_t out) {
+            return (in * out - 1) / (in + out);
+        }
+
+        NeuralNetwork buildFactored(const NeuralNetwork& net,
+            const std::vector<SingularValueDecomposition>& svds,
+            const std::vector<size_t>& ranks) {
+            std::vector<size_t> sizes = { net.weights()[0].rows() };
+            std::vector<ActivationType> activations;
+            for (size_t i = 0; i < net.numLayers(); ++i) {
+                if (ranks[i] > 0) {
+                    sizes.push_back(ranks[i]);
+                    activations.push_back(ActivationType::Linear);
+                }
+                sizes.push_back(net.weights()[i].cols());
+                activations.push_back(net.activationType(i));
+            }
+
+            NeuralNetwork out(sizes, activations, net.lossType(), net.optimizerType(),
+                net.learningRate(), net.momentum());
+            size_t j = 0;
+            for (size_t i = 0; i < net.numLayers(); ++i) {
+                if (ranks[i] > 0) {
+                    const SingularValueDecomposition& svd = svds[i];
+                    Matrix& first = out.weights()[j];
+                    Matrix& second = out.weights()[j + 1];
+                    for (size_t k = 0; k < ranks[i]; ++k) {
+                        // Split sqrt(s) into both factors so neither dominates fine-tuning
+                        const double scale = std::sqrt(svd.singularValues[k]);
+                        for (size_t r = 0; r < first.rows(); ++r) {
+                            first(r, k) = svd.U(r, k) * scale;
+                        }
+                        for (size_t c = 0; c < second.cols(); ++c) {
+                            second(k, c) = svd.V(c, k) * scale;
+                        }
+                    }
+                    out.biases()[j] = Matrix(1, ranks[i]);
+                    ++j;
+                }
+                else {
+                    out.weights()[j] = net.weights()[i];
+                }
+                out.biases()[j] = net.biases()[i];
+                out.setActivationPrecision(j, net.activationPrecision(i));
+                ++j;
+            }
+            return out;
+        }
+
+        double energyKept(const std::vector<double>& s, size_t rank) {
+            double kept = 0.0, total = 0.0;
+            for (size_t k = 0; k < s.size(); ++k) {
+                total += s[k] * s[k];
+                if (k < rank) {
+                    kept += s[k] * s[k];
+                }
+            }
+            return total > 0.0 ? kept / total : 1.0;
+        }
+
+    }  // namespace
+
+    SingularValueDecomposition truncatedSvd(const Matrix& A, size_t rank) {
+        // Jacobi works on the columns of a tall matrix; factor A^T if A is wide
+        const bool wide = A.cols() > A.rows();
+        const size_t m = wide ? A.cols() : A.rows();
+        const size_t n = wide ? A.rows() : A.cols();
+
+        // Column-major working copies: g[j] is column j, v[j] column j of V
+        std::vector<std::vector<double>> g(n, std::vector<double>(m));
+        std::vector<std::vector<double>> v(n, std::vector<double>(n, 0.0));
+        for (size_t j = 0; j < n; ++j) {
+            for (size_t i = 0; i < m; ++i) {
+                g[j][i] = wide ? A(j, i) : A(i, j);
+            }
+            v[j][j] = 1.0;
+        }
+
+        // Rotate column pairs until all are mutually orthogonal; then
+        // G = A V = U S
+        const double eps = 1e-15;
+        for (int sweep = 0; sweep < kMaxSweeps; ++sweep) {
+            bool rotated = false;
+            for (size_t p = 0; p + 1 < n; ++p) {
+                for (size_t q = p + 1; q < n; ++q) {
+                    double alpha = 0.0, beta = 0.0, gamma = 0.0;
+                    for (size_t i = 0; i < m; ++i) {
+                        alpha += g[p][i] * g[p][i];
+                        beta += g[q][i] * g[q][i];
+                        gamma += g[p][i] * g[q][i];
+                    }
+                    if (std::abs(gamma) <= eps * std::sqrt(alpha * beta) || gamma == 0.0) {
+                        continue;
+                    }
+                    rotated = true;
+                    const double zeta = (beta - alpha) / (2.0 * gamma);
+                    const double t = (zeta >= 0.0 ? 1.0 : -1.0) / (std::abs(zeta) + std::sqrt(1.0 + zeta * zeta));
+                    const double c = 1.0 / std::sqrt(1.0 + t * t);
+                    const double s = c * t;
+                    for (size_t i = 0; i < m; ++i) {
+                        const double gp = g[p][i];
+                        g[p][i] = c * gp - s * g[q][i];
+                        g[q][i] = s * gp + c * g[q][i];
+                    }
+                    for (size_t i = 0; i < n; ++i) {
+                        const double vp = v[p][i];
+                        v[p][i] = c * vp - s * v[q][i];
+                        v[q][i] = s * vp + c * v[q][i];
+                    }
+                }
+            }
+            if (!rotated) {
+                break;
+            }
+        }
+
+        std::vector<double> sigma(n);
+        for (size_t j = 0; j < n; ++j) {
+            sigma[j] = std::sqrt(std::inner_product(g[j].begin(), g[j].end(), g[j].begin(), 0.0));
+        }
+        std::vector<size_t> order(n);
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return sigma[a] > sigma[b]; });
+
+        const size_t k = (rank == 0 || rank > n) ? n : rank;
+        Matrix left(m, k);
+        Matrix right(n, k);
+        SingularValueDecomposition svd;
+        svd.singularValues.resize(k);
+        for (size_t j = 0; j < k; ++j) {
+            const size_t src = order[j];
+            svd.singularValues[j] = sigma[src];
+            const double inv = sigma[src] > 0.0 ? 1.0 / sigma[src] : 0.0;
+            for (size_t i = 0; i < m; ++i) {
+                left(i, j) = g[src][i] * inv;
+            }
+            for (size_t i = 0; i < n; ++i) {
+                right(i, j) = v[src][i];
+            }
+        }
+        // A^T = L S R^T  =>  A = R S L^T
+        svd.U = wide ? std::move(right) : std::move(left);
+        svd.V = wide ? std::move(left) : std::move(right);
+        return svd;
+    }
+
+    size_t rankForEnergy(const std::vector<double>& singularValues, double energy) {
+        double total = 0.0;
+        for (double s : singularValues) {
+            total += s * s;
+        }
+        double kept = 0.0;
+        for (size_t k = 0; k < singularValues.size(); ++k) {
+            kept += singularValues[k] * singularValues[k];
+            if (kept >= energy * total) {
+                return k + 1;
+            }
+        }
+        return std::max<size_t>(singularValues.size(), 1);
+    }
+
+    NeuralNetwork factorizeLowRank(const NeuralNetwork& net, const LowRankConfig& config,
+        const Dataset* validation, std::vector<LowRankLayerReport>* report) {
+        const size_t numLayers = net.numLayers();
+        const bool useLoss = validation && config.maxLossIncrease > 0.0;
+        std::vector<SingularValueDecomposition> svds(numLayers);
+        std::vector<size_t> ranks(numLayers, 0);
+        double currentLoss = useLoss ? evaluate(net, *validation, { Metric::Loss }).loss : 0.0;
+
+        for (size_t i = 0; i < numLayers; ++i) {
+            const Matrix& w = net.weights()[i];
+            const size_t limit = maxUsefulRank(w.rows(), w.cols());
+            if (w.data().size() < config.minWeights || limit == 0) {
+                continue;
+            }
+            svds[i] = truncatedSvd(w);
+            if (!useLoss) {
+                size_t r = rankForEnergy(svds[i].singularValues, config.energy);
+                ranks[i] = r <= limit ? r : 0;
+                continue;
+            }
+
+            // Smallest rank within the loss budget, given the ranks already chosen
+            const double budget = currentLoss + config.maxLossIncrease;
+            size_t lo = 1, hi = std::min(limit, svds[i].singularValues.size());
+            ranks[i] = hi;
+            double hiLoss = evaluate(buildFactored(net, svds, ranks), *validation, { Metric::Loss }).loss;
+            if (hiLoss > budget) {
+                ranks[i] = 0;
+                continue;
+            }
+            double chosenLoss = hiLoss;
+            while (lo < hi) {
+                size_t mid = lo + (hi - lo) / 2;
+                ranks[i] = mid;
+                double loss = evaluate(buildFactored(net, svds, ranks), *validation, { Metric::Loss }).loss;
+                if (loss <= budget) {
+                    hi = mid;
+                    chosenLoss = loss;
+                }
+                else {
+                    lo = mid + 1;
+                }
+            }
+            ranks[i] = hi;
+            currentLoss = chosenLoss;
+        }
+
+        if (report) {
+            report->assign(numLayers, LowRankLayerReport());
+            for (size_t i = 0; i < numLayers; ++i) {
+                LowRankLayerReport& r = (*report)[i];
+                r.factored = ranks[i] > 0;
+                r.rank = r.factored ? ranks[i]
+                    : std::min(net.weights()[i].rows(), net.weights()[i].cols());
+                r.energyKept = r.factored ? energyKept(svds[i].singularValues, ranks[i]) : 1.0;
+            }
+        }
+        return buildFactored(net, svds, ranks);
+    }
+
+}  // namespace nn
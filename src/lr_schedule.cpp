@@ -0,0 +1,68 @@
+#include "../include/lr_schedule.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace nn {
+
+    StepDecaySchedule::StepDecaySchedule(size_t stepSize, double gamma)
+        : m_stepSize(std::max<size_t>(stepSize, 1)), m_gamma(gamma) {}
+
+    double StepDecaySchedule::rate(size_t epoch, double baseRate) {
+        return baseRate * std::pow(m_gamma, static_cast<double>(epoch / m_stepSize));
+    }
+
+    CosineSchedule::CosineSchedule(size_t totalEpochs, double minRate)
+        : m_totalEpochs(std::max<size_t>(totalEpochs, 1)), m_minRate(minRate) {}
+
+    double CosineSchedule::rate(size_t epoch, double baseRate) {
+        const double pi = 3.14159265358979323846;
+        double progress = static_cast<double>(std::min(epoch, m_totalEpochs))
+            / static_cast<double>(m_totalEpochs);
+        return m_minRate + 0.5 * (baseRate - m_minRate) * (1.0 + std::cos(pi * progress));
+    }
+
+    WarmupSchedule::WarmupSchedule(size_t warmupEpochs,
+        std::unique_ptr<LearningRateSchedule> after)
+        : m_warmupEpochs(warmupEpochs), m_after(std::move(after)) {}
+
+    double WarmupSchedule::rate(size_t epoch, double baseRate) {
+        if (epoch < m_warmupEpochs) {
+            return baseRate * static_cast<double>(epoch + 1)
+                / static_cast<double>(m_warmupEpochs);
+        }
+        return m_after ? m_after->rate(epoch - m_warmupEpochs, baseRate) : baseRate;
+    }
+
+    void WarmupSchedule::observe(double loss) {
+        if (m_after) {
+            m_after->observe(loss);
+        }
+    }
+
+    ReduceOnPlateauSchedule::ReduceOnPlateauSchedule(double factor,
+        size_t patience,
+        double minDelta,
+        double minRate)
+        : m_factor(factor), m_patience(patience), m_minDelta(minDelta),
+        m_minRate(minRate), m_scale(1.0),
+        m_best(std::numeric_limits<double>::infinity()), m_wait(0) {}
+
+    double ReduceOnPlateauSchedule::rate(size_t /*epoch*/, double baseRate) {
+        return std::max(m_minRate, baseRate * m_scale);
+    }
+
+    void ReduceOnPlateauSchedule::observe(double loss) {
+        if (loss < m_best - m_minDelta) {
+            m_best = loss;
+            m_wait = 0;
+            return;
+        }
+        if (++m_wait > m_patience) {
+            m_scale *= m_factor;
+            m_wait = 0;
+        }
+    }
+
+}  // namespace nn
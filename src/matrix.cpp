@@ -1,13 +1,34 @@
 #include "../include/matrix.h"
+#include "../include/execution_backend.h"
+#include "../include/gemm_autotuner.h"
+#include "../include/random.h"
 
 #include <algorithm>
 #include <cassert>
-#include <execution>
-#include <numeric>
-#include <random>
 
 namespace nn {
 
+    namespace {
+
+        // Multiply-adds per product below which one thread handles a whole
+        // product and the batch, not the matrix, is split across threads.
+        constexpr size_t kBatchParallelWorkThreshold = 64 * 64 * 64;
+
+        // Total multiply-adds below which a batched call stays on one thread.
+        constexpr size_t kSerialWorkThreshold = 16 * 16 * 16;
+
+        // Elements per task for element-wise loops.
+        constexpr size_t kElementGrain = 4096;
+
+        // Whole products on the calling thread (batched paths)
+        const GemmPlan kSerialPlan = [] {
+            GemmPlan plan;
+            plan.tasks = 1;
+            return plan;
+        }();
+
+    }  // namespace
+
     Matrix::Matrix(size_t rows, size_t cols, bool randomize)
         : m_rows(rows), m_cols(cols), m_data(rows* cols, 0.0) {
         if (randomize) {
@@ -32,45 +53,109 @@ namespace nn {
         assert(A.cols() == B.rows() && "Incompatible matrix dimensions!");
 
         Matrix C(A.rows(), B.cols(), false);
+        const size_t M = A.rows();
+        const size_t N = B.cols();
+        const size_t K = A.cols();
+        runGemm(gemmPlan(M, N, K), A.m_data.data(), B.m_data.data(), C.m_data.data(), M, N, K);
 
-        // Index range for all (i, j) in C
-        std::vector<size_t> indices(A.rows() * B.cols());
-        std::iota(indices.begin(), indices.end(), 0);
+        return C;
+    }
 
-        auto multiplyCell = [&](size_t idx) {
-            size_t i = idx / B.cols();
-            size_t j = idx % B.cols();
-            double sum = 0.0;
-            for (size_t k = 0; k < A.cols(); ++k) {
-                sum += A(i, k) * B(k, j);
-            }
-            return sum;
-            };
+    void Matrix::multiplyStridedBatched(const double* A, size_t strideA,
+        const double* B, size_t strideB,
+        double* C, size_t strideC,
+        size_t M, size_t N, size_t K,
+        size_t batchCount) {
+        const size_t work = M * N * K;
+        if (batchCount == 0 || M == 0 || N == 0) {
+            return;
+        }
 
-        std::transform(std::execution::par,
-            indices.begin(), indices.end(),
-            C.m_data.begin(),
-            multiplyCell);
+        if (work * batchCount < kSerialWorkThreshold) {
+            for (size_t b = 0; b < batchCount; ++b) {
+                runGemm(kSerialPlan, A + b * strideA, B + b * strideB, C + b * strideC, M, N, K);
+            }
+        }
+        else if (work < kBatchParallelWorkThreshold && batchCount > 1) {
+            // Many small products: whole batch entries per task
+            parallelFor(batchCount, std::max<size_t>(1, kSerialWorkThreshold / work),
+                [&](size_t begin, size_t end) {
+                    for (size_t b = begin; b < end; ++b) {
+                        runGemm(kSerialPlan, A + b * strideA, B + b * strideB, C + b * strideC, M, N, K);
+                    }
+                });
+        }
+        else {
+            // Few large products: each one split as its tuned plan says
+            const GemmPlan plan = gemmPlan(M, N, K);
+            for (size_t b = 0; b < batchCount; ++b) {
+                runGemm(plan, A + b * strideA, B + b * strideB, C + b * strideC, M, N, K);
+            }
+        }
+    }
 
+    Matrix Matrix::multiplyBatched(const Matrix& A, const Matrix& B, size_t batchCount) {
+        assert(batchCount > 0 && A.rows() % batchCount == 0 && "A must stack batchCount matrices");
+        const size_t M = A.rows() / batchCount;
+        const size_t K = A.cols();
+        const bool sharedB = (B.rows() == K);
+        assert((sharedB || B.rows() == batchCount * K) && "Incompatible matrix dimensions!");
+        const size_t N = B.cols();
+
+        Matrix C(batchCount * M, N, false);
+        multiplyStridedBatched(A.m_data.data(), M * K,
+            B.m_data.data(), sharedB ? 0 : K * N,
+            C.m_data.data(), M * N,
+            M, N, K, batchCount);
         return C;
     }
 
     Matrix Matrix::add(const Matrix& A, const Matrix& B) {
         assert(A.rows() == B.rows() && A.cols() == B.cols());
         Matrix C(A.rows(), A.cols());
-        std::transform(std::execution::par,
-            A.m_data.begin(), A.m_data.end(),
-            B.m_data.begin(),
-            C.m_data.begin(),
-            std::plus<double>());
+        parallelFor(A.m_data.size(), kElementGrain, [&](size_t begin, size_t end) {
+            for (size_t e = begin; e < end; ++e) {
+                C.m_data[e] = A.m_data[e] + B.m_data[e];
+            }
+        });
+        return C;
+    }
+
+    Matrix Matrix::addRowVector(const Matrix& A, const Matrix& row) {
+        assert(row.rows() == 1 && row.cols() == A.cols());
+        if (A.rows() == 1) {
+            return add(A, row);
+        }
+        Matrix C(A.rows(), A.cols());
+        for (size_t r = 0; r < A.m_rows; ++r) {
+            std::transform(A.m_data.begin() + r * A.m_cols,
+                A.m_data.begin() + (r + 1) * A.m_cols,
+                row.m_data.begin(),
+                C.m_data.begin() + r * A.m_cols,
+                std::plus<double>());
+        }
         return C;
     }
 
+    Matrix Matrix::columnSums(const Matrix& M) {
+        if (M.rows() == 1) {
+            return M;
+        }
+        Matrix S(1, M.m_cols);
+        for (size_t r = 0; r < M.m_rows; ++r) {
+            for (size_t c = 0; c < M.m_cols; ++c) {
+                S.m_data[c] += M(r, c);
+            }
+        }
+        return S;
+    }
+
     void Matrix::applyFunction(const std::function<double(double)>& func) {
-        std::transform(std::execution::par,
-            m_data.begin(), m_data.end(),
-            m_data.begin(),
-            func);
+        parallelFor(m_data.size(), kElementGrain, [&](size_t begin, size_t end) {
+            for (size_t e = begin; e < end; ++e) {
+                m_data[e] = func(m_data[e]);
+            }
+        });
     }
 
     Matrix Matrix::transpose(const Matrix& M) {
@@ -84,20 +169,24 @@ namespace nn {
         return T;
     }
 
-    std::vector<double>& Matrix::data() {
+    void Matrix::resize(size_t rows, size_t cols) {
+        m_rows = rows;
+        m_cols = cols;
+        m_data.resize(rows * cols);
+    }
+
+    Matrix::Storage& Matrix::data() {
         return m_data;
     }
 
-    const std::vector<double>& Matrix::data() const {
+    const Matrix::Storage& Matrix::data() const {
         return m_data;
     }
 
     void Matrix::randomInit() {
-        static std::mt19937 rng{ std::random_device{}() };
-        static std::uniform_real_distribution<double> dist(-1.0, 1.0);
-        for (auto& val : m_data) {
-            val = dist(rng);
-        }
+        // Counter-based: no shared generator state, so concurrent
+        // constructions are race-free and large fills run in parallel
+        fillUniform(*this, globalSeed(), nextTensorId(), -1.0, 1.0);
     }
 
 }  // namespace nn
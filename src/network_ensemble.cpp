@@ -0,0 +1,305 @@
+#include "../include/network_ensemble.h"
+#include "../include/execution_backend.h"
+#include "../include/random.h"
+
+#include <algorithm>
+#include <cassert>
+
+namespace nn {
+
+    namespace {
+
+        // Below this many multiply-adds per layer the whole ensemble step is
+        // cheaper than a parallelFor dispatch, so kernels stay on one thread.
+        constexpr size_t kParallelWorkThreshold = 1 << 15;
+
+        template <typename Func>
+        void forEachIndex(size_t count, bool parallel, Func func) {
+            if (!parallel) {
+                for (size_t i = 0; i < count; ++i) {
+                    func(i);
+                }
+                return;
+            }
+            parallelFor(count, 1, [&](size_t begin, size_t end) {
+                for (size_t i = begin; i < end; ++i) {
+                    func(i);
+                }
+            });
+        }
+
+        // grad = x * delta for weights; biases pass x = nullptr (grad = delta)
+        template <bool UseMomentum>
+        void updateLanes(double* w, double* v, const double* lr, double momentum,
+            const double* x, const double* delta, size_t numModels) {
+            for (size_t k = 0; k < numModels; ++k) {
+                double grad = x ? x[k] * delta[k] : delta[k];
+                if constexpr (UseMomentum) {
+                    v[k] = momentum * v[k] - lr[k] * grad;
+                    w[k] += v[k];
+                }
+                else {
+                    w[k] -= lr[k] * grad;
+                }
+            }
+        }
+
+    }  // namespace
+
+    NetworkEnsemble::NetworkEnsemble(const std::vector<size_t>& layerSizes,
+        const std::vector<ActivationType>& activations,
+        LossType lossType,
+        OptimizerType optType,
+        const std::vector<double>& learningRates,
+        double momentum)
+        : m_numModels(learningRates.size()),
+        m_layerSizes(layerSizes),
+        m_activationTypes(activations),
+        m_lossType(lossType),
+        m_optType(optType),
+        m_learningRates(learningRates),
+        m_momentum(momentum) {
+        assert(m_numModels > 0 && "Ensemble needs at least one model");
+        assert(layerSizes.size() >= 2 && "Must have at least input & output layer");
+        assert(layerSizes.size() - 1 == activations.size() &&
+            "Need one activation for each layer except input");
+        assert(optType != OptimizerType::LBFGS && "NetworkEnsemble has no L-BFGS path");
+
+        // Every lane is an independent draw from the same initializer
+        // NeuralNetwork uses, so models differ only by their samples
+        const uint64_t seed = mixSeed(globalSeed(), nextTensorId());
+        size_t numLayers = layerSizes.size() - 1;
+        for (size_t i = 0; i < numLayers; ++i) {
+            size_t inDim = layerSizes[i];
+            size_t outDim = layerSizes[i + 1];
+
+            m_weights.emplace_back(inDim * outDim, m_numModels);
+            initializeWeights(m_weights.back(), defaultInitFor(activations[i]),
+                inDim, outDim, seed, 2 * i);
+            m_biases.emplace_back(outDim, m_numModels);
+            if (activations[i] == ActivationType::ReLU) {
+                std::fill(m_biases.back().data().begin(), m_biases.back().data().end(), 0.01);
+            }
+            m_velocityW.emplace_back(inDim * outDim, m_numModels);
+            m_velocityB.emplace_back(outDim, m_numModels);
+            m_layerNetInputs.emplace_back(outDim, m_numModels);
+            m_layerOutputs.emplace_back(outDim, m_numModels);
+            m_deltas.emplace_back(outDim, m_numModels);
+        }
+        m_input = Matrix(layerSizes[0], m_numModels);
+
+        m_sampleLosses.assign(m_numModels, 0.0);
+        m_totalLosses.assign(m_numModels, 0.0);
+    }
+
+    NetworkEnsemble::NetworkEnsemble(size_t numModels,
+        const std::vector<size_t>& layerSizes,
+        const std::vector<ActivationType>& activations,
+        LossType lossType,
+        OptimizerType optType,
+        double learningRate,
+        double momentum)
+        : NetworkEnsemble(layerSizes, activations, lossType, optType,
+            std::vector<double>(numModels, learningRate), momentum) {}
+
+    size_t NetworkEnsemble::size() const { return m_numModels; }
+
+    Matrix NetworkEnsemble::forward(const Matrix& input) {
+        loadInput(input);
+        for (size_t i = 0; i < m_weights.size(); ++i) {
+            forwardLayer(i);
+        }
+        return Matrix::transpose(m_layerOutputs.back());
+    }
+
+    const std::vector<double>& NetworkEnsemble::trainSample(const Matrix& input, const Matrix& target) {
+        loadInput(input);
+        for (size_t i = 0; i < m_weights.size(); ++i) {
+            forwardLayer(i);
+        }
+
+        computeOutputDelta(target);
+
+        for (size_t i = m_weights.size(); i-- > 0;) {
+            backwardLayer(i);
+        }
+
+        for (size_t k = 0; k < m_numModels; ++k) {
+            m_totalLosses[k] += m_sampleLosses[k];
+        }
+        return m_sampleLosses;
+    }
+
+    const std::vector<double>& NetworkEnsemble::accumulatedLosses() const {
+        return m_totalLosses;
+    }
+
+    void NetworkEnsemble::resetLosses() {
+        std::fill(m_totalLosses.begin(), m_totalLosses.end(), 0.0);
+    }
+
+    size_t NetworkEnsemble::bestModel() const {
+        return static_cast<size_t>(std::distance(m_totalLosses.begin(),
+            std::min_element(m_totalLosses.begin(), m_totalLosses.end())));
+    }
+
+    NeuralNetwork NetworkEnsemble::extractModel(size_t k) const {
+        assert(k < m_numModels);
+        NeuralNetwork net(m_layerSizes, m_activationTypes, m_lossType, m_optType,
+            m_learningRates[k], m_momentum);
+
+        for (size_t layer = 0; layer < m_weights.size(); ++layer) {
+            Matrix& w = net.weights()[layer];
+            Matrix& b = net.biases()[layer];
+            for (size_t e = 0; e < w.data().size(); ++e) {
+                w.data()[e] = m_weights[layer](e, k);
+            }
+            for (size_t e = 0; e < b.data().size(); ++e) {
+                b.data()[e] = m_biases[layer](e, k);
+            }
+        }
+        return net;
+    }
+
+    void NetworkEnsemble::loadInput(const Matrix& input) {
+        assert(input.cols() == m_layerSizes[0]);
+        assert((input.rows() == 1 || input.rows() == m_numModels) &&
+            "Input must be shared (1 row) or per-model (K rows)");
+
+        bool shared = (input.rows() == 1);
+        for (size_t i = 0; i < input.cols(); ++i) {
+            for (size_t k = 0; k < m_numModels; ++k) {
+                m_input(i, k) = input(shared ? 0 : k, i);
+            }
+        }
+    }
+
+    void NetworkEnsemble::forwardLayer(size_t layer) {
+        const size_t K = m_numModels;
+        const size_t inDim = m_layerSizes[layer];
+        const size_t outDim = m_layerSizes[layer + 1];
+
+        const double* x = (layer == 0 ? m_input : m_layerOutputs[layer - 1]).data().data();
+        const double* w = m_weights[layer].data().data();
+        const double* b = m_biases[layer].data().data();
+        double* net = m_layerNetInputs[layer].data().data();
+        double* out = m_layerOutputs[layer].data().data();
+
+        withActivationTraits(m_activationTypes[layer], [&](auto traits) {
+            using Traits = decltype(traits);
+            // One output unit of every model per task
+            auto computeUnit = [&](size_t j) {
+                double* z = net + j * K;
+                std::fill(z, z + K, 0.0);
+                for (size_t i = 0; i < inDim; ++i) {
+                    const double* xi = x + i * K;
+                    const double* wij = w + (i * outDim + j) * K;
+                    for (size_t k = 0; k < K; ++k) {
+                        z[k] += xi[k] * wij[k];
+                    }
+                }
+                const double* bj = b + j * K;
+                double* y = out + j * K;
+                for (size_t k = 0; k < K; ++k) {
+                    z[k] += bj[k];
+                    y[k] = Traits::forward(z[k]);
+                }
+            };
+            forEachIndex(outDim, inDim * outDim * K >= kParallelWorkThreshold, computeUnit);
+        });
+    }
+
+    void NetworkEnsemble::computeOutputDelta(const Matrix& target) {
+        const size_t K = m_numModels;
+        const Matrix& pred = m_layerOutputs.back();
+        Matrix& delta = m_deltas.back();
+        assert(target.cols() == pred.rows());
+        assert((target.rows() == 1 || target.rows() == K) &&
+            "Target must be shared (1 row) or per-model (K rows)");
+        bool shared = (target.rows() == 1);
+
+        auto compute = [&](auto traits) {
+            using Traits = decltype(traits);
+            std::fill(m_sampleLosses.begin(), m_sampleLosses.end(), 0.0);
+            for (size_t j = 0; j < pred.rows(); ++j) {
+                for (size_t k = 0; k < K; ++k) {
+                    double p = pred(j, k);
+                    double t = target(shared ? 0 : k, j);
+                    m_sampleLosses[k] += Traits::value(p, t);
+                    delta(j, k) = Traits::gradient(p, t);
+                }
+            }
+        };
+        if (m_lossType == LossType::CrossEntropy) {
+            compute(LossTraits<LossType::CrossEntropy>{});
+        }
+        else {
+            compute(LossTraits<LossType::MSE>{});
+        }
+    }
+
+    void NetworkEnsemble::backwardLayer(size_t layer) {
+        const size_t K = m_numModels;
+        const size_t inDim = m_layerSizes[layer];
+        const size_t outDim = m_layerSizes[layer + 1];
+
+        // delta: dL/dOut -> dL/dNet
+        double* delta = m_deltas[layer].data().data();
+        const double* net = m_layerNetInputs[layer].data().data();
+        withActivationTraits(m_activationTypes[layer], [&](auto traits) {
+            using Traits = decltype(traits);
+            for (size_t e = 0; e < outDim * K; ++e) {
+                delta[e] *= Traits::derivative(net[e]);
+            }
+        });
+
+        const double* x = (layer == 0 ? m_input : m_layerOutputs[layer - 1]).data().data();
+        double* w = m_weights[layer].data().data();
+        double* vW = m_velocityW[layer].data().data();
+        double* prev = (layer > 0) ? m_deltas[layer - 1].data().data() : nullptr;
+        const double* lr = m_learningRates.data();
+        const double momentum = m_momentum;
+        const bool useMomentum = (m_optType == OptimizerType::Momentum);
+
+        // Row i of W only feeds prev row i, so input units are independent.
+        // Weights are updated before being used to propagate the gradient,
+        // matching NeuralNetwork::trainSample.
+        auto processInput = [&](size_t i) {
+            const double* xi = x + i * K;
+            double* p = prev ? prev + i * K : nullptr;
+            if (p) {
+                std::fill(p, p + K, 0.0);
+            }
+            for (size_t j = 0; j < outDim; ++j) {
+                double* wij = w + (i * outDim + j) * K;
+                double* vij = vW + (i * outDim + j) * K;
+                const double* dj = delta + j * K;
+                if (useMomentum) {
+                    updateLanes<true>(wij, vij, lr, momentum, xi, dj, K);
+                }
+                else {
+                    updateLanes<false>(wij, vij, lr, momentum, xi, dj, K);
+                }
+                if (p) {
+                    for (size_t k = 0; k < K; ++k) {
+                        p[k] += dj[k] * wij[k];
+                    }
+                }
+            }
+        };
+        forEachIndex(inDim, inDim * outDim * K >= kParallelWorkThreshold, processInput);
+
+        // Biases: gradient is delta itself
+        double* b = m_biases[layer].data().data();
+        double* vB = m_velocityB[layer].data().data();
+        for (size_t j = 0; j < outDim; ++j) {
+            if (useMomentum) {
+                updateLanes<true>(b + j * K, vB + j * K, lr, momentum, nullptr, delta + j * K, K);
+            }
+            else {
+                updateLanes<false>(b + j * K, vB + j * K, lr, momentum, nullptr, delta + j * K, K);
+            }
+        }
+    }
+
+}  // namespace nn
@@ -1,5 +1,8 @@
 #include "../include/neural_network.h"
+#include "../include/execution_backend.h"
+#include "../include/random.h"
 
+#include <algorithm>
 #include <cassert>
 #include <iostream>
 
@@ -27,41 +30,87 @@ namespace nn {
             size_t inDim = layerSizes[i];
             size_t outDim = layerSizes[i + 1];
 
-            m_weights.emplace_back(inDim, outDim, true);
-            m_biases.emplace_back(1, outDim, true);
+            m_weights.emplace_back(inDim, outDim);
+            m_biases.emplace_back(1, outDim);
 
             m_activations.push_back(getActivation(activations[i]));
 
-            m_optimizersW.push_back(createOptimizer(optType, learningRate, momentum));
-            m_optimizersB.push_back(createOptimizer(optType, learningRate, momentum));
+            // L-BFGS steps the whole parameter vector; the per-tensor
+            // optimizers then only hold the learning rate
+            const OptimizerType perTensor = (optType == OptimizerType::LBFGS) ? OptimizerType::SGD : optType;
+            m_optimizersW.push_back(createOptimizer(perTensor, learningRate, momentum));
+            m_optimizersB.push_back(createOptimizer(perTensor, learningRate, momentum));
         }
+        if (optType == OptimizerType::LBFGS) {
+            m_lbfgs = std::make_unique<Lbfgs>();
+        }
+
+        m_activationTypes = activations;
+        m_activationPrecisions.assign(numLayers, ActivationPrecision::Exact);
+        initializeParameters(mixSeed(globalSeed(), nextTensorId()));
 
         // Loss
+        m_lossType = lossType;
         m_lossFunc = getLoss(lossType);
+        m_optimizerType = optType;
+        m_momentum = momentum;
+    }
+
+    void NeuralNetwork::initializeParameters(uint64_t seed) {
+        for (size_t i = 0; i < m_weights.size(); ++i) {
+            // Tensor IDs: 2i for layer i's weights (2i + 1 reserved for biases)
+            initializeWeights(m_weights[i], defaultInitFor(m_activationTypes[i]), seed, 2 * i);
+            // Small positive ReLU bias keeps units from starting out dead
+            double bias = (m_activationTypes[i] == ActivationType::ReLU) ? 0.01 : 0.0;
+            std::fill(m_biases[i].data().begin(), m_biases[i].data().end(), bias);
+            placeMatrix(m_weights[i], TensorRole::Weights);
+        }
+    }
+
+    void NeuralNetwork::forwardLayer(size_t i, const Matrix& in, Matrix& net, Matrix& out) const {
+        net = Matrix::addRowVector(Matrix::multiply(in, m_weights[i]), m_biases[i]);
+        out = net;
+        out.applyFunction(m_activations[i].forward);
     }
 
     Matrix NeuralNetwork::forward(const Matrix& input) {
+        const size_t numLayers = m_weights.size();
         // Clear stored nets/outputs
-        m_layerOutputs.clear();
-        m_layerNetInputs.clear();
+        m_layerNetInputs.assign(numLayers, Matrix());
+        m_layerOutputs.assign(numLayers, Matrix());
 
-        Matrix current = input;  // shape: (1 x inDim)
+        Matrix current = input;  // shape: (batch x inDim)
+        Matrix net;
+        Matrix out;
 
         // Forward through each layer
-        for (size_t i = 0; i < m_weights.size(); ++i) {
-            Matrix net = Matrix::add(Matrix::multiply(current, m_weights[i]), m_biases[i]);
-            m_layerNetInputs.push_back(net);
-
-            Matrix out = net;
-            out.applyFunction(m_activations[i].forward);
+        for (size_t i = 0; i < numLayers; ++i) {
+            forwardLayer(i, current, net, out);
+            if (m_checkpointStride == 1) {
+                m_layerNetInputs[i] = net;
+            }
+            if (isCheckpoint(i)) {
+                m_layerOutputs[i] = out;
+            }
+            trackActivationMemory();
+            current = std::move(out);
+        }
+        return current;
+    }
 
-            m_layerOutputs.push_back(out);
-            current = out;
+    Matrix NeuralNetwork::predict(const Matrix& input) const {
+        Matrix current = input;
+        Matrix net;
+        for (size_t i = 0; i < m_weights.size(); ++i) {
+            forwardLayer(i, current, net, current);
         }
         return current;
     }
 
     double NeuralNetwork::trainSample(const Matrix& input, const Matrix& target) {
+        if (m_lbfgs) {
+            return trainLbfgs(input, target);
+        }
         Matrix pred = forward(input);
 
         // Compute loss
@@ -70,50 +119,292 @@ namespace nn {
         // Gradient wrt final output
         Matrix gradOut = m_lossFunc.derivative(pred, target);
 
-        // Backprop
-        for (int layerIndex = static_cast<int>(m_weights.size()) - 1; layerIndex >= 0; --layerIndex) {
-            // dAct = derivative wrt net input
-            Matrix dAct = m_layerNetInputs[layerIndex];
-            ActivationFunction af = m_activations[layerIndex];
-            for (size_t i = 0; i < dAct.data().size(); ++i) {
-                double x = dAct.data()[i];
-                dAct.data()[i] = af.derivative(x);
+        // Backprop one segment of checkpointStride layers at a time, top down.
+        // Layers below a segment are not updated yet, so its recomputed
+        // activations match the forward pass exactly.
+        const size_t stride = m_checkpointStride;
+        for (size_t segEnd = m_weights.size(); segEnd > 0;) {
+            size_t segBegin = ((segEnd - 1) / stride) * stride;
+
+            if (stride > 1) {
+                for (size_t i = segBegin; i < segEnd; ++i) {
+                    const Matrix& in = (i == 0) ? input : m_layerOutputs[i - 1];
+                    forwardLayer(i, in, m_layerNetInputs[i], m_layerOutputs[i]);
+                }
+                trackActivationMemory();
             }
 
-            // gradOut *= dAct
-            for (size_t i = 0; i < gradOut.data().size(); ++i) {
-                gradOut.data()[i] *= dAct.data()[i];
+            for (size_t i = segEnd; i-- > segBegin;) {
+                backwardLayer(i, input, gradOut);
             }
 
-            // layerInput is input to current layer
-            Matrix layerInput;
-            if (layerIndex == 0) {
-                layerInput = input;
+            if (stride > 1) {
+                for (size_t i = segBegin; i < segEnd; ++i) {
+                    m_layerNetInputs[i] = Matrix();
+                    m_layerOutputs[i] = Matrix();
+                }
             }
-            else {
-                layerInput = m_layerOutputs[layerIndex - 1];
+            segEnd = segBegin;
+        }
+
+        return lossVal;
+    }
+
+    double NeuralNetwork::computeGradients(const Matrix& input, const Matrix& target,
+        std::vector<Matrix>& dW, std::vector<Matrix>& dB) const {
+        const size_t L = m_weights.size();
+        std::vector<Matrix> nets(L), outs(L);
+        for (size_t i = 0; i < L; ++i) {
+            forwardLayer(i, i == 0 ? input : outs[i - 1], nets[i], outs[i]);
+        }
+        const double loss = m_lossFunc.forward(outs.back(), target);
+        Matrix gradOut = m_lossFunc.derivative(outs.back(), target);
+
+        dW.assign(L, Matrix());
+        dB.assign(L, Matrix());
+        for (size_t i = L; i-- > 0;) {
+            accumulateLayerGradients(i, i == 0 ? input : outs[i - 1], nets[i], gradOut, dW[i], dB[i], i > 0);
+        }
+        return loss;
+    }
+
+    double NeuralNetwork::lossAndGradient(const Matrix& input, const Matrix& target,
+        std::vector<double>& grad) const {
+        std::vector<Matrix> dW, dB;
+        const double loss = computeGradients(input, target, dW, dB);
+        grad.clear();
+        for (size_t i = 0; i < dW.size(); ++i) {
+            grad.insert(grad.end(), dW[i].data().begin(), dW[i].data().end());
+            grad.insert(grad.end(), dB[i].data().begin(), dB[i].data().end());
+        }
+        return loss;
+    }
+
+    double NeuralNetwork::trainLbfgs(const Matrix& input, const Matrix& target) {
+        std::vector<double> params;
+        for (size_t i = 0; i < m_weights.size(); ++i) {
+            params.insert(params.end(), m_weights[i].data().begin(), m_weights[i].data().end());
+            params.insert(params.end(), m_biases[i].data().begin(), m_biases[i].data().end());
+        }
+        auto load = [this](const std::vector<double>& x) {
+            auto it = x.begin();
+            for (size_t i = 0; i < m_weights.size(); ++i) {
+                auto& w = m_weights[i].data();
+                auto& b = m_biases[i].data();
+                std::copy(it, it + w.size(), w.begin());
+                it += w.size();
+                std::copy(it, it + b.size(), b.begin());
+                it += b.size();
             }
+        };
+
+        double loss = m_lbfgs->step(params, [&](const std::vector<double>& x, std::vector<double>& grad) {
+            load(x);
+            return lossAndGradient(input, target, grad);
+        });
+        load(params);
+        return loss;
+    }
+
+    void NeuralNetwork::backwardLayer(size_t layerIndex, const Matrix& input, Matrix& gradOut) {
+        // dAct = derivative wrt net input
+        Matrix dAct = m_layerNetInputs[layerIndex];
+        const ActivationFunction& af = m_activations[layerIndex];
+        for (size_t i = 0; i < dAct.data().size(); ++i) {
+            double x = dAct.data()[i];
+            dAct.data()[i] = af.derivative(x);
+        }
+
+        // gradOut *= dAct
+        for (size_t i = 0; i < gradOut.data().size(); ++i) {
+            gradOut.data()[i] *= dAct.data()[i];
+        }
+
+        // layerInput is input to current layer
+        const Matrix& layerInput = (layerIndex == 0) ? input : m_layerOutputs[layerIndex - 1];
+
+        // dW = layerInput^T * gradOut
+        Matrix layerInputT = Matrix::transpose(layerInput);
+        Matrix dW = Matrix::multiply(layerInputT, gradOut);
+
+        // dB = gradOut, summed over the batch
+        Matrix dB = Matrix::columnSums(gradOut);
+
+        // Update
+        m_optimizersW[layerIndex]->update(m_weights[layerIndex], dW);
+        m_optimizersB[layerIndex]->update(m_biases[layerIndex], dB);
+
+        // Compute gradOut for previous layer
+        if (layerIndex > 0) {
+            Matrix wT = Matrix::transpose(m_weights[layerIndex]);
+            Matrix prevGrad = Matrix::multiply(gradOut, wT);
+            gradOut = prevGrad;
+        }
+    }
+
+    void NeuralNetwork::accumulateLayerGradients(size_t i, const Matrix& input, const Matrix& net,
+        Matrix& grad, Matrix& dW, Matrix& dB, bool propagate) const {
+        const ActivationFunction& af = m_activations[i];
+        for (size_t e = 0; e < grad.data().size(); ++e) {
+            grad.data()[e] *= af.derivative(net.data()[e]);
+        }
+
+        Matrix layerDW = Matrix::multiply(Matrix::transpose(input), grad);
+        Matrix layerDB = Matrix::columnSums(grad);
+        if (dW.data().empty()) {
+            dW = std::move(layerDW);
+            dB = std::move(layerDB);
+        }
+        else {
+            dW = Matrix::add(dW, layerDW);
+            dB = Matrix::add(dB, layerDB);
+        }
 
-            // dW = layerInput^T * gradOut
-            Matrix layerInputT = Matrix::transpose(layerInput);
-            Matrix dW = Matrix::multiply(layerInputT, gradOut);
+        if (propagate) {
+            grad = Matrix::multiply(grad, Matrix::transpose(m_weights[i]));
+        }
+    }
+
+    void NeuralNetwork::applyLayerGradients(size_t i, const Matrix& dW, const Matrix& dB) {
+        assert(!m_lbfgs && "LBFGS networks only train through trainSample");
+        m_optimizersW[i]->update(m_weights[i], dW);
+        m_optimizersB[i]->update(m_biases[i], dB);
+    }
+
+    size_t NeuralNetwork::numLayers() const {
+        return m_weights.size();
+    }
+
+    ActivationType NeuralNetwork::activationType(size_t i) const {
+        return m_activationTypes[i];
+    }
+
+    void NeuralNetwork::setActivationPrecision(size_t i, ActivationPrecision precision) {
+        m_activationPrecisions[i] = precision;
+        m_activations[i] = getActivation(m_activationTypes[i], precision);
+    }
 
-            // dB = gradOut
-            Matrix dB = gradOut;
+    ActivationPrecision NeuralNetwork::activationPrecision(size_t i) const {
+        return m_activationPrecisions[i];
+    }
 
-            // Update
-            m_optimizersW[layerIndex]->update(m_weights[layerIndex], dW);
-            m_optimizersB[layerIndex]->update(m_biases[layerIndex], dB);
+    OptimizerType NeuralNetwork::optimizerType() const {
+        return m_optimizerType;
+    }
+
+    double NeuralNetwork::momentum() const {
+        return m_momentum;
+    }
 
-            // Compute gradOut for previous layer
-            if (layerIndex > 0) {
-                Matrix wT = Matrix::transpose(m_weights[layerIndex]);
-                Matrix prevGrad = Matrix::multiply(gradOut, wT);
-                gradOut = prevGrad;
+    bool NeuralNetwork::isCheckpoint(size_t i) const {
+        // The last output is the prediction and always kept
+        return (i + 1) % m_checkpointStride == 0 || i + 1 == m_weights.size();
+    }
+
+    void NeuralNetwork::trackActivationMemory() {
+        size_t bytes = 0;
+        for (size_t i = 0; i < m_layerOutputs.size(); ++i) {
+            bytes += m_layerNetInputs[i].data().size() * sizeof(double);
+            bytes += m_layerOutputs[i].data().size() * sizeof(double);
+        }
+        m_peakActivationBytes = std::max(m_peakActivationBytes, bytes);
+    }
+
+    void NeuralNetwork::setCheckpointStride(size_t stride) {
+        m_checkpointStride = std::max<size_t>(stride, 1);
+        m_layerNetInputs.clear();
+        m_layerOutputs.clear();
+    }
+
+    size_t NeuralNetwork::setCheckpointMemoryBudget(size_t budgetBytes, size_t batchSize) {
+        // Any stride > 1 recomputes each layer once, so if storing everything
+        // does not fit, the stride with the lowest peak costs no more than others
+        size_t best = 1;
+        size_t bestBytes = estimateActivationBytes(1, batchSize);
+        const bool fitsWithoutCheckpoints = (bestBytes <= budgetBytes);
+        for (size_t stride = 2; stride <= m_weights.size() && !fitsWithoutCheckpoints; ++stride) {
+            size_t bytes = estimateActivationBytes(stride, batchSize);
+            if (bytes < bestBytes) {
+                best = stride;
+                bestBytes = bytes;
             }
         }
+        setCheckpointStride(best);
+        return best;
+    }
 
-        return lossVal;
+    size_t NeuralNetwork::checkpointStride() const {
+        return m_checkpointStride;
+    }
+
+    size_t NeuralNetwork::estimateActivationBytes(size_t stride, size_t batchSize) const {
+        const size_t numLayers = m_weights.size();
+        const size_t rowBytes = batchSize * sizeof(double);
+        stride = std::max<size_t>(stride, 1);
+        if (stride == 1) {
+            size_t bytes = 0;
+            for (size_t i = 0; i < numLayers; ++i) {
+                bytes += 2 * m_weights[i].cols() * rowBytes;
+            }
+            return bytes;
+        }
+
+        // Checkpointed outputs, plus net and output of one recomputed segment
+        size_t checkpoints = 0;
+        for (size_t i = 0; i < numLayers; ++i) {
+            if ((i + 1) % stride == 0 || i + 1 == numLayers) {
+                checkpoints += m_weights[i].cols() * rowBytes;
+            }
+        }
+        size_t worstSegment = 0;
+        for (size_t segBegin = 0; segBegin < numLayers; segBegin += stride) {
+            size_t segment = 0;
+            for (size_t i = segBegin; i < std::min(segBegin + stride, numLayers); ++i) {
+                bool stored = (i + 1) % stride == 0 || i + 1 == numLayers;
+                segment += (stored ? 1 : 2) * m_weights[i].cols() * rowBytes;
+            }
+            worstSegment = std::max(worstSegment, segment);
+        }
+        return checkpoints + worstSegment;
+    }
+
+    size_t NeuralNetwork::peakActivationBytes() const {
+        return m_peakActivationBytes;
+    }
+
+    void NeuralNetwork::resetPeakActivationBytes() {
+        m_peakActivationBytes = 0;
+    }
+
+    std::vector<Matrix>& NeuralNetwork::weights() {
+        return m_weights;
+    }
+
+    const std::vector<Matrix>& NeuralNetwork::weights() const {
+        return m_weights;
+    }
+
+    std::vector<Matrix>& NeuralNetwork::biases() {
+        return m_biases;
+    }
+
+    const std::vector<Matrix>& NeuralNetwork::biases() const {
+        return m_biases;
+    }
+
+    void NeuralNetwork::setLearningRate(double learningRate) {
+        for (size_t i = 0; i < m_optimizersW.size(); ++i) {
+            m_optimizersW[i]->setLearningRate(learningRate);
+            m_optimizersB[i]->setLearningRate(learningRate);
+        }
+    }
+
+    double NeuralNetwork::learningRate() const {
+        return m_optimizersW.empty() ? 0.0 : m_optimizersW.front()->learningRate();
+    }
+
+    LossType NeuralNetwork::lossType() const {
+        return m_lossType;
     }
 
 }  // namespace nn
@@ -0,0 +1,218 @@
+#include "../include/online_learning.h"
+
+#include <cassert>
+#include <chrono>
+#include <sstream>
+
+namespace nn {
+
+    ModelSnapshot::ModelSnapshot(const NeuralNetwork& net, size_t version, size_t steps)
+        : weights(net.weights()), biases(net.biases()), version(version), steps(steps) {
+        for (size_t i = 0; i < net.numLayers(); ++i) {
+            activations.push_back(net.activationType(i));
+            precisions.push_back(net.activationPrecision(i));
+        }
+    }
+
+    Matrix ModelSnapshot::predict(const Matrix& input) const {
+        Matrix current = input;
+        for (size_t i = 0; i < weights.size(); ++i) {
+            current = Matrix::addRowVector(Matrix::multiply(current, weights[i]), biases[i]);
+            current.applyFunction(getActivation(activations[i], precisions[i]).forward);
+        }
+        return current;
+    }
+
+    QueueSampleSource::QueueSampleSource(size_t capacity) : m_capacity(capacity) {
+        assert(capacity > 0);
+    }
+
+    bool QueueSampleSource::push(Matrix input, Matrix target) {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_notFull.wait(lock, [&] { return m_closed || m_samples.size() < m_capacity; });
+        if (m_closed) {
+            return false;
+        }
+        m_samples.emplace_back(std::move(input), std::move(target));
+        m_notEmpty.notify_one();
+        return true;
+    }
+
+    bool QueueSampleSource::next(Matrix& input, Matrix& target) {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_notEmpty.wait(lock, [&] { return m_closed || !m_samples.empty(); });
+        if (m_samples.empty()) {
+            return false;
+        }
+        input = std::move(m_samples.front().first);
+        target = std::move(m_samples.front().second);
+        m_samples.pop_front();
+        m_notFull.notify_one();
+        return true;
+    }
+
+    void QueueSampleSource::close() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_closed = true;
+        m_notEmpty.notify_all();
+        m_notFull.notify_all();
+    }
+
+    FileTailSampleSource::FileTailSampleSource(const std::string& path, size_t inputDim,
+        size_t outputDim, int pollMilliseconds)
+        : m_path(path), m_file(path), m_inputDim(inputDim), m_outputDim(outputDim),
+        m_pollMilliseconds(pollMilliseconds) {}
+
+    bool FileTailSampleSource::next(Matrix& input, Matrix& target) {
+        for (;;) {
+            if (!m_file.is_open()) {
+                m_file.open(m_path);   // The writer may not have created it yet
+            }
+            std::string chunk;
+            if (m_file.is_open() && std::getline(m_file, chunk)) {
+                if (!m_file.eof()) {
+                    std::string line = m_partial + chunk;
+                    m_partial.clear();
+                    if (parse(line, input, target)) {
+                        return true;
+                    }
+                    continue;
+                }
+                // Reached the end mid-line: keep the fragment for later
+                m_partial += chunk;
+            }
+            m_file.clear();
+
+            if (m_closed.load(std::memory_order_acquire)) {
+                std::string line;
+                line.swap(m_partial);
+                return !line.empty() && parse(line, input, target);
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(m_pollMilliseconds));
+        }
+    }
+
+    void FileTailSampleSource::close() {
+        m_closed.store(true, std::memory_order_release);
+    }
+
+    bool FileTailSampleSource::parse(const std::string& line, Matrix& input, Matrix& target) {
+        size_t first = line.find_first_not_of(" \t\r");
+        if (first == std::string::npos || line[first] == '#') {
+            return false;
+        }
+        std::string text = line;
+        for (char& c : text) {
+            if (c == ',') {
+                c = ' ';
+            }
+        }
+        std::istringstream in(text);
+        std::vector<double> values;
+        double v;
+        while (in >> v) {
+            values.push_back(v);
+        }
+        if (!in.eof() || values.size() != m_inputDim + m_outputDim) {
+            ++m_skipped;
+            return false;
+        }
+        input = Matrix(1, m_inputDim);
+        target = Matrix(1, m_outputDim);
+        std::copy(values.begin(), values.begin() + m_inputDim, input.data().begin());
+        std::copy(values.begin() + m_inputDim, values.end(), target.data().begin());
+        return true;
+    }
+
+    OnlineLearner::OnlineLearner(NeuralNetwork& net, SampleSource& source,
+        const OnlineLearnerConfig& config)
+        : m_net(net), m_source(source), m_config(config), m_snapshots(config.maxReaders) {
+        assert(config.batchSize > 0 && config.publishInterval > 0);
+        // Every L-BFGS step must see the same full-batch objective, and a
+        // stream hands over a different mini-batch each time
+        assert(net.optimizerType() != OptimizerType::LBFGS && "OnlineLearner cannot train with L-BFGS");
+        publish();   // Readers always find a snapshot
+    }
+
+    OnlineLearner::~OnlineLearner() {
+        stop();
+    }
+
+    void OnlineLearner::start() {
+        assert(!m_thread.joinable() && "Already running");
+        m_thread = std::thread([this] { run(); });
+    }
+
+    void OnlineLearner::stop() {
+        if (m_thread.joinable()) {
+            m_source.close();
+            m_thread.join();
+        }
+    }
+
+    SnapshotCell<ModelSnapshot>::ReadGuard OnlineLearner::snapshot() const {
+        return m_snapshots.read();
+    }
+
+    Matrix OnlineLearner::predict(const Matrix& input) const {
+        auto guard = m_snapshots.read();
+        return guard->predict(input);
+    }
+
+    void OnlineLearner::run() {
+        const size_t batch = m_config.batchSize;
+        Matrix input, target;
+        Matrix batchIn, batchOut;
+        size_t rows = 0;
+        size_t sincePublish = 0;
+
+        auto trainStep = [&]() {
+            m_net.trainSample(batchIn, batchOut);
+            rows = 0;
+            m_steps.fetch_add(1, std::memory_order_relaxed);
+            if (++sincePublish == m_config.publishInterval) {
+                publish();
+                sincePublish = 0;
+            }
+        };
+
+        while (m_source.next(input, target)) {
+            if (batch == 1) {
+                batchIn = std::move(input);
+                batchOut = std::move(target);
+                trainStep();
+                continue;
+            }
+            if (rows == 0) {
+                batchIn.resize(batch, input.cols());
+                batchOut.resize(batch, target.cols());
+            }
+            std::copy(input.data().begin(), input.data().end(), batchIn.data().begin() + rows * input.cols());
+            std::copy(target.data().begin(), target.data().end(), batchOut.data().begin() + rows * target.cols());
+            if (++rows == batch) {
+                trainStep();
+            }
+        }
+
+        // Train on a final partial batch
+        if (rows > 0) {
+            Matrix in(rows, batchIn.cols());
+            Matrix out(rows, batchOut.cols());
+            std::copy(batchIn.data().begin(), batchIn.data().begin() + in.data().size(), in.data().begin());
+            std::copy(batchOut.data().begin(), batchOut.data().begin() + out.data().size(), out.data().begin());
+            batchIn = std::move(in);
+            batchOut = std::move(out);
+            trainStep();
+        }
+        if (sincePublish > 0) {
+            publish();
+        }
+    }
+
+    void OnlineLearner::publish() {
+        const size_t version = m_version.load(std::memory_order_relaxed) + 1;
+        m_snapshots.publish(std::make_unique<const ModelSnapshot>(m_net, version, steps()));
+        m_version.store(version, std::memory_order_release);
+    }
+
+}  // namespace nn
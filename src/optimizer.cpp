@@ -1,5 +1,7 @@
 #include "../include/optimizer.h"
 
+#include <cassert>
+
 namespace nn {
 
     SGDOptimizer::SGDOptimizer(double lr) : m_lr(lr) {}
@@ -11,6 +13,9 @@ namespace nn {
         }
     }
 
+    void SGDOptimizer::setLearningRate(double lr) { m_lr = lr; }
+    double SGDOptimizer::learningRate() const { return m_lr; }
+
     MomentumOptimizer::MomentumOptimizer(double lr, double momentum)
         : m_lr(lr), m_momentum(momentum) {}
 
@@ -29,7 +34,11 @@ namespace nn {
         }
     }
 
+    void MomentumOptimizer::setLearningRate(double lr) { m_lr = lr; }
+    double MomentumOptimizer::learningRate() const { return m_lr; }
+
     std::unique_ptr<Optimizer> createOptimizer(OptimizerType type, double lr, double momentum) {
+        assert(type != OptimizerType::LBFGS && "LBFGS is only available through NeuralNetwork::trainSample");
         if (type == OptimizerType::SGD) {
             return std::make_unique<SGDOptimizer>(lr);
         }
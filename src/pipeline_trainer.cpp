@@ -0,0 +1,249 @@
+#include "../include/pipeline_trainer.h"
+#include "../include/loss.h"
+
+#include <algorithm>
+#include <cassert>
+#include <deque>
+
+namespace nn {
+
+    struct PipelineTrainer::Stage {
+        size_t first = 0;
+        size_t last = 0;   ///< One past the stage's last layer
+
+        std::unique_ptr<SpscQueue<Matrix>> activationsIn;  ///< From stage s - 1
+        std::unique_ptr<SpscQueue<Matrix>> gradientsIn;    ///< From stage s + 1
+
+        // What backward needs from one micro-batch's forward
+        struct InFlight {
+            Matrix input;
+            std::vector<Matrix> nets;
+            std::vector<Matrix> outs;
+            Matrix lossGrad;   ///< Last stage only
+        };
+        std::deque<InFlight> inFlight;
+        size_t peakInFlight = 0;
+
+        std::vector<Matrix> dW;
+        std::vector<Matrix> dB;
+        double lossSum = 0.0;   ///< Last stage only, summed over rows
+    };
+
+    namespace {
+
+        // Contiguous ranges with roughly equal weight counts, at least one
+        // layer per stage
+        std::vector<std::pair<size_t, size_t>> partitionLayers(const NeuralNetwork& net, size_t numStages) {
+            const size_t L = net.numLayers();
+            numStages = std::max<size_t>(1, std::min(numStages, L));
+            std::vector<size_t> cost(L);
+            size_t total = 0;
+            for (size_t i = 0; i < L; ++i) {
+                cost[i] = net.weights()[i].data().size();
+                total += cost[i];
+            }
+
+            std::vector<std::pair<size_t, size_t>> ranges;
+            size_t begin = 0;
+            size_t acc = 0;
+            for (size_t s = 0; s < numStages; ++s) {
+                size_t end = begin;
+                const size_t target = total * (s + 1) / numStages;
+                const size_t maxEnd = L - (numStages - s - 1);
+                do {
+                    acc += cost[end++];
+                } while (end < maxEnd && acc + cost[end] / 2 < target);
+                if (s + 1 == numStages) {
+                    end = L;
+                }
+                ranges.emplace_back(begin, end);
+                begin = end;
+            }
+            return ranges;
+        }
+
+    }  // namespace
+
+    PipelineTrainer::PipelineTrainer(NeuralNetwork& net, const PipelineConfig& config)
+        : m_net(net), m_config(config) {
+        assert(net.optimizerType() != OptimizerType::LBFGS && "L-BFGS cannot step per micro-batch");
+        m_config.microBatches = std::max<size_t>(m_config.microBatches, 1);
+        m_ranges = partitionLayers(net, m_config.numStages);
+
+        const size_t S = m_ranges.size();
+        for (size_t s = 0; s < S; ++s) {
+            auto stage = std::make_unique<Stage>();
+            stage->first = m_ranges[s].first;
+            stage->last = m_ranges[s].second;
+            // Room for every micro-batch, so a producer never blocks on a
+            // consumer that is itself waiting to push the other way
+            if (s > 0) {
+                stage->activationsIn = std::make_unique<SpscQueue<Matrix>>(m_config.microBatches);
+            }
+            if (s + 1 < S) {
+                stage->gradientsIn = std::make_unique<SpscQueue<Matrix>>(m_config.microBatches);
+            }
+            m_stages.push_back(std::move(stage));
+        }
+        for (size_t s = 0; s < S; ++s) {
+            m_threads.emplace_back(&PipelineTrainer::stageMain, this, s);
+        }
+    }
+
+    PipelineTrainer::~PipelineTrainer() {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_startCv.notify_all();
+        for (std::thread& t : m_threads) {
+            t.join();
+        }
+    }
+
+    double PipelineTrainer::trainBatch(const Matrix& input, const Matrix& target) {
+        assert(input.rows() == target.rows() && input.rows() > 0);
+        const size_t rows = input.rows();
+        const size_t M = std::min(m_config.microBatches, rows);
+
+        m_microInputs.clear();
+        m_microTargets.clear();
+        for (size_t m = 0; m < M; ++m) {
+            size_t begin = rows * m / M;
+            size_t end = rows * (m + 1) / M;
+            Matrix x(end - begin, input.cols());
+            Matrix t(end - begin, target.cols());
+            std::copy(input.data().begin() + begin * input.cols(),
+                input.data().begin() + end * input.cols(), x.data().begin());
+            std::copy(target.data().begin() + begin * target.cols(),
+                target.data().begin() + end * target.cols(), t.data().begin());
+            m_microInputs.push_back(std::move(x));
+            m_microTargets.push_back(std::move(t));
+        }
+        m_totalRows = rows;
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        ++m_generation;
+        m_pending = m_stages.size();
+        m_startCv.notify_all();
+        m_doneCv.wait(lock, [this] { return m_pending == 0; });
+
+        return m_stages.back()->lossSum / static_cast<double>(rows);
+    }
+
+    const std::vector<std::pair<size_t, size_t>>& PipelineTrainer::stageLayers() const {
+        return m_ranges;
+    }
+
+    size_t PipelineTrainer::peakInFlight() const {
+        size_t peak = 0;
+        for (const auto& stage : m_stages) {
+            peak = std::max(peak, stage->peakInFlight);
+        }
+        return peak;
+    }
+
+    void PipelineTrainer::stageMain(size_t s) {
+        if (m_config.pinThreads) {
+            pinCurrentThreadToCore(m_config.firstCore + s);
+        }
+        size_t seen = 0;
+        for (;;) {
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_startCv.wait(lock, [&] { return m_stop || m_generation != seen; });
+                if (m_stop) {
+                    return;
+                }
+                seen = m_generation;
+            }
+
+            runStage(s);
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (--m_pending == 0) {
+                m_doneCv.notify_one();
+            }
+        }
+    }
+
+    void PipelineTrainer::runStage(size_t s) {
+        Stage& st = *m_stages[s];
+        const size_t S = m_stages.size();
+        const size_t M = m_microInputs.size();
+        const size_t numLayers = st.last - st.first;
+        const bool isLast = (s + 1 == S);
+        const LossFunction lossFunc = getLoss(m_net.lossType());
+
+        st.dW.assign(numLayers, Matrix());
+        st.dB.assign(numLayers, Matrix());
+        st.lossSum = 0.0;
+        st.peakInFlight = 0;
+
+        size_t nextForward = 0;
+        auto forwardMicroBatch = [&]() {
+            Stage::InFlight f;
+            f.input = (s == 0) ? m_microInputs[nextForward] : st.activationsIn->pop();
+            f.nets.resize(numLayers);
+            f.outs.resize(numLayers);
+            for (size_t k = 0; k < numLayers; ++k) {
+                const Matrix& in = (k == 0) ? f.input : f.outs[k - 1];
+                m_net.forwardLayer(st.first + k, in, f.nets[k], f.outs[k]);
+            }
+
+            if (isLast) {
+                const Matrix& pred = f.outs.back();
+                const Matrix& target = m_microTargets[nextForward];
+                const double rows = static_cast<double>(pred.rows());
+                st.lossSum += lossFunc.forward(pred, target) * rows;
+                // Micro-batch mean gradient reweighted to the full batch mean
+                f.lossGrad = lossFunc.derivative(pred, target);
+                const double scale = rows / static_cast<double>(m_totalRows);
+                for (double& g : f.lossGrad.data()) {
+                    g *= scale;
+                }
+            }
+            else {
+                // The next stage owns this output; backward here never reads it
+                m_stages[s + 1]->activationsIn->push(std::move(f.outs.back()));
+            }
+            st.inFlight.push_back(std::move(f));
+            st.peakInFlight = std::max(st.peakInFlight, st.inFlight.size());
+            ++nextForward;
+        };
+
+        auto backwardMicroBatch = [&]() {
+            Stage::InFlight& f = st.inFlight.front();
+            Matrix grad = isLast ? std::move(f.lossGrad) : st.gradientsIn->pop();
+            for (size_t k = numLayers; k-- > 0;) {
+                const size_t layer = st.first + k;
+                const Matrix& in = (k == 0) ? f.input : f.outs[k - 1];
+                m_net.accumulateLayerGradients(layer, in, f.nets[k], grad,
+                    st.dW[k], st.dB[k], layer > 0);
+            }
+            if (s > 0) {
+                m_stages[s - 1]->gradientsIn->push(std::move(grad));
+            }
+            st.inFlight.pop_front();
+        };
+
+        // GPipe: every forward first. 1F1B: enough forwards to fill the
+        // pipeline below this stage, then strictly alternate.
+        size_t warmup = (m_config.schedule == PipelineSchedule::GPipe)
+            ? M : std::min(S - s - 1, M);
+        for (size_t k = 0; k < warmup; ++k) {
+            forwardMicroBatch();
+        }
+        for (size_t done = 0; done < M; ++done) {
+            if (nextForward < M) {
+                forwardMicroBatch();
+            }
+            backwardMicroBatch();
+        }
+
+        for (size_t k = 0; k < numLayers; ++k) {
+            m_net.applyLayerGradients(st.first + k, st.dW[k], st.dB[k]);
+        }
+    }
+
+}  // namespace nn
@@ -0,0 +1,152 @@
+#include "../include/pruning.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <numeric>
+
+namespace nn {
+
+    size_t pruneByMagnitude(Matrix& w, double sparsity) {
+        assert(sparsity >= 0.0 && sparsity <= 1.0);
+        auto& data = w.data();
+        const size_t count = static_cast<size_t>(std::floor(sparsity * static_cast<double>(data.size())));
+        if (count == 0) {
+            return 0;
+        }
+        // Exactly count entries even with tied magnitudes
+        std::vector<size_t> order(data.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::nth_element(order.begin(), order.begin() + (count - 1), order.end(),
+            [&](size_t a, size_t b) { return std::abs(data[a]) < std::abs(data[b]); });
+        for (size_t i = 0; i < count; ++i) {
+            data[order[i]] = 0.0;
+        }
+        return count;
+    }
+
+    MagnitudePruner::MagnitudePruner(NeuralNetwork& net, const PruningSchedule& schedule)
+        : m_net(net), m_schedule(schedule) {
+        m_schedule.frequency = std::max<size_t>(m_schedule.frequency, 1);
+        m_schedule.endStep = std::max(m_schedule.endStep, m_schedule.beginStep);
+        for (const Matrix& w : net.weights()) {
+            m_pruned.emplace_back(w.data().size(), false);
+        }
+    }
+
+    void MagnitudePruner::step() {
+        ++m_step;
+        const PruningSchedule& s = m_schedule;
+        bool due = m_step >= s.beginStep && m_step <= s.endStep
+            && ((m_step - s.beginStep) % s.frequency == 0 || m_step == s.endStep);
+        if (due) {
+            pruneTo(targetSparsity(m_step));
+        }
+        else {
+            applyMasks();
+        }
+    }
+
+    void MagnitudePruner::pruneTo(double sparsity) {
+        // Earlier pruned weights are 0 and stay among the smallest, so the
+        // mask only grows
+        applyMasks();
+        for (size_t i = 0; i < m_net.numLayers(); ++i) {
+            Matrix& w = m_net.weights()[i];
+            pruneByMagnitude(w, sparsity);
+            for (size_t e = 0; e < w.data().size(); ++e) {
+                if (w.data()[e] == 0.0) {
+                    m_pruned[i][e] = true;
+                }
+            }
+        }
+    }
+
+    double MagnitudePruner::targetSparsity(size_t step) const {
+        const PruningSchedule& s = m_schedule;
+        if (step <= s.beginStep) {
+            return 0.0;
+        }
+        if (step >= s.endStep) {
+            return s.finalSparsity;
+        }
+        double remaining = 1.0 - static_cast<double>(step - s.beginStep)
+            / static_cast<double>(s.endStep - s.beginStep);
+        return s.finalSparsity * (1.0 - remaining * remaining * remaining);
+    }
+
+    double MagnitudePruner::sparsity() const {
+        size_t zeros = 0, total = 0;
+        for (const Matrix& w : m_net.weights()) {
+            zeros += static_cast<size_t>(std::count(w.data().begin(), w.data().end(), 0.0));
+            total += w.data().size();
+        }
+        return total ? static_cast<double>(zeros) / static_cast<double>(total) : 0.0;
+    }
+
+    void MagnitudePruner::applyMasks() {
+        for (size_t i = 0; i < m_pruned.size(); ++i) {
+            auto& w = m_net.weights()[i].data();
+            for (size_t e = 0; e < w.size(); ++e) {
+                if (m_pruned[i][e]) {
+                    w[e] = 0.0;
+                }
+            }
+        }
+    }
+
+    SparseNetwork::SparseNetwork(const NeuralNetwork& net, double maxDensity) {
+        for (size_t i = 0; i < net.numLayers(); ++i) {
+            SparseLayer layer;
+            SparseMatrix sparse = SparseMatrix::fromDense(net.weights()[i]);
+            layer.sparse = sparse.density() <= maxDensity;
+            if (layer.sparse) {
+                layer.sparseWeights = std::move(sparse);
+            }
+            else {
+                layer.denseWeights = net.weights()[i];
+            }
+            layer.biases = net.biases()[i];
+            layer.activation = net.activationType(i);
+            layer.precision = net.activationPrecision(i);
+            m_layers.push_back(std::move(layer));
+        }
+    }
+
+    Matrix SparseNetwork::predict(const Matrix& input) const {
+        Matrix current = input;
+        Matrix net;
+        for (const SparseLayer& layer : m_layers) {
+            if (layer.sparse) {
+                SparseMatrix::multiply(current, layer.sparseWeights, net);
+            }
+            else {
+                net = Matrix::multiply(current, layer.denseWeights);
+            }
+            const size_t cols = net.cols();
+            current.resize(net.rows(), cols);
+            withActivationTraits(layer.activation, layer.precision, [&](auto traits) {
+                using Traits = decltype(traits);
+                for (size_t e = 0; e < net.data().size(); ++e) {
+                    current.data()[e] = Traits::forward(net.data()[e] + layer.biases.data()[e % cols]);
+                }
+            });
+        }
+        return current;
+    }
+
+    bool SparseNetwork::isSparse(size_t i) const {
+        return m_layers[i].sparse;
+    }
+
+    size_t SparseNetwork::bytes() const {
+        size_t total = 0;
+        for (const SparseLayer& layer : m_layers) {
+            total += layer.sparse ? layer.sparseWeights.bytes()
+                : layer.denseWeights.data().size() * sizeof(double);
+            total += layer.biases.data().size() * sizeof(double);
+        }
+        return total;
+    }
+
+}  // namespace nn
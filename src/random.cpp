@@ -0,0 +1,165 @@
+#include "../include/random.h"
+#include "../include/execution_backend.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+
+namespace nn {
+
+    namespace {
+
+        constexpr uint64_t kDefaultSeed = 42;
+
+        std::atomic<uint64_t> g_seed{ kDefaultSeed };
+        std::atomic<uint64_t> g_nextTensorId{ 0 };
+
+        // Elements per parallel task; below this a fill stays on one thread
+        constexpr size_t kFillChunk = 8192;
+
+        constexpr double kTwoPi = 6.283185307179586476925286766559;
+
+        /**
+         * @brief 53 random bits -> double in [0, 1).
+         */
+        inline double toUnit(uint32_t hi, uint32_t lo) {
+            uint64_t bits = (static_cast<uint64_t>(hi) << 32) | lo;
+            return static_cast<double>(bits >> 11) * (1.0 / 9007199254740992.0);
+        }
+
+        /**
+         * @brief Runs fillBlock(blockBegin, blockEnd) over [0, numBlocks), where
+         *        a block is one Philox call. Chunk boundaries never change which
+         *        counter an element uses, so the split is invisible in the output.
+         */
+        template <typename FillBlocks>
+        void forEachBlockChunk(size_t numElements, FillBlocks fillBlocks) {
+            const size_t numBlocks = (numElements + 1) / 2;
+            const size_t blocksPerChunk = kFillChunk / 2;
+            if (numBlocks <= blocksPerChunk) {
+                fillBlocks(size_t{ 0 }, numBlocks);
+                return;
+            }
+            parallelFor(numBlocks, blocksPerChunk, [&](size_t begin, size_t end) {
+                fillBlocks(begin, end);
+            });
+        }
+
+        inline std::array<uint32_t, 4> blockBits(uint64_t seed, uint64_t tensorId, uint64_t block) {
+            return philox4x32(
+                { static_cast<uint32_t>(block), static_cast<uint32_t>(block >> 32),
+                  static_cast<uint32_t>(tensorId), static_cast<uint32_t>(tensorId >> 32) },
+                { static_cast<uint32_t>(seed), static_cast<uint32_t>(seed >> 32) });
+        }
+
+    }  // namespace
+
+    std::array<uint32_t, 4> philox4x32(std::array<uint32_t, 4> counter,
+        std::array<uint32_t, 2> key) {
+        const uint64_t M0 = 0xD2511F53u;
+        const uint64_t M1 = 0xCD9E8D57u;
+        for (int round = 0; round < 10; ++round) {
+            uint64_t p0 = M0 * counter[0];
+            uint64_t p1 = M1 * counter[2];
+            counter = {
+                static_cast<uint32_t>(p1 >> 32) ^ counter[1] ^ key[0],
+                static_cast<uint32_t>(p1),
+                static_cast<uint32_t>(p0 >> 32) ^ counter[3] ^ key[1],
+                static_cast<uint32_t>(p0)
+            };
+            key[0] += 0x9E3779B9u;
+            key[1] += 0xBB67AE85u;
+        }
+        return counter;
+    }
+
+    void setGlobalSeed(uint64_t seed) {
+        g_seed.store(seed);
+        g_nextTensorId.store(0);
+    }
+
+    uint64_t globalSeed() {
+        return g_seed.load();
+    }
+
+    uint64_t nextTensorId() {
+        return g_nextTensorId.fetch_add(1);
+    }
+
+    uint64_t mixSeed(uint64_t seed, uint64_t stream) {
+        uint64_t z = seed + 0x9E3779B97F4A7C15ULL * (stream + 1);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+
+    void fillUniform(Matrix& m, uint64_t seed, uint64_t tensorId, double low, double high) {
+        double* out = m.data().data();
+        const size_t n = m.data().size();
+        const double scale = high - low;
+        forEachBlockChunk(n, [&](size_t blockBegin, size_t blockEnd) {
+            for (size_t b = blockBegin; b < blockEnd; ++b) {
+                std::array<uint32_t, 4> r = blockBits(seed, tensorId, b);
+                size_t i = 2 * b;
+                out[i] = low + scale * toUnit(r[0], r[1]);
+                if (i + 1 < n) {
+                    out[i + 1] = low + scale * toUnit(r[2], r[3]);
+                }
+            }
+        });
+    }
+
+    void fillNormal(Matrix& m, uint64_t seed, uint64_t tensorId, double mean, double stddev) {
+        double* out = m.data().data();
+        const size_t n = m.data().size();
+        forEachBlockChunk(n, [&](size_t blockBegin, size_t blockEnd) {
+            for (size_t b = blockBegin; b < blockEnd; ++b) {
+                std::array<uint32_t, 4> r = blockBits(seed, tensorId, b);
+                // Box-Muller; u1 in (0, 1] keeps the log finite
+                double u1 = 1.0 - toUnit(r[0], r[1]);
+                double u2 = toUnit(r[2], r[3]);
+                double radius = stddev * std::sqrt(-2.0 * std::log(u1));
+                size_t i = 2 * b;
+                out[i] = mean + radius * std::cos(kTwoPi * u2);
+                if (i + 1 < n) {
+                    out[i + 1] = mean + radius * std::sin(kTwoPi * u2);
+                }
+            }
+        });
+    }
+
+    InitType defaultInitFor(ActivationType type) {
+        switch (type) {
+        case ActivationType::ReLU:
+            return InitType::HeNormal;
+        case ActivationType::Sigmoid:
+        case ActivationType::Tanh:
+        case ActivationType::Linear:
+            return InitType::XavierUniform;
+        }
+        return InitType::Uniform;
+    }
+
+    void initializeWeights(Matrix& w, InitType type, size_t fanIn, size_t fanOut,
+        uint64_t seed, uint64_t tensorId) {
+        switch (type) {
+        case InitType::Uniform:
+            fillUniform(w, seed, tensorId, -1.0, 1.0);
+            return;
+        case InitType::XavierUniform: {
+            double limit = std::sqrt(6.0 / static_cast<double>(std::max<size_t>(fanIn + fanOut, 1)));
+            fillUniform(w, seed, tensorId, -limit, limit);
+            return;
+        }
+        case InitType::HeNormal:
+            fillNormal(w, seed, tensorId, 0.0,
+                std::sqrt(2.0 / static_cast<double>(std::max<size_t>(fanIn, 1))));
+            return;
+        }
+    }
+
+    void initializeWeights(Matrix& w, InitType type, uint64_t seed, uint64_t tensorId) {
+        initializeWeights(w, type, w.rows(), w.cols(), seed, tensorId);
+    }
+
+}  // namespace nn
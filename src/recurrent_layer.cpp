@@ -0,0 +1,368 @@
+#include "../include/recurrent_layer.h"
+#include "../include/activation.h"
+#include "../include/random.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+namespace nn {
+
+    namespace {
+
+        double sigmoid(double x) {
+            return ActivationTraits<ActivationType::Sigmoid>::forward(x);
+        }
+
+        // dst (cols x rows) = src (rows x cols)^T
+        void transposeInto(const double* src, size_t rows, size_t cols, std::vector<double>& dst) {
+            if (dst.size() < rows * cols) {
+                dst.resize(rows * cols);
+            }
+            for (size_t r = 0; r < rows; ++r) {
+                for (size_t c = 0; c < cols; ++c) {
+                    dst[c * rows + r] = src[r * cols + c];
+                }
+            }
+        }
+
+        // C (M x N) = A (M x K) * B (K x N), C grown as needed
+        void gemm(const double* A, const double* B, std::vector<double>& C, size_t M, size_t N, size_t K) {
+            if (C.size() < M * N) {
+                C.resize(M * N);
+            }
+            Matrix::multiplyStridedBatched(A, 0, B, 0, C.data(), 0, M, N, K, 1);
+        }
+
+        void addInto(const double* x, size_t n, double* y) {
+            for (size_t e = 0; e < n; ++e) {
+                y[e] += x[e];
+            }
+        }
+
+    }  // namespace
+
+    // -------------------- RecurrentLayer --------------------
+
+    RecurrentLayer::RecurrentLayer(size_t inputSize, size_t hiddenSize, size_t seqLength,
+        size_t numGates, bool returnSequences, size_t bpttSteps, uint64_t seed)
+        : m_input(inputSize),
+        m_hidden(hiddenSize),
+        m_seqLength(seqLength),
+        m_numGates(numGates),
+        m_returnSequences(returnSequences),
+        m_bpttSteps(bpttSteps),
+        m_wx(inputSize, numGates * hiddenSize),
+        m_wh(hiddenSize, numGates * hiddenSize),
+        m_bx(1, numGates * hiddenSize),
+        m_bh(1, numGates * hiddenSize),
+        m_gradWx(inputSize, numGates * hiddenSize),
+        m_gradWh(hiddenSize, numGates * hiddenSize),
+        m_gradBx(1, numGates * hiddenSize),
+        m_gradBh(1, numGates * hiddenSize) {
+        assert(seqLength > 0 && hiddenSize > 0);
+        // Fans are per gate: each gate is its own (in x hidden) projection
+        initializeWeights(m_wx, InitType::XavierUniform, inputSize, hiddenSize, seed, 0);
+        initializeWeights(m_wh, InitType::XavierUniform, hiddenSize, hiddenSize, seed, 1);
+    }
+
+    size_t RecurrentLayer::outputWidth(const std::vector<size_t>& inputWidths) const {
+        assert(inputWidths.size() == 1 && inputWidths[0] == m_seqLength * m_input);
+        return m_returnSequences ? m_seqLength * m_hidden : m_hidden;
+    }
+
+    std::vector<size_t> RecurrentLayer::savedWidths(const std::vector<size_t>&) const {
+        // Gates (sequence-major rows, as the hoisted GEMM writes them), then
+        // hidden states and aux state stored step-major so h_{t-1} is a
+        // contiguous (batch x hidden) GEMM operand
+        return { m_seqLength * m_numGates * m_hidden, m_seqLength * m_hidden, m_seqLength * m_hidden };
+    }
+
+    void RecurrentLayer::forward(const std::vector<const Matrix*>& inputs, Matrix& output,
+        const std::vector<Matrix*>& saved, bool) {
+        const Matrix& in = *inputs[0];
+        const size_t B = in.rows();
+        const size_t T = m_seqLength;
+        const size_t H = m_hidden;
+        const size_t GH = m_numGates * H;
+        double* gates = saved[0]->data().data();
+        double* hidden = saved[1]->data().data();
+        double* aux = saved[2]->data().data();
+
+        // x_t * Wx for all (sequence, step) rows at once
+        Matrix::multiplyStridedBatched(in.data().data(), 0, m_wx.data().data(), 0,
+            gates, 0, B * T, GH, m_input, 1);
+
+        if (m_recurrent.size() < B * GH) {
+            m_recurrent.resize(B * GH);
+        }
+        for (size_t t = 0; t < T; ++t) {
+            const double* hPrev = (t > 0) ? hidden + (t - 1) * B * H : nullptr;
+            const double* auxPrev = (t > 0) ? aux + (t - 1) * B * H : nullptr;
+            if (hPrev) {
+                Matrix::multiplyStridedBatched(hPrev, 0, m_wh.data().data(), 0,
+                    m_recurrent.data(), 0, B, GH, H, 1);
+            }
+            else {
+                std::fill(m_recurrent.begin(), m_recurrent.begin() + B * GH, 0.0);
+            }
+            stepForward(B, gates + t * GH, T * GH, m_recurrent.data(), hPrev,
+                hidden + t * B * H, aux + t * B * H, auxPrev);
+        }
+
+        double* y = output.data().data();
+        if (m_returnSequences) {
+            for (size_t s = 0; s < B; ++s) {
+                for (size_t t = 0; t < T; ++t) {
+                    const double* h = hidden + (t * B + s) * H;
+                    std::copy(h, h + H, y + (s * T + t) * H);
+                }
+            }
+        }
+        else {
+            const double* last = hidden + (T - 1) * B * H;
+            std::copy(last, last + B * H, y);
+        }
+    }
+
+    void RecurrentLayer::backward(const std::vector<const Matrix*>& inputs,
+        const std::vector<Matrix*>& saved, Matrix& gradOutput,
+        const std::vector<Matrix*>& gradInputs) {
+        const Matrix& in = *inputs[0];
+        const size_t B = in.rows();
+        const size_t T = m_seqLength;
+        const size_t H = m_hidden;
+        const size_t GH = m_numGates * H;
+        double* gates = saved[0]->data().data();
+        const double* hidden = saved[1]->data().data();
+        const double* aux = saved[2]->data().data();
+        const double* g = gradOutput.data().data();
+        const size_t tStart = (m_bpttSteps > 0 && m_bpttSteps < T) ? T - m_bpttSteps : 0;
+
+        for (Matrix* grad : { &m_gradWx, &m_gradWh, &m_gradBx, &m_gradBh }) {
+            std::fill(grad->data().begin(), grad->data().end(), 0.0);
+        }
+        m_dh.assign(B * H, 0.0);
+        double* dRec = m_recurrent.data();
+        double* dWh = m_gradWh.data().data();
+        double* dBh = m_gradBh.data().data();
+        transposeInto(m_wh.data().data(), H, GH, m_weightT);
+        beginBackward(B);
+
+        for (size_t t = T; t-- > tStart;) {
+            for (size_t s = 0; s < B; ++s) {
+                const double* gs = nullptr;
+                if (m_returnSequences) {
+                    gs = g + (s * T + t) * H;
+                }
+                else if (t == T - 1) {
+                    gs = g + s * H;
+                }
+                if (gs) {
+                    for (size_t j = 0; j < H; ++j) {
+                        m_dh[s * H + j] += gs[j];
+                    }
+                }
+            }
+
+            const double* hPrev = (t > 0) ? hidden + (t - 1) * B * H : nullptr;
+            const double* auxPrev = (t > 0) ? aux + (t - 1) * B * H : nullptr;
+            stepBackward(B, gates + t * GH, T * GH, hPrev, hidden + t * B * H,
+                aux + t * B * H, auxPrev, m_dh.data(), dRec);
+
+            for (size_t s = 0; s < B; ++s) {
+                addInto(dRec + s * GH, GH, dBh);
+            }
+            if (hPrev) {
+                // dWh += h_{t-1}^T dGates_t, one (H x B) * (B x GH) product
+                transposeInto(hPrev, B, H, m_operandT);
+                gemm(m_operandT.data(), dRec, m_product, H, GH, B);
+                addInto(m_product.data(), H * GH, dWh);
+                if (t > tStart) {
+                    // dh_{t-1} += dGates_t Wh^T
+                    gemm(dRec, m_weightT.data(), m_product, B, H, GH);
+                    addInto(m_product.data(), B * H, m_dh.data());
+                }
+            }
+        }
+
+        // Input side: one GEMM each over every (sequence, step) row in the
+        // window, mirroring the hoisted input projection in forward
+        const size_t window = T - tStart;
+        const size_t rows = B * window;
+        const double* x = in.data().data();
+        const double* dGates = gates;
+        if (tStart > 0) {
+            // Rows before the window still hold activations: pack the window
+            m_windowX.resize(rows * m_input);
+            m_windowGates.resize(rows * GH);
+            for (size_t s = 0; s < B; ++s) {
+                const size_t from = s * T + tStart;
+                std::copy(x + from * m_input, x + (from + window) * m_input,
+                    m_windowX.begin() + s * window * m_input);
+                std::copy(gates + from * GH, gates + (from + window) * GH,
+                    m_windowGates.begin() + s * window * GH);
+            }
+            x = m_windowX.data();
+            dGates = m_windowGates.data();
+        }
+
+        // dWx = X^T dGates
+        transposeInto(x, rows, m_input, m_operandT);
+        gemm(m_operandT.data(), dGates, m_product, m_input, GH, rows);
+        std::copy(m_product.begin(), m_product.begin() + m_input * GH, m_gradWx.data().begin());
+        double* dBx = m_gradBx.data().data();
+        for (size_t r = 0; r < rows; ++r) {
+            addInto(dGates + r * GH, GH, dBx);
+        }
+
+        // dX += dGates Wx^T
+        if (gradInputs[0]) {
+            double* dX = gradInputs[0]->data().data();
+            transposeInto(m_wx.data().data(), m_input, GH, m_weightT);
+            gemm(dGates, m_weightT.data(), m_product, rows, m_input, GH);
+            for (size_t s = 0; s < B; ++s) {
+                addInto(m_product.data() + s * window * m_input, window * m_input,
+                    dX + (s * T + tStart) * m_input);
+            }
+        }
+    }
+
+    std::vector<std::pair<Matrix*, Matrix*>> RecurrentLayer::parameters() {
+        return { { &m_wx, &m_gradWx }, { &m_wh, &m_gradWh },
+            { &m_bx, &m_gradBx }, { &m_bh, &m_gradBh } };
+    }
+
+    // -------------------- LSTMLayer --------------------
+
+    LSTMLayer::LSTMLayer(size_t inputSize, size_t hiddenSize, size_t seqLength,
+        bool returnSequences, size_t bpttSteps)
+        : LSTMLayer(inputSize, hiddenSize, seqLength, returnSequences, bpttSteps,
+            mixSeed(globalSeed(), nextTensorId())) {}
+
+    LSTMLayer::LSTMLayer(size_t inputSize, size_t hiddenSize, size_t seqLength,
+        bool returnSequences, size_t bpttSteps, uint64_t seed)
+        : RecurrentLayer(inputSize, hiddenSize, seqLength, 4, returnSequences, bpttSteps, seed) {
+        // Start by remembering (Jozefowicz et al.)
+        std::fill(m_bx.data().begin() + hiddenSize, m_bx.data().begin() + 2 * hiddenSize, 1.0);
+    }
+
+    void LSTMLayer::stepForward(size_t batch, double* gates, size_t gateStride,
+        const double* recurrent, const double*, double* h,
+        double* aux, const double* auxPrev) {
+        const size_t H = m_hidden;
+        const double* bx = m_bx.data().data();
+        const double* bh = m_bh.data().data();
+        for (size_t s = 0; s < batch; ++s) {
+            double* gs = gates + s * gateStride;
+            const double* rs = recurrent + s * 4 * H;
+            for (size_t j = 0; j < H; ++j) {
+                double i = sigmoid(gs[j] + bx[j] + rs[j] + bh[j]);
+                double f = sigmoid(gs[H + j] + bx[H + j] + rs[H + j] + bh[H + j]);
+                double g = std::tanh(gs[2 * H + j] + bx[2 * H + j] + rs[2 * H + j] + bh[2 * H + j]);
+                double o = sigmoid(gs[3 * H + j] + bx[3 * H + j] + rs[3 * H + j] + bh[3 * H + j]);
+                double cPrev = auxPrev ? auxPrev[s * H + j] : 0.0;
+                double c = f * cPrev + i * g;
+                aux[s * H + j] = c;
+                h[s * H + j] = o * std::tanh(c);
+                gs[j] = i;
+                gs[H + j] = f;
+                gs[2 * H + j] = g;
+                gs[3 * H + j] = o;
+            }
+        }
+    }
+
+    void LSTMLayer::beginBackward(size_t batch) {
+        m_dc.assign(batch * m_hidden, 0.0);
+    }
+
+    void LSTMLayer::stepBackward(size_t batch, double* gates, size_t gateStride,
+        const double*, const double*, const double* aux, const double* auxPrev,
+        double* dh, double* dRecurrent) {
+        const size_t H = m_hidden;
+        for (size_t s = 0; s < batch; ++s) {
+            double* gs = gates + s * gateStride;
+            double* dr = dRecurrent + s * 4 * H;
+            for (size_t j = 0; j < H; ++j) {
+                const size_t e = s * H + j;
+                double i = gs[j], f = gs[H + j], g = gs[2 * H + j], o = gs[3 * H + j];
+                double cPrev = auxPrev ? auxPrev[e] : 0.0;
+                double tc = std::tanh(aux[e]);
+
+                double dc = m_dc[e] + dh[e] * o * (1.0 - tc * tc);
+                double dO = dh[e] * tc;
+                m_dc[e] = dc * f;
+                dh[e] = 0.0;  // h_{t-1} only reaches h_t through Wh
+
+                dr[j] = gs[j] = dc * g * i * (1.0 - i);
+                dr[H + j] = gs[H + j] = dc * cPrev * f * (1.0 - f);
+                dr[2 * H + j] = gs[2 * H + j] = dc * i * (1.0 - g * g);
+                dr[3 * H + j] = gs[3 * H + j] = dO * o * (1.0 - o);
+            }
+        }
+    }
+
+    // -------------------- GRULayer --------------------
+
+    GRULayer::GRULayer(size_t inputSize, size_t hiddenSize, size_t seqLength,
+        bool returnSequences, size_t bpttSteps)
+        : GRULayer(inputSize, hiddenSize, seqLength, returnSequences, bpttSteps,
+            mixSeed(globalSeed(), nextTensorId())) {}
+
+    GRULayer::GRULayer(size_t inputSize, size_t hiddenSize, size_t seqLength,
+        bool returnSequences, size_t bpttSteps, uint64_t seed)
+        : RecurrentLayer(inputSize, hiddenSize, seqLength, 3, returnSequences, bpttSteps, seed) {}
+
+    void GRULayer::stepForward(size_t batch, double* gates, size_t gateStride,
+        const double* recurrent, const double* hPrev, double* h,
+        double* aux, const double*) {
+        const size_t H = m_hidden;
+        const double* bx = m_bx.data().data();
+        const double* bh = m_bh.data().data();
+        for (size_t s = 0; s < batch; ++s) {
+            double* gs = gates + s * gateStride;
+            const double* rs = recurrent + s * 3 * H;
+            for (size_t j = 0; j < H; ++j) {
+                const size_t e = s * H + j;
+                double r = sigmoid(gs[j] + bx[j] + rs[j] + bh[j]);
+                double z = sigmoid(gs[H + j] + bx[H + j] + rs[H + j] + bh[H + j]);
+                double hn = rs[2 * H + j] + bh[2 * H + j];
+                double n = std::tanh(gs[2 * H + j] + bx[2 * H + j] + r * hn);
+                double hp = hPrev ? hPrev[e] : 0.0;
+                h[e] = (1.0 - z) * n + z * hp;
+                aux[e] = hn;
+                gs[j] = r;
+                gs[H + j] = z;
+                gs[2 * H + j] = n;
+            }
+        }
+    }
+
+    void GRULayer::stepBackward(size_t batch, double* gates, size_t gateStride,
+        const double* hPrev, const double*, const double* aux, const double*,
+        double* dh, double* dRecurrent) {
+        const size_t H = m_hidden;
+        for (size_t s = 0; s < batch; ++s) {
+            double* gs = gates + s * gateStride;
+            double* dr = dRecurrent + s * 3 * H;
+            for (size_t j = 0; j < H; ++j) {
+                const size_t e = s * H + j;
+                double r = gs[j], z = gs[H + j], n = gs[2 * H + j];
+                double hn = aux[e];
+                double hp = hPrev ? hPrev[e] : 0.0;
+
+                double dnPre = dh[e] * (1.0 - z) * (1.0 - n * n);
+                double dzPre = dh[e] * (hp - n) * z * (1.0 - z);
+                double drPre = dnPre * hn * r * (1.0 - r);
+                dh[e] *= z;  // direct path through the update gate
+
+                dr[j] = gs[j] = drPre;
+                dr[H + j] = gs[H + j] = dzPre;
+                gs[2 * H + j] = dnPre;
+                dr[2 * H + j] = dnPre * r;
+            }
+        }
+    }
+
+}  // namespace nn
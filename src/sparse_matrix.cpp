@@ -0,0 +1,76 @@
+#include "../include/sparse_matrix.h"
+#include "../include/execution_backend.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+namespace nn {
+
+    SparseMatrix SparseMatrix::fromDense(const Matrix& dense, double threshold) {
+        assert(dense.cols() <= UINT32_MAX);
+        SparseMatrix s;
+        s.m_rows = dense.rows();
+        s.m_cols = dense.cols();
+        s.m_rowStart.reserve(s.m_rows + 1);
+        s.m_rowStart.push_back(0);
+        for (size_t r = 0; r < s.m_rows; ++r) {
+            for (size_t c = 0; c < s.m_cols; ++c) {
+                double v = dense(r, c);
+                if (std::abs(v) > threshold) {
+                    s.m_colIndex.push_back(static_cast<uint32_t>(c));
+                    s.m_values.push_back(v);
+                }
+            }
+            s.m_rowStart.push_back(s.m_values.size());
+        }
+        return s;
+    }
+
+    Matrix SparseMatrix::toDense() const {
+        Matrix dense(m_rows, m_cols);
+        for (size_t r = 0; r < m_rows; ++r) {
+            for (size_t e = m_rowStart[r]; e < m_rowStart[r + 1]; ++e) {
+                dense(r, m_colIndex[e]) = m_values[e];
+            }
+        }
+        return dense;
+    }
+
+    void SparseMatrix::multiply(const Matrix& X, const SparseMatrix& W, Matrix& Y) {
+        assert(X.cols() == W.m_rows && "Incompatible matrix dimensions!");
+        const size_t K = W.m_rows;
+        const size_t N = W.m_cols;
+        Y.resize(X.rows(), N);
+
+        // Enough rows per task for a few thousand multiply-adds
+        const size_t work = std::max<size_t>(W.nonZeros(), 1);
+        parallelFor(X.rows(), std::max<size_t>(1, 4096 / work), [&](size_t begin, size_t end) {
+            for (size_t r = begin; r < end; ++r) {
+                double* y = Y.data().data() + r * N;
+                std::fill(y, y + N, 0.0);
+                const double* x = X.data().data() + r * K;
+                for (size_t k = 0; k < K; ++k) {
+                    const double xk = x[k];
+                    if (xk == 0.0) {
+                        continue;   // e.g. ReLU zeros: skip the whole weight row
+                    }
+                    for (size_t e = W.m_rowStart[k]; e < W.m_rowStart[k + 1]; ++e) {
+                        y[W.m_colIndex[e]] += xk * W.m_values[e];
+                    }
+                }
+            }
+        });
+    }
+
+    double SparseMatrix::density() const {
+        const size_t total = m_rows * m_cols;
+        return total ? static_cast<double>(nonZeros()) / static_cast<double>(total) : 0.0;
+    }
+
+    size_t SparseMatrix::bytes() const {
+        return m_values.size() * sizeof(double) + m_colIndex.size() * sizeof(uint32_t)
+            + m_rowStart.size() * sizeof(size_t);
+    }
+
+}  // namespace nn
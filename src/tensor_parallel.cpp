@@ -0,0 +1,281 @@
+#include "../include/tensor_parallel.h"
+#include "../include/loss.h"
+#include "../include/optimizer.h"
+
+#include <algorithm>
+#include <cassert>
+
+namespace nn {
+
+    struct TensorParallelTrainer::Shard {
+        size_t colBegin = 0;
+        size_t colEnd = 0;
+        size_t ld = 0;    ///< Padded row stride of weights and dW
+        Matrix weights;   ///< (inDim x ld), columns past the width stay zero
+        Matrix biases;    ///< (1 x width)
+        std::unique_ptr<Optimizer> optW;
+        std::unique_ptr<Optimizer> optB;
+
+        // Owner-local scratch, reused across batches
+        Matrix net;       ///< (batch x width) pre-activation
+        Matrix dW;
+        Matrix dB;
+        Matrix partial;   ///< (batch x inDim) this shard's share of dL/dIn
+    };
+
+    namespace {
+
+        /**
+         * @brief Serial C = A * B on row-major storage with leading dimensions;
+         *        the thread running it is the parallelism.
+         */
+        void multiplyInto(const double* A, size_t lda, const double* B, size_t ldb,
+            double* C, size_t ldc, size_t M, size_t N, size_t K) {
+            for (size_t r = 0; r < M; ++r) {
+                double* c = C + r * ldc;
+                std::fill(c, c + N, 0.0);
+                for (size_t k = 0; k < K; ++k) {
+                    const double a = A[r * lda + k];
+                    const double* b = B + k * ldb;
+                    for (size_t j = 0; j < N; ++j) {
+                        c[j] += a * b[j];
+                    }
+                }
+            }
+        }
+
+    }  // namespace
+
+    TensorParallelTrainer::TensorParallelTrainer(NeuralNetwork& net, const TensorParallelConfig& config)
+        : m_net(net), m_group(config.numThreads, config.pinThreads, config.firstCore) {
+        assert(net.optimizerType() != OptimizerType::LBFGS && "L-BFGS cannot step per shard");
+        const size_t L = net.numLayers();
+        const size_t T = m_group.size();
+        const size_t minWeights = std::max<size_t>(config.minShardWeights, 1);
+
+        m_shards.resize(L);
+        for (size_t i = 0; i < L; ++i) {
+            const Matrix& W = net.weights()[i];
+            size_t shards = std::max<size_t>(1, W.data().size() / minWeights);
+            m_shards[i].resize(std::min({ shards, T, W.cols() }));
+        }
+        m_outputs.resize(L);
+        m_gradients.resize(L);
+
+        // Each worker allocates (first-touches) and fills its own shards
+        m_group.run([&](size_t t) {
+            for (size_t i = 0; i < L; ++i) {
+                auto& shards = m_shards[i];
+                if (t >= shards.size()) {
+                    continue;
+                }
+                const Matrix& W = m_net.weights()[i];
+                const Matrix& b = m_net.biases()[i];
+                auto shard = std::make_unique<Shard>();
+                shard->colBegin = W.cols() * t / shards.size();
+                shard->colEnd = W.cols() * (t + 1) / shards.size();
+                const size_t width = shard->colEnd - shard->colBegin;
+                shard->ld = paddedLeadingDimension(width);
+
+                shard->weights = Matrix(W.rows(), shard->ld);
+                for (size_t r = 0; r < W.rows(); ++r) {
+                    std::copy(W.data().begin() + r * W.cols() + shard->colBegin,
+                        W.data().begin() + r * W.cols() + shard->colEnd,
+                        shard->weights.data().begin() + r * shard->ld);
+                }
+                shard->biases = Matrix(1, width);
+                std::copy(b.data().begin() + shard->colBegin, b.data().begin() + shard->colEnd,
+                    shard->biases.data().begin());
+
+                shard->optW = createOptimizer(m_net.optimizerType(), m_net.learningRate(), m_net.momentum());
+                shard->optB = createOptimizer(m_net.optimizerType(), m_net.learningRate(), m_net.momentum());
+                shard->dW = Matrix(W.rows(), shard->ld);
+                shard->dB = Matrix(1, width);
+                shards[t] = std::move(shard);
+            }
+        });
+    }
+
+    TensorParallelTrainer::~TensorParallelTrainer() {
+        syncToNetwork();
+    }
+
+    double TensorParallelTrainer::trainBatch(const Matrix& input, const Matrix& target) {
+        assert(input.rows() == target.rows() && input.rows() > 0);
+        m_group.run([&](size_t t) {
+            forwardPass(t, input);
+            backwardPass(t, input, target);
+        });
+        return m_loss;
+    }
+
+    Matrix TensorParallelTrainer::predict(const Matrix& input) {
+        m_group.run([&](size_t t) {
+            forwardPass(t, input);
+        });
+        return m_outputs.back();
+    }
+
+    void TensorParallelTrainer::syncToNetwork() {
+        for (size_t i = 0; i < m_shards.size(); ++i) {
+            Matrix& W = m_net.weights()[i];
+            Matrix& b = m_net.biases()[i];
+            for (const auto& shard : m_shards[i]) {
+                const size_t width = shard->colEnd - shard->colBegin;
+                for (size_t r = 0; r < W.rows(); ++r) {
+                    std::copy(shard->weights.data().begin() + r * shard->ld,
+                        shard->weights.data().begin() + r * shard->ld + width,
+                        W.data().begin() + r * W.cols() + shard->colBegin);
+                }
+                std::copy(shard->biases.data().begin(), shard->biases.data().end(),
+                    b.data().begin() + shard->colBegin);
+            }
+        }
+    }
+
+    size_t TensorParallelTrainer::numShards(size_t layer) const {
+        return m_shards[layer].size();
+    }
+
+    size_t TensorParallelTrainer::numThreads() const {
+        return m_group.size();
+    }
+
+    void TensorParallelTrainer::forwardPass(size_t t, const Matrix& input) {
+        const size_t rows = input.rows();
+        for (size_t i = 0; i < m_shards.size(); ++i) {
+            const Matrix& in = (i == 0) ? input : m_outputs[i - 1];
+            Matrix& out = m_outputs[i];
+            if (t == 0) {
+                out.resize(rows, m_net.weights()[i].cols());
+            }
+            m_group.barrier();
+
+            if (t < m_shards[i].size()) {
+                Shard& shard = *m_shards[i][t];
+                const size_t width = shard.colEnd - shard.colBegin;
+                shard.net.resize(rows, width);
+                multiplyInto(in.data().data(), in.cols(), shard.weights.data().data(), shard.ld,
+                    shard.net.data().data(), width, rows, width, in.cols());
+
+                withActivationTraits(m_net.activationType(i), m_net.activationPrecision(i), [&](auto traits) {
+                    using Traits = decltype(traits);
+                    for (size_t r = 0; r < rows; ++r) {
+                        double* z = shard.net.data().data() + r * width;
+                        double* y = out.data().data() + r * out.cols() + shard.colBegin;
+                        for (size_t j = 0; j < width; ++j) {
+                            z[j] += shard.biases.data()[j];
+                            y[j] = Traits::forward(z[j]);
+                        }
+                    }
+                });
+            }
+            m_group.barrier();
+        }
+    }
+
+    void TensorParallelTrainer::backwardPass(size_t t, const Matrix& input, const Matrix& target) {
+        const size_t rows = input.rows();
+        const size_t L = m_shards.size();
+        const size_t T = m_group.size();
+
+        if (t == 0) {
+            LossFunction lossFunc = getLoss(m_net.lossType());
+            m_loss = lossFunc.forward(m_outputs.back(), target);
+            m_gradients[L - 1] = lossFunc.derivative(m_outputs.back(), target);
+            for (size_t i = 0; i + 1 < L; ++i) {
+                m_gradients[i].resize(rows, m_outputs[i].cols());
+            }
+        }
+        m_group.barrier();
+
+        for (size_t i = L; i-- > 0;) {
+            const Matrix& in = (i == 0) ? input : m_outputs[i - 1];
+            const size_t inDim = in.cols();
+            const size_t numShards = m_shards[i].size();
+            // One shard writes dL/dIn directly; several leave partial sums
+            const bool reduce = (i > 0 && numShards > 1);
+
+            if (t < numShards) {
+                Shard& shard = *m_shards[i][t];
+                const size_t width = shard.colEnd - shard.colBegin;
+                const Matrix& grad = m_gradients[i];
+
+                // net becomes delta = dL/dOut * act'(net) for this slice
+                withActivationTraits(m_net.activationType(i), m_net.activationPrecision(i), [&](auto traits) {
+                    using Traits = decltype(traits);
+                    for (size_t r = 0; r < rows; ++r) {
+                        double* z = shard.net.data().data() + r * width;
+                        const double* g = grad.data().data() + r * grad.cols() + shard.colBegin;
+                        for (size_t j = 0; j < width; ++j) {
+                            z[j] = g[j] * Traits::derivative(z[j]);
+                        }
+                    }
+                });
+                const double* delta = shard.net.data().data();
+
+                std::fill(shard.dW.data().begin(), shard.dW.data().end(), 0.0);
+                std::fill(shard.dB.data().begin(), shard.dB.data().end(), 0.0);
+                for (size_t r = 0; r < rows; ++r) {
+                    const double* d = delta + r * width;
+                    const double* x = in.data().data() + r * inDim;
+                    for (size_t k = 0; k < inDim; ++k) {
+                        double* dw = shard.dW.data().data() + k * shard.ld;
+                        for (size_t j = 0; j < width; ++j) {
+                            dw[j] += x[k] * d[j];
+                        }
+                    }
+                    for (size_t j = 0; j < width; ++j) {
+                        shard.dB.data()[j] += d[j];
+                    }
+                }
+
+                // dL/dIn uses the weights before this step's update
+                if (i > 0) {
+                    double* dst;
+                    if (reduce) {
+                        shard.partial.resize(rows, inDim);
+                        dst = shard.partial.data().data();
+                    }
+                    else {
+                        dst = m_gradients[i - 1].data().data();
+                    }
+                    const double* w = shard.weights.data().data();
+                    for (size_t r = 0; r < rows; ++r) {
+                        const double* d = delta + r * width;
+                        for (size_t k = 0; k < inDim; ++k) {
+                            const double* wk = w + k * shard.ld;
+                            double sum = 0.0;
+                            for (size_t j = 0; j < width; ++j) {
+                                sum += d[j] * wk[j];
+                            }
+                            dst[r * inDim + k] = sum;
+                        }
+                    }
+                }
+
+                shard.optW->update(shard.weights, shard.dW);
+                shard.optB->update(shard.biases, shard.dB);
+            }
+
+            if (reduce) {
+                m_group.barrier();
+                // Every worker sums a band of rows over all shards
+                double* dst = m_gradients[i - 1].data().data();
+                for (size_t r = rows * t / T; r < rows * (t + 1) / T; ++r) {
+                    double* g = dst + r * inDim;
+                    std::copy(m_shards[i][0]->partial.data().begin() + r * inDim,
+                        m_shards[i][0]->partial.data().begin() + (r + 1) * inDim, g);
+                    for (size_t s = 1; s < numShards; ++s) {
+                        const double* p = m_shards[i][s]->partial.data().data() + r * inDim;
+                        for (size_t k = 0; k < inDim; ++k) {
+                            g[k] += p[k];
+                        }
+                    }
+                }
+            }
+            m_group.barrier();
+        }
+    }
+
+}  // namespace nn
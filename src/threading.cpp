@@ -0,0 +1,113 @@
+#include "../include/threading.h"
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#elif defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace nn {
+
+    size_t hardwareConcurrency() {
+        unsigned n = std::thread::hardware_concurrency();
+        return n > 0 ? n : 1;
+    }
+
+    bool pinCurrentThreadToCore(size_t core) {
+        core %= hardwareConcurrency();
+#if defined(_WIN32)
+        if (core >= sizeof(DWORD_PTR) * 8) {
+            return false;
+        }
+        DWORD_PTR mask = DWORD_PTR(1) << core;
+        return SetThreadAffinityMask(GetCurrentThread(), mask) != 0;
+#elif defined(__linux__)
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(core, &set);
+        return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+        (void)core;
+        return false;
+#endif
+    }
+
+    ThreadGroup::ThreadGroup(size_t numThreads, bool pinThreads, size_t firstCore)
+        : m_pinThreads(pinThreads), m_firstCore(firstCore) {
+        if (numThreads == 0) {
+            numThreads = hardwareConcurrency();
+        }
+        for (size_t t = 0; t < numThreads; ++t) {
+            m_threads.emplace_back(&ThreadGroup::workerMain, this, t);
+        }
+    }
+
+    ThreadGroup::~ThreadGroup() {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_startCv.notify_all();
+        for (std::thread& t : m_threads) {
+            t.join();
+        }
+    }
+
+    size_t ThreadGroup::size() const {
+        return m_threads.size();
+    }
+
+    void ThreadGroup::run(const std::function<void(size_t)>& task) {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_task = &task;
+        m_pending = m_threads.size();
+        ++m_generation;
+        m_startCv.notify_all();
+        m_doneCv.wait(lock, [this] { return m_pending == 0; });
+        m_task = nullptr;
+    }
+
+    void ThreadGroup::barrier() {
+        // Read the generation before arriving: the last arrival bumps it
+        const size_t generation = m_barrierGeneration.load(std::memory_order_acquire);
+        if (m_barrierCount.fetch_add(1, std::memory_order_acq_rel) + 1 == m_threads.size()) {
+            m_barrierCount.store(0, std::memory_order_relaxed);
+            m_barrierGeneration.fetch_add(1, std::memory_order_release);
+            return;
+        }
+        while (m_barrierGeneration.load(std::memory_order_acquire) == generation) {
+            std::this_thread::yield();
+        }
+    }
+
+    void ThreadGroup::workerMain(size_t t) {
+        if (m_pinThreads) {
+            pinCurrentThreadToCore(m_firstCore + t);
+        }
+        size_t seen = 0;
+        for (;;) {
+            const std::function<void(size_t)>* task;
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_startCv.wait(lock, [&] { return m_stop || m_generation != seen; });
+                if (m_stop) {
+                    return;
+                }
+                seen = m_generation;
+                task = m_task;
+            }
+
+            (*task)(t);
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (--m_pending == 0) {
+                m_doneCv.notify_one();
+            }
+        }
+    }
+
+}  // namespace nn
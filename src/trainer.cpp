@@ -0,0 +1,97 @@
+#include "../include/trainer.h"
+#include "../include/evaluation.h"
+
+#include <algorithm>
+#include <cassert>
+#include <limits>
+
+namespace nn {
+
+    Trainer::Trainer(const TrainerConfig& config,
+        std::unique_ptr<LearningRateSchedule> schedule)
+        : m_config(config), m_schedule(std::move(schedule)) {
+        m_config.evalInterval = std::max<size_t>(m_config.evalInterval, 1);
+    }
+
+    void Trainer::setEvaluationCallback(std::function<void(const TrainingProgress&)> callback) {
+        m_callback = std::move(callback);
+    }
+
+    TrainingResult Trainer::fit(NeuralNetwork& net, const Dataset& train,
+        const Dataset* validation) {
+        assert(train.inputs.size() == train.targets.size());
+        const Dataset& monitored = (validation && !validation->empty()) ? *validation : train;
+        const double baseRate = net.learningRate();
+
+        TrainingResult result;
+        double bestLoss = std::numeric_limits<double>::infinity();
+        size_t evalsWithoutImprovement = 0;
+
+        // L-BFGS needs the same full-batch objective every step: one stacked
+        // batch, one iteration per epoch
+        const bool fullBatch = net.optimizerType() == OptimizerType::LBFGS && !train.empty();
+        Matrix batchInputs, batchTargets;
+        if (fullBatch) {
+            batchInputs = stackSamples(train.inputs);
+            batchTargets = stackSamples(train.targets);
+        }
+
+        for (size_t epoch = 0; epoch < m_config.maxEpochs; ++epoch) {
+            double rate = m_schedule ? m_schedule->rate(epoch, baseRate) : baseRate;
+            net.setLearningRate(rate);
+
+            double totalLoss = 0.0;
+            if (fullBatch) {
+                // Already the mean over the batch
+                totalLoss = net.trainSample(batchInputs, batchTargets) * static_cast<double>(train.size());
+            }
+            else {
+                for (size_t i = 0; i < train.size(); ++i) {
+                    totalLoss += net.trainSample(train.inputs[i], train.targets[i]);
+                }
+            }
+
+            TrainingProgress& progress = result.progress;
+            progress.epoch = epoch + 1;
+            progress.trainLoss = totalLoss / static_cast<double>(std::max<size_t>(train.size(), 1));
+            progress.learningRate = rate;
+
+            bool lastEpoch = (epoch + 1 == m_config.maxEpochs);
+            if ((epoch + 1) % m_config.evalInterval != 0 && !lastEpoch) {
+                continue;
+            }
+
+            EvaluationResult eval = evaluate(net, monitored);
+            progress.monitoredLoss = eval.loss;
+            progress.accuracy = eval.accuracy;
+            if (m_schedule) {
+                m_schedule->observe(progress.monitoredLoss);
+            }
+            if (m_callback) {
+                m_callback(progress);
+            }
+
+            if (m_config.targetLoss >= 0.0 && progress.monitoredLoss <= m_config.targetLoss) {
+                result.reason = StopReason::TargetLoss;
+                break;
+            }
+            if (m_config.targetAccuracy >= 0.0 && progress.accuracy >= m_config.targetAccuracy) {
+                result.reason = StopReason::TargetAccuracy;
+                break;
+            }
+            if (progress.monitoredLoss < bestLoss - m_config.minDelta) {
+                bestLoss = progress.monitoredLoss;
+                evalsWithoutImprovement = 0;
+            }
+            else if (m_config.patience > 0 && ++evalsWithoutImprovement >= m_config.patience) {
+                result.reason = StopReason::Stalled;
+                break;
+            }
+        }
+
+        // Leave the network at its configured rate for later training
+        net.setLearningRate(baseRate);
+        return result;
+    }
+
+}  // namespace nn
@@ -0,0 +1,68 @@
+#ifndef MY_NEURAL_NET_TESTS_GRADIENT_CHECK_H_
+#define MY_NEURAL_NET_TESTS_GRADIENT_CHECK_H_
+
+#include <cassert>
+#include <cmath>
+#include <vector>
+#include "../include/layer_graph.h"
+
+/**
+ * @file gradient_check.h
+ * @brief Finite-difference check of LayerGraph backprop, shared by the layer tests.
+ */
+
+namespace test_gradient_check {
+
+    using namespace nn;
+
+    /**
+     * @brief Mean squared-error loss (0.5 * diff^2 per row) of graph on (x, t).
+     */
+    inline double batchLoss(LayerGraph& graph, const Matrix& x, const Matrix& t) {
+        const Matrix& y = graph.forward(x);
+        double sum = 0.0;
+        for (size_t e = 0; e < y.data().size(); ++e) {
+            double diff = y.data()[e] - t.data()[e];
+            sum += 0.5 * diff * diff;
+        }
+        return sum / static_cast<double>(y.rows());
+    }
+
+    /**
+     * @brief Probes every entry of params with central differences, then runs
+     *        one trainBatch and asserts the step matches them.
+     * @param graph MSE graph trained with SGD at learning rate lr
+     * @param params Parameter matrices inside graph (restored after each probe)
+     * @param lr The graph's learning rate: SGD moves w by -lr * g
+     */
+    inline void checkParameterGradients(LayerGraph& graph, const Matrix& x, const Matrix& t,
+        const std::vector<Matrix*>& params, double lr) {
+        const double eps = 1e-6;
+        std::vector<double> numeric, before;
+        for (Matrix* m : params) {
+            for (double& p : m->data()) {
+                double saved = p;
+                p = saved + eps;
+                double up = batchLoss(graph, x, t);
+                p = saved - eps;
+                double down = batchLoss(graph, x, t);
+                p = saved;
+                numeric.push_back((up - down) / (2.0 * eps));
+                before.push_back(p);
+            }
+        }
+
+        graph.trainBatch(x, t);
+        size_t i = 0;
+        for (Matrix* m : params) {
+            for (double p : m->data()) {
+                double analytic = (before[i] - p) / lr;
+                assert(std::abs(analytic - numeric[i]) < 1e-6 * (1.0 + std::abs(numeric[i])));
+                ++i;
+            }
+        }
+    }
+
+}  // namespace test_gradient_check
+
+#endif  // MY_NEURAL_NET_TESTS_GRADIENT_CHECK_H_
@@ -0,0 +1,118 @@
+/**
+ * @file test_activation.h
+ * @brief Error bounds and speed of the fast approximate activations.
+ */
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <vector>
+#include "../include/activation.h"
+#include "../include/neural_network.h"
+
+namespace test_activation {
+
+    using namespace nn;
+
+    static double relativeError(double approx, long double exact) {
+        return static_cast<double>(std::fabs((approx - exact) / exact));
+    }
+
+    /**
+     * @brief Forward and derivative of fast Sigmoid and Tanh stay within the
+     *        documented 1e-7 relative error, tails included.
+     */
+    static void testErrorBound() {
+        double worst = 0.0;
+        for (double x = -350.0; x <= 350.0; x += 1.0 / 1024.0) {
+            const long double xl = x;
+            const long double es = std::exp(-std::fabs(xl));
+            const long double sig = 1.0L / (1.0L + std::exp(-xl));
+            const long double sigD = es / ((1.0L + es) * (1.0L + es));
+            const long double et = std::exp(-2.0L * std::fabs(xl));
+            const long double tanhD = 4.0L * et / ((1.0L + et) * (1.0L + et));
+
+            worst = std::max(worst, relativeError(FastActivationTraits<ActivationType::Sigmoid>::forward(x), sig));
+            worst = std::max(worst, relativeError(FastActivationTraits<ActivationType::Sigmoid>::derivative(x), sigD));
+            worst = std::max(worst, relativeError(FastActivationTraits<ActivationType::Tanh>::derivative(x), tanhD));
+            if (x != 0.0) {
+                worst = std::max(worst, relativeError(FastActivationTraits<ActivationType::Tanh>::forward(x), std::tanh(xl)));
+            }
+        }
+        assert(worst < 1e-7);
+
+        // Tiny inputs keep relative accuracy (no cancellation in expm1)
+        for (double x : { 1e-300, -1e-12, 3e-8 }) {
+            assert(relativeError(FastActivationTraits<ActivationType::Tanh>::forward(x), std::tanh(static_cast<long double>(x))) < 1e-7);
+        }
+        assert(FastActivationTraits<ActivationType::Tanh>::forward(0.0) == 0.0);
+        assert(FastActivationTraits<ActivationType::Tanh>::forward(1e4) == 1.0);
+        assert(FastActivationTraits<ActivationType::Sigmoid>::forward(-1e4) >= 0.0);
+    }
+
+    /**
+     * @brief A network switched to fast activations predicts the same to
+     *        within the bound (amplified only by the layer weights).
+     */
+    static void testNetworkPrecision() {
+        NeuralNetwork net({ 8, 32, 32, 4 },
+            { ActivationType::Tanh, ActivationType::ReLU, ActivationType::Sigmoid },
+            LossType::MSE, OptimizerType::SGD);
+        Matrix x(16, 8, true);
+        Matrix exact = net.predict(x);
+        for (size_t i = 0; i < net.numLayers(); ++i) {
+            net.setActivationPrecision(i, ActivationPrecision::Fast);
+            assert(net.activationPrecision(i) == ActivationPrecision::Fast);
+        }
+        Matrix fast = net.predict(x);
+        for (size_t e = 0; e < exact.data().size(); ++e) {
+            assert(std::abs(exact.data()[e] - fast.data()[e]) < 1e-6);
+        }
+    }
+
+    template <typename Traits>
+    static double timeForward(const std::vector<double>& xs, double& sink) {
+        auto start = std::chrono::steady_clock::now();
+        double sum = 0.0;
+        for (int rep = 0; rep < 20; ++rep) {
+            const double shift = 1e-3 * rep;
+            for (size_t i = 0; i < xs.size(); ++i) {
+                sum += Traits::forward(xs[i] + shift);
+            }
+        }
+        sink += sum;
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    /**
+     * @brief Prints exact vs fast throughput (informational, not asserted).
+     */
+    static void benchmarkActivations() {
+        std::vector<double> xs(1 << 16);
+        double sink = 0.0;
+        for (size_t i = 0; i < xs.size(); ++i) {
+            xs[i] = -8.0 + 16.0 * static_cast<double>(i) / static_cast<double>(xs.size());
+        }
+        double exactTanh = timeForward<ActivationTraits<ActivationType::Tanh>>(xs, sink);
+        double fastTanh = timeForward<FastActivationTraits<ActivationType::Tanh>>(xs, sink);
+        double exactSig = timeForward<ActivationTraits<ActivationType::Sigmoid>>(xs, sink);
+        double fastSig = timeForward<FastActivationTraits<ActivationType::Sigmoid>>(xs, sink);
+        std::cout << "[test_activation] tanh speedup " << exactTanh / fastTanh
+            << "x, sigmoid speedup " << exactSig / fastSig << "x\n";
+        assert(std::isfinite(sink));
+    }
+
+    /**
+     * @brief Runs all activation tests.
+     */
+    void runAllActivationTests() {
+        std::cout << "[test_activation] Running tests...\n";
+        testErrorBound();
+        testNetworkPrecision();
+        benchmarkActivations();
+        std::cout << "[test_activation] All tests passed!\n";
+    }
+
+}  // namespace test_activation
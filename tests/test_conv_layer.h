@@ -0,0 +1,96 @@
+/**
+ * @file test_conv_layer.h
+ * @brief Tests for the im2col-based 2-D convolution layer.
+ */
+
+#include <cassert>
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <vector>
+#include "../include/conv_layer.h"
+#include "../include/layer_graph.h"
+#include "gradient_check.h"
+
+namespace test_conv_layer {
+
+    using namespace nn;
+
+    /**
+     * @brief Forward matches a direct convolution, whatever the im2col tile size.
+     */
+    static void testForwardMatchesDirectConvolution() {
+        const size_t C = 2, H = 5, W = 6, F = 3, K = 3, S = 2, P = 1;
+        Conv2DLayer tiled(C, H, W, F, K, S, P, ActivationType::Tanh, 1, 7);    // 1 pixel per tile
+        Conv2DLayer whole(C, H, W, F, K, S, P, ActivationType::Tanh, 1 << 20, 7);
+        assert(tiled.tilePixels() == 1);
+        assert(whole.tilePixels() == tiled.outHeight() * tiled.outWidth());
+
+        const size_t outH = tiled.outHeight(), outW = tiled.outWidth();
+        assert(outH == 3 && outW == 3);
+        const size_t outSize = F * outH * outW;
+
+        Matrix x(2, C * H * W, true);
+        Matrix yTiled(2, outSize), yWhole(2, outSize);
+        Matrix net(2, outSize);
+        tiled.forward({ &x }, yTiled, { &net }, false);
+        whole.forward({ &x }, yWhole, { &net }, false);
+
+        const Matrix& w = tiled.weights();
+        for (size_t s = 0; s < 2; ++s) {
+            for (size_t f = 0; f < F; ++f) {
+                for (size_t oy = 0; oy < outH; ++oy) {
+                    for (size_t ox = 0; ox < outW; ++ox) {
+                        double sum = tiled.biases()(0, f);
+                        for (size_t c = 0; c < C; ++c) {
+                            for (size_t ky = 0; ky < K; ++ky) {
+                                for (size_t kx = 0; kx < K; ++kx) {
+                                    long iy = long(oy * S + ky) - long(P);
+                                    long ix = long(ox * S + kx) - long(P);
+                                    if (iy < 0 || ix < 0 || iy >= long(H) || ix >= long(W)) {
+                                        continue;
+                                    }
+                                    sum += w(f, (c * K + ky) * K + kx) * x(s, (c * H + iy) * W + ix);
+                                }
+                            }
+                        }
+                        size_t e = (f * outH + oy) * outW + ox;
+                        assert(std::abs(yTiled(s, e) - std::tanh(sum)) < 1e-12);
+                        assert(std::abs(yWhole(s, e) - yTiled(s, e)) < 1e-12);
+                    }
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief Weight and input gradients (through a Dense layer in front)
+     *        match central finite differences.
+     */
+    static void testGradientsMatchFiniteDifferences() {
+        const double lr = 1e-3;
+        const size_t C = 2, H = 4, W = 4;
+        LayerGraph graph(3, LossType::MSE, OptimizerType::SGD, lr);
+        size_t front = graph.add(std::make_unique<DenseLayer>(3, C * H * W, ActivationType::Tanh, 1));
+        size_t conv = graph.add(std::make_unique<Conv2DLayer>(C, H, W, 3, 3, 1, 1,
+            ActivationType::Tanh, 5 * C * 9 * sizeof(double), 2));  // 5-pixel tiles
+        graph.add(std::make_unique<DenseLayer>(graph.outputWidth(conv), 2, ActivationType::Sigmoid, 3));
+
+        Matrix x(3, 3, true);
+        Matrix t(3, 2, true);
+        Matrix& wFront = static_cast<DenseLayer&>(graph.layer(front)).weights();
+        Matrix& wConv = static_cast<Conv2DLayer&>(graph.layer(conv)).weights();
+        test_gradient_check::checkParameterGradients(graph, x, t, { &wFront, &wConv }, lr);
+    }
+
+    /**
+     * @brief Runs all convolution layer tests.
+     */
+    void runAllConvLayerTests() {
+        std::cout << "[test_conv_layer] Running tests...\n";
+        testForwardMatchesDirectConvolution();
+        testGradientsMatchFiniteDifferences();
+        std::cout << "[test_conv_layer] All tests passed!\n";
+    }
+
+}  // namespace test_conv_layer
@@ -0,0 +1,307 @@
+/**
+ * @file test_data_parallel.h
+ * @brief Tests for the socket ring all-reduce, gradient compression and
+ *        data-parallel training.
+ */
+
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../include/data_parallel.h"
+#include "../include/distributed.h"
+
+namespace test_data_parallel {
+
+    using namespace nn;
+
+    /// argv[1] of the processes testLauncher starts
+    static const char* const kWorkerFlag = "--data-parallel-worker";
+
+    /**
+     * @brief Fresh ports per ring so repeated runs do not collide. Kept below
+     *        the usual ephemeral range (32768+), where a connect to a port
+     *        nobody listens on yet can pick that same port and self-connect.
+     */
+    static uint16_t nextBasePort() {
+        static uint16_t port = static_cast<uint16_t>(20000 + std::random_device()() % 12000);
+        port = static_cast<uint16_t>(port + 8);
+        return port;
+    }
+
+    /**
+     * @brief Runs body(comm) on worldSize connected ranks, one thread each.
+     */
+    static void runRing(size_t worldSize, DistributedConfig config,
+        const std::function<void(RingCommunicator&)>& body) {
+        config.worldSize = worldSize;
+        config.basePort = nextBasePort();
+        std::vector<std::thread> ranks;
+        for (size_t r = 0; r < worldSize; ++r) {
+            ranks.emplace_back([=, &body] {
+                DistributedConfig mine = config;
+                mine.rank = r;
+                RingCommunicator comm(mine);
+                bool connected = comm.connect();
+                assert(connected);
+                (void)connected;
+                body(comm);
+            });
+        }
+        for (auto& t : ranks) {
+            t.join();
+        }
+    }
+
+    /**
+     * @brief Half conversion rounds to nearest, saturates and keeps subnormals.
+     */
+    static void testHalf() {
+        assert(toHalf(1.0) == 0x3C00 && fromHalf(0x3C00) == 1.0);
+        assert(fromHalf(toHalf(-2.5)) == -2.5);
+        assert(fromHalf(toHalf(1e9)) == 65504.0);
+        assert(fromHalf(toHalf(0x1p-24)) == 0x1p-24);
+        assert(fromHalf(toHalf(1.0 + 0x1p-11)) == 1.0);   // Tie to even
+        for (double x = 1e-4; x < 6e4; x *= 1.37) {
+            assert(std::abs(fromHalf(toHalf(x)) - x) <= x * 0x1p-11);
+        }
+    }
+
+    /**
+     * @brief Sums are exact without compression, close with fp16, and every
+     *        rank ends with the same values, for sizes that do not split evenly.
+     */
+    static void testAllReduce() {
+        for (GradientCompression compression : { GradientCompression::None, GradientCompression::Fp16 }) {
+            for (size_t count : { size_t(1003), size_t(2) }) {
+                std::vector<std::vector<double>> results(3);
+                std::vector<uint64_t> bytes(3);
+                DistributedConfig config;
+                config.compression = compression;
+#if !defined(_WIN32)
+                config.transport = Transport::UnixDomain;
+#endif
+                runRing(3, config, [&](RingCommunicator& comm) {
+                    std::vector<double> data(count);
+                    for (size_t i = 0; i < count; ++i) {
+                        data[i] = static_cast<double>((comm.rank() + 1) * i) * 0.25;
+                    }
+                    bool ok = comm.allReduce(data.data(), count);
+                    assert(ok);
+                    (void)ok;
+                    results[comm.rank()] = data;
+                    bytes[comm.rank()] = comm.bytesSent();
+                });
+                for (size_t i = 0; i < count; ++i) {
+                    const double expected = 6.0 * static_cast<double>(i) * 0.25;
+                    if (compression == GradientCompression::None) {
+                        assert(results[0][i] == expected);
+                    }
+                    else {
+                        assert(std::abs(results[0][i] - expected) <= 2e-3 * expected + 1e-12);
+                    }
+                    assert(results[1][i] == results[0][i] && results[2][i] == results[0][i]);
+                }
+                const size_t wordBytes = compression == GradientCompression::None ? 8 : 2;
+                if (count == 1003) {
+                    // 2 (N - 1) / N of the buffer, whatever N
+                    assert(bytes[0] <= 2 * 2 * 335 * wordBytes);
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief Top-k sends a fraction of the bytes, and error feedback makes
+     *        the running total of what was applied track the true total.
+     */
+    static void testTopK() {
+        const size_t count = 400;
+        const int rounds = 200;
+        DistributedConfig config;
+        config.compression = GradientCompression::TopK;
+        config.topKFraction = 0.05;
+        std::vector<std::vector<double>> totals(2, std::vector<double>(count, 0.0));
+        std::vector<uint64_t> bytes(2);
+        runRing(2, config, [&](RingCommunicator& comm) {
+            for (int round = 0; round < rounds; ++round) {
+                std::vector<double> g(count);
+                for (size_t i = 0; i < count; ++i) {
+                    g[i] = std::sin(static_cast<double>(i * (comm.rank() + 1)));
+                }
+                bool ok = comm.allReduce(g.data(), count, 7);
+                assert(ok);
+                (void)ok;
+                for (size_t i = 0; i < count; ++i) {
+                    totals[comm.rank()][i] += g[i];
+                }
+            }
+            bytes[comm.rank()] = comm.bytesSent();
+        });
+        assert(totals[0] == totals[1]);
+        double worst = 0.0;
+        for (size_t i = 0; i < count; ++i) {
+            const double truth = rounds * (std::sin(static_cast<double>(i)) + std::sin(static_cast<double>(2 * i)));
+            worst = std::max(worst, std::abs(totals[0][i] - truth));
+        }
+        // Without feedback most coordinates would never be sent (error ~ rounds)
+        assert(worst < 0.25 * rounds);
+        assert(bytes[0] < rounds * count * sizeof(double) / 4);
+    }
+
+    /**
+     * @brief Three ranks on thirds of a batch take the same step as one
+     *        network on the whole batch, with and without overlap.
+     */
+    static void testTrainerMatchesSingleProcess() {
+        const size_t rows = 12;
+        Matrix input(rows, 5, true);
+        Matrix target(rows, 2, true);
+
+        for (bool overlap : { true, false }) {
+            NeuralNetwork reference({ 5, 16, 8, 2 },
+                { ActivationType::Tanh, ActivationType::ReLU, ActivationType::Sigmoid },
+                LossType::MSE, OptimizerType::Momentum, 0.1);
+            std::vector<std::vector<Matrix>> replicaWeights(3);
+
+            // Replicas start from reference's weights via the rank-0 broadcast
+            const std::vector<Matrix> initial = reference.weights();
+            const std::vector<Matrix> initialBiases = reference.biases();
+            runRing(3, DistributedConfig(), [&](RingCommunicator& comm) {
+                NeuralNetwork replica({ 5, 16, 8, 2 },
+                    { ActivationType::Tanh, ActivationType::ReLU, ActivationType::Sigmoid },
+                    LossType::MSE, OptimizerType::Momentum, 0.1);
+                if (comm.rank() == 0) {
+                    replica.weights() = initial;
+                    replica.biases() = initialBiases;
+                }
+                DataParallelTrainer trainer(replica, comm, overlap);
+                const size_t r = comm.rank();
+                Matrix in(rows / 3, 5), out(rows / 3, 2);
+                std::copy(input.data().begin() + r * 4 * 5, input.data().begin() + (r + 1) * 4 * 5, in.data().begin());
+                std::copy(target.data().begin() + r * 4 * 2, target.data().begin() + (r + 1) * 4 * 2, out.data().begin());
+                for (int step = 0; step < 3; ++step) {
+                    trainer.trainBatch(in, out);
+                }
+                assert(trainer.healthy());
+                replicaWeights[r] = replica.weights();
+            });
+
+            for (int step = 0; step < 3; ++step) {
+                std::vector<Matrix> dW, dB;
+                reference.computeGradients(input, target, dW, dB);
+                for (size_t i = 0; i < reference.numLayers(); ++i) {
+                    reference.applyLayerGradients(i, dW[i], dB[i]);
+                }
+            }
+            for (size_t r = 0; r < 3; ++r) {
+                for (size_t i = 0; i < reference.numLayers(); ++i) {
+                    for (size_t e = 0; e < reference.weights()[i].data().size(); ++e) {
+                        assert(std::abs(replicaWeights[r][i].data()[e] - reference.weights()[i].data()[e]) < 1e-12);
+                    }
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief When a rank drops out mid-step, the others apply nothing from
+     *        their partly reduced buckets and report the failure.
+     */
+    static void testFailedStepLeavesParameters() {
+        for (bool overlap : { true, false }) {
+            runRing(3, DistributedConfig(), [&](RingCommunicator& comm) {
+                NeuralNetwork replica({ 5, 16, 8, 2 },
+                    { ActivationType::Tanh, ActivationType::ReLU, ActivationType::Sigmoid },
+                    LossType::MSE, OptimizerType::Momentum, 0.1);
+                DataParallelTrainer trainer(replica, comm, overlap);
+                if (comm.rank() == 2) {
+                    // Let the others get into their all-reduce first
+                    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+                    comm.close();
+                    return;
+                }
+                const std::vector<Matrix> weights = replica.weights();
+                const std::vector<Matrix> biases = replica.biases();
+                Matrix in(4, 5, true), out(4, 2, true);
+                trainer.trainBatch(in, out);
+                assert(!trainer.healthy());
+                for (size_t i = 0; i < replica.numLayers(); ++i) {
+                    assert(replica.weights()[i].data() == weights[i].data());
+                    assert(replica.biases()[i].data() == biases[i].data());
+                }
+            });
+        }
+    }
+
+    /**
+     * @brief Worker side of testLauncher: sums rank + 1 over the ring.
+     */
+    static int runWorker(const DistributedConfig& config) {
+        RingCommunicator comm(config);
+        if (!comm.connect()) {
+            return 2;
+        }
+        std::vector<double> data(100, static_cast<double>(config.rank + 1));
+        if (!comm.allReduce(data.data(), data.size())) {
+            return 3;
+        }
+        const double expected = static_cast<double>(config.worldSize * (config.worldSize + 1) / 2);
+        return data[0] == expected && data[99] == expected ? 0 : 1;
+    }
+
+    /**
+     * @brief Spawns this executable as four local worker processes. Its main
+     *        must call runWorkerIfLaunched first.
+     */
+    static void testLauncher() {
+        const std::string self = currentExecutablePath();
+        if (self.empty()) {
+            return;
+        }
+        DistributedConfig config;
+        config.worldSize = 4;
+        config.basePort = nextBasePort();
+        assert(launchLocalWorkers(self, { kWorkerFlag }, config) == 0);
+    }
+
+    /**
+     * @brief Call at the top of the test runner's main: a process started by
+     *        testLauncher runs only its worker side and exits, without
+     *        rerunning any suite.
+     */
+    void runWorkerIfLaunched(int argc, char* argv[]) {
+        if (argc < 2 || std::string(argv[1]) != kWorkerFlag) {
+            return;
+        }
+        DistributedConfig worker;
+        std::exit(DistributedConfig::fromEnvironment(worker) ? runWorker(worker) : 4);
+    }
+
+    /**
+     * @brief Runs all data-parallel tests.
+     */
+    void runAllDataParallelTests() {
+        // A launched worker whose main skipped runWorkerIfLaunched must not
+        // go on to launch workers of its own
+        DistributedConfig worker;
+        if (DistributedConfig::fromEnvironment(worker)) {
+            std::exit(5);
+        }
+        std::cout << "[test_data_parallel] Running tests...\n";
+        testHalf();
+        testAllReduce();
+        testTopK();
+        testTrainerMatchesSingleProcess();
+        testFailedStepLeavesParameters();
+        testLauncher();
+        std::cout << "[test_data_parallel] All tests passed!\n";
+    }
+
+}  // namespace test_data_parallel
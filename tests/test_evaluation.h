@@ -0,0 +1,126 @@
+/**
+ * @file test_evaluation.h
+ * @brief Tests for batched dataset evaluation and its metrics.
+ */
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <iostream>
+#include <vector>
+#include "../include/evaluation.h"
+#include "../include/loss.h"
+
+namespace test_evaluation {
+
+    using namespace nn;
+
+    /**
+     * @brief 1 -> 1 sigmoid net with w = 1, b = 0 scores each sample by its
+     *        input, so AUC, accuracy and the confusion matrix are known.
+     */
+    static void testBinaryMetrics() {
+        NeuralNetwork net({ 1, 1 }, { ActivationType::Sigmoid }, LossType::CrossEntropy, OptimizerType::SGD);
+        net.weights()[0](0, 0) = 1.0;
+        net.biases()[0](0, 0) = 0.0;
+
+        // Positives at inputs 3, 1, -1; negatives at 2, -2, -3 (and a tie at 1)
+        const double xs[] = { 3.0, 1.0, -1.0, 2.0, -2.0, -3.0, 1.0 };
+        const double ys[] = { 1.0, 1.0, 1.0, 0.0, 0.0, 0.0, 0.0 };
+        Dataset data;
+        for (size_t i = 0; i < 7; ++i) {
+            data.inputs.emplace_back(1, 1);
+            data.inputs.back()(0, 0) = xs[i];
+            data.targets.emplace_back(1, 1);
+            data.targets.back()(0, 0) = ys[i];
+        }
+
+        EvaluationResult r = evaluate(net, data,
+            { Metric::Loss, Metric::Accuracy, Metric::AUC, Metric::ConfusionMatrix }, 3);
+        assert(r.samples == 7 && r.numClasses == 2);
+
+        // Pairs (pos, neg) won: 3 beats all 4, 1 beats two and ties one, -1 beats two
+        assert(std::abs(r.auc - (4.0 + 2.5 + 2.0) / 12.0) < 1e-12);
+        // Predicted 1 for inputs >= 0: 3, 1, 2, 1
+        assert(r.confusionCount(1, 1) == 2 && r.confusionCount(1, 0) == 1);
+        assert(r.confusionCount(0, 1) == 2 && r.confusionCount(0, 0) == 2);
+        assert(std::abs(r.accuracy - 4.0 / 7.0) < 1e-12);
+
+        double expectedLoss = 0.0;
+        LossFunction lossFunc = getLoss(LossType::CrossEntropy);
+        for (size_t i = 0; i < data.size(); ++i) {
+            expectedLoss += lossFunc.forward(net.predict(data.inputs[i]), data.targets[i]);
+        }
+        assert(std::abs(r.loss - expectedLoss / 7.0) < 1e-12);
+    }
+
+    /**
+     * @brief Multi-class results do not depend on the batch size, and
+     *        unrequested metrics stay unset.
+     */
+    static void testBatchInvariance() {
+        NeuralNetwork net({ 4, 8, 3 }, { ActivationType::Tanh, ActivationType::Sigmoid },
+            LossType::MSE, OptimizerType::SGD);
+        Dataset data;
+        for (size_t i = 0; i < 203; ++i) {
+            data.inputs.emplace_back(1, 4, true);
+            data.targets.emplace_back(1, 3);
+            data.targets.back()(0, i % 3) = 1.0;
+        }
+
+        std::vector<Metric> all = { Metric::Loss, Metric::Accuracy, Metric::AUC, Metric::ConfusionMatrix };
+        EvaluationResult one = evaluate(net, data, all, 1);
+        EvaluationResult some = evaluate(net, data, all, 17);
+        EvaluationResult whole = evaluate(net, data, all, 1000);
+        for (const EvaluationResult* r : { &some, &whole }) {
+            assert(std::abs(r->loss - one.loss) < 1e-12);
+            assert(r->accuracy == one.accuracy);
+            assert(r->auc == one.auc);
+            assert(r->confusion == one.confusion);
+        }
+
+        size_t total = 0, diagonal = 0;
+        for (size_t a = 0; a < 3; ++a) {
+            for (size_t p = 0; p < 3; ++p) {
+                total += one.confusionCount(a, p);
+                diagonal += (a == p) ? one.confusionCount(a, p) : 0;
+            }
+        }
+        assert(total == 203);
+        assert(std::abs(one.accuracy - diagonal / 203.0) < 1e-12);
+        assert(one.auc >= 0.0 && one.auc <= 1.0);
+
+        EvaluationResult lossOnly = evaluate(net, data, { Metric::Loss });
+        assert(lossOnly.accuracy == 0.0 && lossOnly.confusion.empty());
+        assert(std::abs(lossOnly.loss - one.loss) < 1e-12);
+    }
+
+    /**
+     * @brief stackSamples puts sample i in row i.
+     */
+    static void testStackSamples() {
+        std::vector<Matrix> rows;
+        for (int i = 0; i < 300; ++i) {
+            rows.push_back(Matrix(1, 3, true));
+        }
+        Matrix stacked = stackSamples(rows);
+        assert(stacked.rows() == 300 && stacked.cols() == 3);
+        for (size_t i = 0; i < rows.size(); ++i) {
+            for (size_t c = 0; c < 3; ++c) {
+                assert(stacked(i, c) == rows[i](0, c));
+            }
+        }
+    }
+
+    /**
+     * @brief Runs all evaluation tests.
+     */
+    void runAllEvaluationTests() {
+        std::cout << "[test_evaluation] Running tests...\n";
+        testBinaryMetrics();
+        testBatchInvariance();
+        testStackSamples();
+        std::cout << "[test_evaluation] All tests passed!\n";
+    }
+
+}  // namespace test_evaluation
@@ -0,0 +1,107 @@
+/**
+ * @file test_execution_backend.h
+ * @brief Tests for parallelFor backends and NUMA placement.
+ */
+
+#include <atomic>
+#include <cassert>
+#include <cmath>
+#include <iostream>
+#include <vector>
+#include "../include/execution_backend.h"
+#include "../include/matrix.h"
+#include "../include/random.h"
+
+namespace test_execution_backend {
+
+    using namespace nn;
+
+    /**
+     * @brief Every index is visited exactly once, including by nested loops.
+     */
+    static void checkCoverage() {
+        const size_t count = 10007;
+        std::vector<std::atomic<int>> hits(count);
+        parallelFor(count, 64, [&](size_t begin, size_t end) {
+            assert(begin < end);
+            for (size_t i = begin; i < end; ++i) {
+                hits[i]++;
+            }
+            // Nested loops run serially on the calling worker
+            std::atomic<size_t> inner{ 0 };
+            parallelFor(100, 1, [&](size_t b, size_t e) { inner += e - b; });
+            assert(inner == 100);
+        });
+        for (auto& h : hits) {
+            assert(h == 1);
+        }
+    }
+
+    static void checkMultiply() {
+        Matrix A(37, 53, true);
+        Matrix B(53, 29, true);
+        Matrix C = Matrix::multiply(A, B);
+        for (size_t i = 0; i < A.rows(); ++i) {
+            for (size_t j = 0; j < B.cols(); ++j) {
+                double sum = 0.0;
+                for (size_t k = 0; k < A.cols(); ++k) {
+                    sum += A(i, k) * B(k, j);
+                }
+                assert(C(i, j) == sum);
+            }
+        }
+    }
+
+    static void testBackends() {
+        checkCoverage();
+        checkMultiply();
+        Matrix stlFill(300, 301);   // Many fill chunks
+        fillUniform(stlFill, 7, 3, -1.0, 1.0);
+
+        ExecutionConfig config;
+        config.backend = ExecutionBackend::PinnedThreads;
+        config.numThreads = 4;
+        setExecutionConfig(config);
+        assert(executionConfig().backend == ExecutionBackend::PinnedThreads);
+        checkCoverage();
+        checkMultiply();
+        Matrix pinnedFill(300, 301);
+        fillUniform(pinnedFill, 7, 3, -1.0, 1.0);
+        assert(pinnedFill.data() == stlFill.data());
+
+        setExecutionConfig(ExecutionConfig());
+        assert(executionConfig().backend == ExecutionBackend::ParallelStl);
+    }
+
+    static void testPlacement() {
+        const size_t nodes = numaNodeCount();
+        assert(nodes >= 1);
+        assert(numaNodeOfCore(0) < nodes);
+
+        // Smaller than a page: nothing to place
+        Matrix tiny(2, 2);
+        assert(!placeMatrix(tiny, TensorRole::Weights));
+
+        Matrix big(512, 512);
+        bool placed = placeMemory(big.data().data(), big.data().size() * sizeof(double),
+            NumaPolicy::Interleave);
+        if (nodes == 1) {
+            assert(!placed);
+        }
+        // Placement never changes contents
+        big(3, 4) = 1.5;
+        placeMemory(big.data().data(), big.data().size() * sizeof(double), NumaPolicy::Bind);
+        assert(big(3, 4) == 1.5);
+    }
+
+    /**
+     * @brief Runs all execution backend tests.
+     */
+    void runAllExecutionBackendTests() {
+        std::cout << "[test_execution_backend] Running tests...\n";
+        testBackends();
+        testPlacement();
+        std::cout << "[test_execution_backend] All tests passed!\n";
+    }
+
+}  // namespace test_execution_backend
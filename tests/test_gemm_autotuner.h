@@ -0,0 +1,148 @@
+/**
+ * @file test_gemm_autotuner.h
+ * @brief Tests for the GEMM autotuner: plan equivalence, tuning and the cache file.
+ */
+
+#include <cassert>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <vector>
+#include "../include/gemm_autotuner.h"
+#include "../include/matrix.h"
+#include "../include/neural_network.h"
+
+namespace test_gemm_autotuner {
+
+    using namespace nn;
+
+    /**
+     * @brief Plain triple loop with the same k order as every kernel.
+     */
+    static Matrix referenceMultiply(const Matrix& A, const Matrix& B) {
+        Matrix C(A.rows(), B.cols());
+        for (size_t i = 0; i < A.rows(); ++i) {
+            for (size_t k = 0; k < A.cols(); ++k) {
+                for (size_t j = 0; j < B.cols(); ++j) {
+                    C(i, j) += A(i, k) * B(k, j);
+                }
+            }
+        }
+        return C;
+    }
+
+    /**
+     * @brief Every candidate plan gives bit-identical results, including
+     *        shapes that do not divide into tiles or bands.
+     */
+    static void testCandidatesAgree() {
+        const size_t shapes[][3] = { { 1, 16, 16 }, { 37, 53, 29 }, { 128, 96, 300 }, { 5, 700, 3 }, { 4, 4, 0 } };
+        for (const auto& shape : shapes) {
+            const size_t M = shape[0], N = shape[1], K = shape[2];
+            Matrix A(M, K, true), B(K, N, true);
+            const Matrix expected = referenceMultiply(A, B);
+            const std::vector<GemmPlan> candidates = gemmCandidates(M, N, K);
+            assert(candidates.front().kernel == GemmKernel::RowStream && candidates.front().tasks == 0);
+            for (const GemmPlan& plan : candidates) {
+                Matrix C(M, N);
+                C.data().assign(C.data().size(), 42.0);   // Kernels must overwrite
+                runGemm(plan, A.data().data(), B.data().data(), C.data().data(), M, N, K);
+                assert(C.data() == expected.data());
+            }
+        }
+    }
+
+    /**
+     * @brief Tuned shapes are cached and used by Matrix::multiply; tiny ones
+     *        and GemmTuning::Off always get the default plan.
+     */
+    static void testTuneAndLookup() {
+        clearGemmCache();
+        GemmTunerConfig config;
+        config.secondsPerShape = 0.05;
+        setGemmTunerConfig(config);
+
+        GemmPlan tuned = tuneGemm(96, 80, 64);
+        assert(tuned.seconds > 0.0);
+        assert(gemmCacheSize() == 1);
+        GemmPlan found = gemmPlan(96, 80, 64);
+        assert(found.kernel == tuned.kernel && found.axis == tuned.axis && found.tasks == tuned.tasks);
+        assert(gemmPlan(4, 4, 4).seconds == 0.0);
+
+        Matrix A(96, 64, true), B(64, 80, true);
+        assert(Matrix::multiply(A, B).data() == referenceMultiply(A, B).data());
+
+        config.mode = GemmTuning::Off;
+        setGemmTunerConfig(config);
+        assert(gemmPlan(96, 80, 64).seconds == 0.0);
+
+        // Online: the first multiply of a new shape tunes it
+        config.mode = GemmTuning::Online;
+        setGemmTunerConfig(config);
+        Matrix X(33, 40, true), W(40, 50, true);
+        assert(Matrix::multiply(X, W).data() == referenceMultiply(X, W).data());
+        assert(gemmCacheSize() == 2);
+        clearGemmCache();
+        setGemmTunerConfig(GemmTunerConfig());
+    }
+
+    /**
+     * @brief Network tuning covers forward and backward shapes, persists
+     *        them, and a later load starts tuned; foreign or malformed files
+     *        are rejected whole.
+     */
+    static void testNetworkTuningAndCacheFile() {
+        const char* path = "test_gemm_autotuner_cache.txt";
+        std::remove(path);
+        clearGemmCache();
+        GemmTunerConfig config;
+        config.cachePath = path;
+        config.secondsPerShape = 0.02;
+        assert(!setGemmTunerConfig(config));   // No file yet
+
+        NeuralNetwork net({ 32, 64, 48, 10 },
+            { ActivationType::ReLU, ActivationType::ReLU, ActivationType::Sigmoid },
+            LossType::MSE, OptimizerType::SGD);
+        Matrix x(50, 32, true);
+        const Matrix before = net.predict(x);
+
+        // 3 forward + 3 weight-gradient + 2 input-gradient shapes
+        assert(tuneGemmForNetwork(net, 50) == 8);
+        assert(tuneGemmForNetwork(net, 50) == 0);
+        assert(net.predict(x).data() == before.data());
+
+        clearGemmCache();
+        assert(setGemmTunerConfig(config));
+        assert(gemmCacheSize() == 8);
+        assert(gemmPlan(50, 64, 32).seconds > 0.0);
+
+        {
+            std::ofstream out(path);
+            out << "cores 100000\n64 64 32 Blocked Rows 2 64 256 1e-05\n";
+        }
+        clearGemmCache();
+        assert(!loadGemmCache(path) && gemmCacheSize() == 0);
+
+        assert(saveGemmCache(path));   // Empty but valid
+        {
+            std::ofstream out(path, std::ios::app);
+            out << "64 64 32 Blocked Rows 2 64 256 1e-05\n64 64 Diagonal\n";
+        }
+        assert(!loadGemmCache(path) && gemmCacheSize() == 0);
+
+        std::remove(path);
+        setGemmTunerConfig(GemmTunerConfig());
+    }
+
+    /**
+     * @brief Runs all GEMM autotuner tests.
+     */
+    void runAllGemmAutotunerTests() {
+        std::cout << "[test_gemm_autotuner] Running tests...\n";
+        testCandidatesAgree();
+        testTuneAndLookup();
+        testNetworkTuningAndCacheFile();
+        std::cout << "[test_gemm_autotuner] All tests passed!\n";
+    }
+
+}  // namespace test_gemm_autotuner
@@ -0,0 +1,177 @@
+/**
+ * @file test_layer_graph.h
+ * @brief Tests for the layer graph, its layers and the memory planner.
+ */
+
+#include <cassert>
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <vector>
+#include "../include/layer_graph.h"
+#include "gradient_check.h"
+
+namespace test_layer_graph {
+
+    using namespace nn;
+
+    /**
+     * @brief Tensors with disjoint lifetimes share a buffer; overlapping ones don't.
+     */
+    static void testPlanMemory() {
+        // A chain: each tensor is live together with its successor only
+        std::vector<TensorLifetime> chain = {
+            { 100, 0, 1 }, { 50, 1, 2 }, { 80, 2, 3 }, { 20, 3, 4 }
+        };
+        MemoryPlan plan = planMemory(chain);
+        assert(plan.bufferElements.size() == 2);
+        assert(plan.bufferOf[0] == plan.bufferOf[2]);
+        assert(plan.bufferOf[1] == plan.bufferOf[3]);
+        assert(plan.bufferOf[0] != plan.bufferOf[1]);
+        assert(plan.bufferElements[plan.bufferOf[0]] == 100);
+
+        // Lifetimes are inclusive: [0, 5] overlaps both [2, 3] and [5, 6]
+        std::vector<TensorLifetime> overlapping = { { 10, 0, 5 }, { 10, 2, 3 }, { 10, 5, 6 } };
+        plan = planMemory(overlapping);
+        assert(plan.bufferElements.size() == 2);
+        assert(plan.bufferOf[0] != plan.bufferOf[1] && plan.bufferOf[0] != plan.bufferOf[2]);
+    }
+
+    /**
+     * @brief Compares the backward pass through Dense, LayerNorm, Residual
+     *        and (rate 0) Dropout against central finite differences.
+     */
+    static void testGradientsMatchFiniteDifferences() {
+        const double lr = 1e-3;
+        LayerGraph graph(3, LossType::MSE, OptimizerType::SGD, lr);
+        size_t h = graph.add(std::make_unique<DenseLayer>(3, 4, ActivationType::Tanh, 1));
+        graph.add(std::make_unique<LayerNormLayer>(4));
+        graph.add(std::make_unique<DenseLayer>(4, 4, ActivationType::Sigmoid, 2));
+        size_t d = graph.add(std::make_unique<DropoutLayer>(0.0, 3));
+        graph.add(std::make_unique<ResidualLayer>(), { h, d });
+        size_t out = graph.add(std::make_unique<DenseLayer>(4, 2, ActivationType::Tanh, 4));
+
+        Matrix x(5, 3, true);
+        Matrix t(5, 2, true);
+        Matrix& w = static_cast<DenseLayer&>(graph.layer(h)).weights();
+        Matrix& wOut = static_cast<DenseLayer&>(graph.layer(out)).weights();
+        test_gradient_check::checkParameterGradients(graph, x, t, { &w, &wOut }, lr);
+    }
+
+    /**
+     * @brief BatchNorm normalizes each feature over the batch, tracks running
+     *        statistics, and its input gradient matches finite differences.
+     */
+    static void testBatchNorm() {
+        const size_t B = 6, W = 3;
+        BatchNormLayer bn(W, 0.1);
+        Matrix x(B, W, true);
+        for (size_t r = 0; r < B; ++r) {
+            x(r, 1) = 1000.0 + 5.0 * x(r, 1);  // large offset, still one pass
+        }
+        Matrix y(B, W);
+        bn.forward({ &x }, y, {}, true);
+
+        for (size_t j = 0; j < W; ++j) {
+            double mean = 0.0, sq = 0.0, xMean = 0.0;
+            for (size_t r = 0; r < B; ++r) {
+                mean += y(r, j);
+                sq += y(r, j) * y(r, j);
+                xMean += x(r, j);
+            }
+            mean /= B;
+            xMean /= B;
+            assert(std::abs(mean) < 1e-9);
+            assert(std::abs(sq / B - 1.0) < 1e-3);  // epsilon keeps it just below 1
+            assert(std::abs(bn.runningMean()(0, j) - 0.1 * xMean) < 1e-9);
+        }
+
+        // L = sum(c * y): dL/dy = c
+        Matrix c(B, W, true);
+        auto lossOf = [&]() {
+            Matrix out(B, W);
+            bn.forward({ &x }, out, {}, true);
+            double sum = 0.0;
+            for (size_t e = 0; e < out.data().size(); ++e) {
+                sum += c.data()[e] * out.data()[e];
+            }
+            return sum;
+        };
+        bn.forward({ &x }, y, {}, true);
+        Matrix gradY = c;
+        Matrix gradX(B, W);
+        bn.backward({ &x }, {}, gradY, { &gradX });
+
+        const double eps = 1e-5;
+        for (size_t e = 0; e < x.data().size(); ++e) {
+            double saved = x.data()[e];
+            x.data()[e] = saved + eps;
+            double up = lossOf();
+            x.data()[e] = saved - eps;
+            double down = lossOf();
+            x.data()[e] = saved;
+            double numeric = (up - down) / (2.0 * eps);
+            assert(std::abs(numeric - gradX.data()[e]) < 1e-5 * (1.0 + std::abs(numeric)));
+        }
+
+        // Inference normalizes with the running statistics
+        Matrix yInfer(B, W);
+        bn.forward({ &x }, yInfer, {}, false);
+        double a = 1.0 / std::sqrt(bn.runningVar()(0, 0) + 1e-5);
+        assert(std::abs(yInfer(0, 0) - (x(0, 0) - bn.runningMean()(0, 0)) * a) < 1e-9);
+    }
+
+    /**
+     * @brief A deep chain trains XOR while the planner keeps far less than
+     *        one buffer per tensor alive.
+     */
+    static void testTrainsWithSharedBuffers() {
+        LayerGraph graph(2, LossType::CrossEntropy, OptimizerType::Momentum, 0.05);
+        graph.add(std::make_unique<DenseLayer>(2, 8, ActivationType::Tanh, 11));
+        for (int i = 0; i < 4; ++i) {
+            size_t skip = graph.add(std::make_unique<DenseLayer>(8, 8, ActivationType::Tanh, 12 + i));
+            graph.add(std::make_unique<LayerNormLayer>(8));
+            graph.add(std::make_unique<ResidualLayer>(), { skip, skip + 1 });
+        }
+        graph.add(std::make_unique<DropoutLayer>(0.1, 20));
+        graph.add(std::make_unique<DenseLayer>(8, 1, ActivationType::Sigmoid, 21));
+
+        Matrix x(4, 2);
+        Matrix t(4, 1);
+        // +-1 inputs: an all-zero row would reach LayerNorm with zero variance
+        for (int p = 0; p < 4; ++p) {
+            x(p, 0) = (p & 1) ? 1.0 : -1.0;
+            x(p, 1) = ((p >> 1) & 1) ? 1.0 : -1.0;
+            t(p, 0) = ((p & 1) ^ ((p >> 1) & 1));
+        }
+
+        graph.compile(4);
+        assert(graph.plannedBytes() < graph.unplannedBytes());
+        std::cout << "[test_layer_graph] " << graph.numBuffers() << " buffers, "
+                  << graph.plannedBytes() << " planned vs "
+                  << graph.unplannedBytes() << " unplanned bytes\n";
+
+        for (int epoch = 0; epoch < 300; ++epoch) {
+            graph.trainBatch(x, t);
+        }
+
+        // Inference (dropout off) reuses the training plan
+        const Matrix& y = graph.forward(x);
+        for (int p = 0; p < 4; ++p) {
+            assert((y(p, 0) > 0.5) == (t(p, 0) > 0.5) && "Graph failed to learn XOR");
+        }
+    }
+
+    /**
+     * @brief Runs all layer graph tests.
+     */
+    void runAllLayerGraphTests() {
+        std::cout << "[test_layer_graph] Running tests...\n";
+        testPlanMemory();
+        testGradientsMatchFiniteDifferences();
+        testBatchNorm();
+        testTrainsWithSharedBuffers();
+        std::cout << "[test_layer_graph] All tests passed!\n";
+    }
+
+}  // namespace test_layer_graph
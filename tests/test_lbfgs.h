@@ -0,0 +1,144 @@
+/**
+ * @file test_lbfgs.h
+ * @brief Tests for the L-BFGS minimizer and full-batch network training with it.
+ */
+
+#include <cassert>
+#include <cmath>
+#include <iostream>
+#include <vector>
+#include "../include/lbfgs.h"
+#include "../include/neural_network.h"
+#include "../include/trainer.h"
+
+namespace test_lbfgs {
+
+    using namespace nn;
+
+    /**
+     * @brief Rosenbrock's valley: minimum 0 at (1, 1), badly conditioned.
+     */
+    static double rosenbrock(const std::vector<double>& x, std::vector<double>& grad) {
+        const double a = 1.0 - x[0];
+        const double b = x[1] - x[0] * x[0];
+        grad = { -2.0 * a - 400.0 * x[0] * b, 200.0 * b };
+        return a * a + 100.0 * b * b;
+    }
+
+    static void testRosenbrock() {
+        Lbfgs solver;
+        std::vector<double> x = { -1.2, 1.0 }, grad;
+        double f = rosenbrock(x, grad);
+        for (int it = 0; it < 200 && f > 1e-20; ++it) {
+            double next = solver.step(x, rosenbrock);
+            assert(next <= f);   // Sufficient decrease every step
+            f = next;
+        }
+        assert(std::abs(x[0] - 1.0) < 1e-6 && std::abs(x[1] - 1.0) < 1e-6);
+        assert(solver.iterations() < 100);
+    }
+
+    /**
+     * @brief A convex quadratic in 20 dimensions is solved in about as many
+     *        iterations as dimensions.
+     */
+    static void testQuadratic() {
+        const size_t n = 20;
+        auto quadratic = [n](const std::vector<double>& x, std::vector<double>& grad) {
+            grad.resize(n);
+            double f = 0.0;
+            for (size_t i = 0; i < n; ++i) {
+                const double scale = 1.0 + static_cast<double>(i);
+                f += 0.5 * scale * (x[i] - 1.0) * (x[i] - 1.0);
+                grad[i] = scale * (x[i] - 1.0);
+            }
+            return f;
+        };
+        LbfgsConfig config;
+        config.historySize = n;
+        Lbfgs solver(config);
+        std::vector<double> x(n, 0.0);
+        double f = 1.0;
+        for (int it = 0; it < 60 && f > 1e-18; ++it) {
+            f = solver.step(x, quadratic);
+        }
+        assert(f < 1e-18);
+        assert(solver.iterations() <= 2 * n);
+    }
+
+    /**
+     * @brief On a nearly linear objective the line search is still expanding
+     *        when its evaluations run out; the last decreasing step is kept.
+     */
+    static void testNearlyLinear() {
+        auto objective = [](const std::vector<double>& x, std::vector<double>& grad) {
+            grad = { -1.0 + 2e-10 * x[0] };
+            return -x[0] + 1e-10 * x[0] * x[0];
+        };
+        Lbfgs solver;
+        std::vector<double> x = { 0.0 };
+        double f = solver.step(x, objective);
+        assert(f < 0.0 && x[0] > 0.0);
+        assert(solver.iterations() == 1);
+        double next = solver.step(x, objective);
+        assert(next < f);
+    }
+
+    /**
+     * @brief Through Trainer::fit, L-BFGS learns XOR and 4-bit parity in a
+     *        few hundred full-batch iterations.
+     */
+    static void testNetworkTraining() {
+        std::vector<Matrix> inputs, targets;
+        for (int pattern = 0; pattern < 16; ++pattern) {
+            Matrix in(1, 4);
+            int ones = 0;
+            for (int bit = 0; bit < 4; ++bit) {
+                in(0, bit) = (pattern >> bit) & 1;
+                ones += (pattern >> bit) & 1;
+            }
+            Matrix t(1, 1);
+            t(0, 0) = ones % 2;
+            inputs.push_back(in);
+            targets.push_back(t);
+        }
+        NeuralNetwork net({ 4, 16, 16, 1 },
+            { ActivationType::Tanh, ActivationType::Tanh, ActivationType::Sigmoid },
+            LossType::CrossEntropy, OptimizerType::LBFGS);
+        TrainerConfig config;
+        config.maxEpochs = 1000;
+        config.evalInterval = 10;
+        config.targetLoss = 0.01;
+        TrainingResult result = Trainer(config).fit(net, Dataset{ inputs, targets });
+        assert(result.reason == StopReason::TargetLoss);
+        assert(result.progress.accuracy == 1.0);
+
+        // trainSample on the stacked batch is the same entry point
+        NeuralNetwork xorNet({ 2, 4, 1 }, { ActivationType::Tanh, ActivationType::Sigmoid },
+            LossType::CrossEntropy, OptimizerType::LBFGS);
+        Matrix x(4, 2), y(4, 1);
+        for (size_t r = 0; r < 4; ++r) {
+            x(r, 0) = static_cast<double>(r & 1);
+            x(r, 1) = static_cast<double>(r >> 1);
+            y(r, 0) = static_cast<double>((r & 1) ^ (r >> 1));
+        }
+        double loss = xorNet.trainSample(x, y);
+        for (int it = 0; it < 300 && loss > 1e-3; ++it) {
+            loss = xorNet.trainSample(x, y);
+        }
+        assert(loss <= 1e-3);
+    }
+
+    /**
+     * @brief Runs all L-BFGS tests.
+     */
+    void runAllLbfgsTests() {
+        std::cout << "[test_lbfgs] Running tests...\n";
+        testRosenbrock();
+        testQuadratic();
+        testNearlyLinear();
+        testNetworkTraining();
+        std::cout << "[test_lbfgs] All tests passed!\n";
+    }
+
+}  // namespace test_lbfgs
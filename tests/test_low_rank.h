@@ -0,0 +1,157 @@
+/**
+ * @file test_low_rank.h
+ * @brief Tests for the truncated SVD and low-rank layer factorization.
+ */
+
+#include <cassert>
+#include <cmath>
+#include <iostream>
+#include <vector>
+#include "../include/low_rank.h"
+#include "../include/evaluation.h"
+
+namespace test_low_rank {
+
+    using namespace nn;
+
+    /**
+     * @brief Random (rows x cols) matrix of exactly the given rank.
+     */
+    static Matrix lowRankMatrix(size_t rows, size_t cols, size_t rank) {
+        return Matrix::multiply(Matrix(rows, rank, true), Matrix(rank, cols, true));
+    }
+
+    static void assertOrthonormalColumns(const Matrix& M) {
+        Matrix gram = Matrix::multiply(Matrix::transpose(M), M);
+        for (size_t r = 0; r < gram.rows(); ++r) {
+            for (size_t c = 0; c < gram.cols(); ++c) {
+                assert(std::abs(gram(r, c) - (r == c ? 1.0 : 0.0)) < 1e-10);
+            }
+        }
+    }
+
+    /**
+     * @brief Full SVD of tall and wide matrices reconstructs them; a rank-r
+     *        matrix has r non-zero singular values.
+     */
+    static void testSvd() {
+        for (auto shape : { std::vector<size_t>{ 20, 9 }, std::vector<size_t>{ 7, 15 } }) {
+            Matrix A(shape[0], shape[1], true);
+            SingularValueDecomposition svd = truncatedSvd(A);
+            const size_t k = std::min(shape[0], shape[1]);
+            assert(svd.U.rows() == shape[0] && svd.U.cols() == k);
+            assert(svd.V.rows() == shape[1] && svd.V.cols() == k);
+            assertOrthonormalColumns(svd.U);
+            assertOrthonormalColumns(svd.V);
+            for (size_t j = 1; j < k; ++j) {
+                assert(svd.singularValues[j - 1] >= svd.singularValues[j]);
+            }
+            for (size_t r = 0; r < A.rows(); ++r) {
+                for (size_t c = 0; c < A.cols(); ++c) {
+                    double sum = 0.0;
+                    for (size_t j = 0; j < k; ++j) {
+                        sum += svd.U(r, j) * svd.singularValues[j] * svd.V(c, j);
+                    }
+                    assert(std::abs(sum - A(r, c)) < 1e-10);
+                }
+            }
+        }
+
+        SingularValueDecomposition lr = truncatedSvd(lowRankMatrix(30, 25, 4));
+        assert(lr.singularValues[3] > 1e-6);
+        assert(lr.singularValues[4] < 1e-10 * lr.singularValues[0]);
+        assert(rankForEnergy(lr.singularValues, 0.999999) == 4);
+        assert(truncatedSvd(lowRankMatrix(30, 25, 4), 6).singularValues.size() == 6);
+    }
+
+    /**
+     * @brief A network whose hidden layer is rank 5 factorizes losslessly
+     *        into fewer weights, and the factored network still trains.
+     */
+    static void testFactorize() {
+        NeuralNetwork net({ 40, 96, 96, 3 },
+            { ActivationType::ReLU, ActivationType::Tanh, ActivationType::Sigmoid },
+            LossType::MSE, OptimizerType::SGD, 0.05);
+        net.weights()[1] = lowRankMatrix(96, 96, 5);
+        for (double& w : net.weights()[1].data()) {
+            w *= 0.1;
+        }
+
+        LowRankConfig config;
+        config.energy = 1.0 - 1e-12;
+        config.minWeights = 1000;
+        std::vector<LowRankLayerReport> report;
+        NeuralNetwork factored = factorizeLowRank(net, config, nullptr, &report);
+
+        assert(report.size() == 3);
+        assert(report[1].factored && report[1].rank == 5);
+        assert(!report[2].factored);   // 96 x 3 is below minWeights
+        assert(factored.numLayers() == net.numLayers() + report[0].factored + 1);
+
+        size_t before = 0, after = 0;
+        for (const Matrix& w : net.weights()) {
+            before += w.data().size();
+        }
+        for (const Matrix& w : factored.weights()) {
+            after += w.data().size();
+        }
+        assert(after < before);
+
+        if (!report[0].factored) {
+            Matrix x(8, 40, true);
+            Matrix expected = net.predict(x);
+            Matrix actual = factored.predict(x);
+            for (size_t e = 0; e < expected.data().size(); ++e) {
+                assert(std::abs(expected.data()[e] - actual.data()[e]) < 1e-9);
+            }
+        }
+
+        // Fine-tuning works on the factored network like on any other
+        Matrix x(1, 40, true);
+        Matrix y(1, 3);
+        y(0, 1) = 1.0;
+        double first = factored.trainSample(x, y);
+        double last = first;
+        for (int step = 0; step < 50; ++step) {
+            last = factored.trainSample(x, y);
+        }
+        assert(last < first);
+    }
+
+    /**
+     * @brief With validation data the chosen ranks keep the loss within budget.
+     */
+    static void testLossBudget() {
+        NeuralNetwork net({ 32, 64, 2 }, { ActivationType::Tanh, ActivationType::Sigmoid },
+            LossType::MSE, OptimizerType::SGD);
+        Dataset data;
+        for (size_t i = 0; i < 32; ++i) {
+            data.inputs.emplace_back(1, 32, true);
+            data.targets.emplace_back(1, 2);
+            data.targets.back()(0, i % 2) = 1.0;
+        }
+        const double baseline = evaluate(net, data, { Metric::Loss }).loss;
+
+        LowRankConfig config;
+        config.minWeights = 1000;
+        config.maxLossIncrease = 1e-3;
+        std::vector<LowRankLayerReport> report;
+        NeuralNetwork factored = factorizeLowRank(net, config, &data, &report);
+        assert(evaluate(factored, data, { Metric::Loss }).loss <= baseline + 1e-3 + 1e-12);
+        if (report[0].factored) {
+            assert(report[0].rank <= 21 && report[0].energyKept <= 1.0);
+        }
+    }
+
+    /**
+     * @brief Runs all low-rank tests.
+     */
+    void runAllLowRankTests() {
+        std::cout << "[test_low_rank] Running tests...\n";
+        testSvd();
+        testFactorize();
+        testLossBudget();
+        std::cout << "[test_low_rank] All tests passed!\n";
+    }
+
+}  // namespace test_low_rank
@@ -3,13 +3,17 @@
  * @brief Tests for the Matrix class using simple assert-based checks.
  */
 
+#include <algorithm>
 #include <cassert>
+#include <cmath>
+#include <cstdint>
 #include <iostream>
+#include "../include/aligned_allocator.h"
 #include "../include/matrix.h"
 
 namespace test_matrix {
 
-    using nn::Matrix;
+    using namespace nn;
 
     /**
      * @brief Tests basic initialization of Matrix.
@@ -68,6 +72,84 @@ namespace test_matrix {
         assert(D(1, 1) == 12.0);
     }
 
+    /**
+     * @brief Checks batched multiply against one Matrix::multiply per pair,
+     *        for the serial, batch-parallel and row-parallel kernels.
+     */
+    static void testMultiplyBatched() {
+        struct Shape { size_t batch, m, k, n; };
+        const Shape shapes[] = {
+            { 3, 2, 3, 2 },      // tiny: serial
+            { 64, 4, 16, 16 },   // many small products: parallel over batch
+            { 2, 70, 65, 66 }    // large products: parallel within matrix
+        };
+
+        for (const Shape& s : shapes) {
+            Matrix A(s.batch * s.m, s.k, true);
+            Matrix B(s.batch * s.k, s.n, true);
+            Matrix C = Matrix::multiplyBatched(A, B, s.batch);
+            assert(C.rows() == s.batch * s.m && C.cols() == s.n);
+
+            for (size_t b = 0; b < s.batch; ++b) {
+                Matrix Ab(s.m, s.k);
+                Matrix Bb(s.k, s.n);
+                std::copy(A.data().begin() + b * s.m * s.k,
+                    A.data().begin() + (b + 1) * s.m * s.k, Ab.data().begin());
+                std::copy(B.data().begin() + b * s.k * s.n,
+                    B.data().begin() + (b + 1) * s.k * s.n, Bb.data().begin());
+                Matrix expected = Matrix::multiply(Ab, Bb);
+                for (size_t r = 0; r < s.m; ++r) {
+                    for (size_t c = 0; c < s.n; ++c) {
+                        assert(std::abs(C(b * s.m + r, c) - expected(r, c)) < 1e-12 &&
+                            "Batched product should match Matrix::multiply");
+                    }
+                }
+            }
+        }
+
+        // Shared right-hand side (stride 0)
+        Matrix A(4 * 2, 3, true);
+        Matrix B(3, 5, true);
+        Matrix C = Matrix::multiplyBatched(A, B, 4);
+        Matrix expected = Matrix::multiply(A, B);
+        for (size_t i = 0; i < C.data().size(); ++i) {
+            assert(std::abs(C.data()[i] - expected.data()[i]) < 1e-12 &&
+                "Shared B should equal one stacked multiply");
+        }
+    }
+
+    /**
+     * @brief Storage is cache-line aligned on both the ordinary and the
+     *        huge-page path, and copies keep their contents.
+     */
+    static void testAlignedStorage() {
+        auto aligned = [](const Matrix& m) {
+            return reinterpret_cast<uintptr_t>(m.data().data()) % kMatrixAlignment == 0;
+        };
+        for (size_t cols : { 1, 3, 7, 64, 1000 }) {
+            Matrix m(3, cols, true);
+            assert(aligned(m));
+            Matrix copy = m;
+            assert(aligned(copy) && copy.data() == m.data());
+        }
+
+        const size_t saved = hugePageThreshold();
+        setHugePageThreshold(size_t(1) << 16);
+        Matrix big(256, 256, true);
+        assert(aligned(big));
+        big.resize(512, 256);
+        assert(aligned(big));
+        big(511, 255) = 2.0;
+        assert(big(511, 255) == 2.0);
+        setHugePageThreshold(saved);
+
+        assert(paddedLeadingDimension(0) == 0);
+        assert(paddedLeadingDimension(5) == 8);
+        assert(paddedLeadingDimension(24) == 24);
+        assert(paddedLeadingDimension(64) == 72);   // 512 bytes
+        assert(paddedLeadingDimension(1024) == 1032);
+    }
+
     /**
      * @brief Runs all Matrix-related tests in sequence.
      */
@@ -76,6 +158,8 @@ namespace test_matrix {
         testBasicInitialization();
         testRandomInitialization();
         testMultiplyAdd();
+        testMultiplyBatched();
+        testAlignedStorage();
         std::cout << "[test_matrix] All tests passed!\n";
     }
 
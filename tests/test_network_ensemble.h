@@ -0,0 +1,97 @@
+/**
+ * @file test_network_ensemble.h
+ * @brief Tests for the NetworkEnsemble class using simple assert-based checks.
+ */
+
+#include <cassert>
+#include <iostream>
+#include "../include/network_ensemble.h"
+
+namespace test_ensemble {
+
+    using namespace nn;
+
+    /**
+     * @brief Checks every model in the ensemble behaves exactly like the
+     *        standalone NeuralNetwork extracted from it, for forward and one
+     *        training step.
+     */
+    static void testMatchesStandaloneNetworks() {
+        std::vector<size_t> layerSizes = { 3, 5, 2 };
+        std::vector<ActivationType> activs = {
+            ActivationType::Tanh,
+            ActivationType::Sigmoid
+        };
+        std::vector<double> learningRates = { 0.01, 0.05, 0.1, 0.5 };
+
+        NetworkEnsemble ensemble(layerSizes, activs, LossType::MSE,
+            OptimizerType::SGD, learningRates);
+        assert(ensemble.size() == 4 && "Ensemble should hold 4 models");
+
+        Matrix input(1, 3);
+        input(0, 0) = 0.5; input(0, 1) = -1.0; input(0, 2) = 0.25;
+        Matrix target(1, 2);
+        target(0, 0) = 1.0; target(0, 1) = 0.0;
+
+        std::vector<NeuralNetwork> models;
+        for (size_t k = 0; k < ensemble.size(); ++k) {
+            models.push_back(ensemble.extractModel(k));
+        }
+
+        const std::vector<double>& losses = ensemble.trainSample(input, target);
+        for (size_t k = 0; k < ensemble.size(); ++k) {
+            double loss = models[k].trainSample(input, target);
+            assert(loss == losses[k] && "Per-model loss should match standalone network");
+        }
+
+        Matrix outputs = ensemble.forward(input);
+        assert(outputs.rows() == 4 && outputs.cols() == 2);
+        for (size_t k = 0; k < ensemble.size(); ++k) {
+            Matrix out = models[k].forward(input);
+            assert(out(0, 0) == outputs(k, 0) && out(0, 1) == outputs(k, 1) &&
+                "Updated model should match standalone network");
+        }
+    }
+
+    /**
+     * @brief Trains an XOR sweep and checks the best model solves it.
+     */
+    static void testBestModelLearnsXor() {
+        std::vector<Matrix> inputs(4, Matrix(1, 2));
+        std::vector<Matrix> targets(4, Matrix(1, 1));
+        inputs[1](0, 1) = 1;
+        inputs[2](0, 0) = 1;
+        inputs[3](0, 0) = 1; inputs[3](0, 1) = 1;
+        targets[1](0, 0) = 1;
+        targets[2](0, 0) = 1;
+
+        NetworkEnsemble ensemble(16, { 2, 4, 4, 1 },
+            { ActivationType::ReLU, ActivationType::ReLU, ActivationType::Sigmoid },
+            LossType::CrossEntropy, OptimizerType::Momentum, 0.05, 0.9);
+
+        for (int e = 0; e < 2000; ++e) {
+            ensemble.resetLosses();
+            for (size_t i = 0; i < inputs.size(); ++i) {
+                ensemble.trainSample(inputs[i], targets[i]);
+            }
+        }
+
+        NeuralNetwork best = ensemble.extractModel(ensemble.bestModel());
+        for (size_t i = 0; i < inputs.size(); ++i) {
+            double outVal = best.forward(inputs[i])(0, 0);
+            assert((outVal > 0.5) == (targets[i](0, 0) == 1.0) &&
+                "Best model should classify XOR correctly");
+        }
+    }
+
+    /**
+     * @brief Runs all NetworkEnsemble tests in sequence.
+     */
+    void runAllNetworkEnsembleTests() {
+        std::cout << "[test_network_ensemble] Running tests...\n";
+        testMatchesStandaloneNetworks();
+        testBestModelLearnsXor();
+        std::cout << "[test_network_ensemble] All tests passed!\n";
+    }
+
+}  // namespace test_ensemble
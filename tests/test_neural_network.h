@@ -83,12 +83,80 @@ namespace test_nn {
         }
     }
 
+    /**
+     * @brief Checks checkpointed training gives the same weights as storing
+     *        every activation, with a lower activation-memory peak.
+     */
+    static void testCheckpointingMatchesFullStorage() {
+        std::vector<size_t> layerSizes = { 8, 32, 32, 32, 32, 32, 32, 1 };
+        std::vector<ActivationType> activs(6, ActivationType::Tanh);
+        activs.push_back(ActivationType::Sigmoid);
+
+        NeuralNetwork full(layerSizes, activs, LossType::CrossEntropy, OptimizerType::Momentum, 0.05, 0.9);
+        NeuralNetwork checkpointed(layerSizes, activs, LossType::CrossEntropy, OptimizerType::Momentum, 0.05, 0.9);
+        full.initializeParameters(7);
+        checkpointed.initializeParameters(7);
+        checkpointed.setCheckpointStride(3);
+        assert(checkpointed.checkpointStride() == 3);
+
+        // A mini-batch of 16 rows
+        Matrix input(16, 8, true);
+        Matrix target(16, 1);
+        for (size_t r = 0; r < 16; ++r) {
+            target(r, 0) = (input(r, 0) > 0.0) ? 1.0 : 0.0;
+        }
+
+        for (int step = 0; step < 5; ++step) {
+            double a = full.trainSample(input, target);
+            double b = checkpointed.trainSample(input, target);
+            assert(a == b && "Checkpointing must not change the loss");
+        }
+        for (size_t i = 0; i < full.weights().size(); ++i) {
+            assert(full.weights()[i].data() == checkpointed.weights()[i].data() &&
+                "Checkpointing must not change the gradients");
+            assert(full.biases()[i].data() == checkpointed.biases()[i].data());
+        }
+
+        assert(checkpointed.peakActivationBytes() < full.peakActivationBytes());
+        assert(full.peakActivationBytes() == full.estimateActivationBytes(1, 16));
+        assert(checkpointed.peakActivationBytes() <= checkpointed.estimateActivationBytes(3, 16));
+
+        // A budget that fits everything keeps everything; a tight one checkpoints
+        assert(full.setCheckpointMemoryBudget(1 << 20, 16) == 1);
+        size_t stride = full.setCheckpointMemoryBudget(0, 16);
+        assert(stride > 1 && full.checkpointStride() == stride);
+        assert(full.estimateActivationBytes(stride, 16) < full.estimateActivationBytes(1, 16));
+    }
+
+    /**
+     * @brief Checks a mini-batch forward matches per-sample predictions.
+     */
+    static void testBatchForwardMatchesPredict() {
+        NeuralNetwork net({ 3, 5, 2 },
+            { ActivationType::ReLU, ActivationType::Sigmoid },
+            LossType::MSE, OptimizerType::SGD);
+
+        Matrix batch(4, 3, true);
+        Matrix out = net.forward(batch);
+        assert(out.rows() == 4 && out.cols() == 2);
+        for (size_t r = 0; r < 4; ++r) {
+            Matrix row(1, 3);
+            for (size_t c = 0; c < 3; ++c) {
+                row(0, c) = batch(r, c);
+            }
+            Matrix single = net.predict(row);
+            assert(single(0, 0) == out(r, 0) && single(0, 1) == out(r, 1));
+        }
+    }
+
     /**
      * @brief Runs all neural-network-related tests in sequence.
      */
     void runAllNeuralNetworkTests() {
         std::cout << "[test_neural_network] Running tests...\n";
         testXorTrainingBasic();
+        testCheckpointingMatchesFullStorage();
+        testBatchForwardMatchesPredict();
         std::cout << "[test_neural_network] All tests passed!\n";
     }
 
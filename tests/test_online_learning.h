@@ -0,0 +1,169 @@
+/**
+ * @file test_online_learning.h
+ * @brief Tests for snapshot publication and the online learner.
+ */
+
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <thread>
+#include <vector>
+#include "../include/online_learning.h"
+#include "../include/threading.h"
+
+namespace test_online_learning {
+
+    using namespace nn;
+
+    static std::atomic<int> g_liveVersions{ 0 };
+
+    struct Versioned {
+        size_t value;
+        size_t copy;
+        explicit Versioned(size_t v) : value(v), copy(v) { ++g_liveVersions; }
+        ~Versioned() { copy = 0; --g_liveVersions; }
+    };
+
+    /**
+     * @brief Readers always see a whole, non-decreasing version while the
+     *        writer publishes, and every version is freed exactly once.
+     */
+    static void testSnapshotCell() {
+        {
+            SnapshotCell<Versioned> cell(8);
+            assert(!cell.read());
+            cell.publish(std::make_unique<const Versioned>(1));
+
+            std::atomic<bool> done{ false };
+            std::vector<std::thread> readers;
+            for (int r = 0; r < 4; ++r) {
+                readers.emplace_back([&] {
+                    size_t last = 0;
+                    while (!done.load()) {
+                        auto guard = cell.read();
+                        assert(guard->value == guard->copy);
+                        assert(guard->value >= last);
+                        last = guard->value;
+                    }
+                });
+            }
+            for (size_t v = 2; v <= 3000; ++v) {
+                cell.publish(std::make_unique<const Versioned>(v));
+                assert(cell.retiredCount() <= 8);
+            }
+            done = true;
+            for (auto& t : readers) {
+                t.join();
+            }
+            assert(cell.read()->value == 3000);
+            cell.publish(std::make_unique<const Versioned>(3001));
+            assert(cell.retiredCount() == 0);
+            assert(g_liveVersions == 1);
+        }
+        assert(g_liveVersions == 0);
+    }
+
+    /**
+     * @brief Learns from a queue while readers predict; snapshots are
+     *        published on schedule and the last one matches the network.
+     */
+    static void testQueueLearner() {
+        NeuralNetwork net({ 2, 8, 1 }, { ActivationType::Tanh, ActivationType::Sigmoid },
+            LossType::MSE, OptimizerType::SGD, 0.5);
+        QueueSampleSource source(64);
+        OnlineLearnerConfig config;
+        config.batchSize = 4;
+        config.publishInterval = 10;
+        OnlineLearner learner(net, source, config);
+        assert(learner.version() == 1);
+
+        Matrix probe(1, 2);
+        probe(0, 0) = 1.0;
+        const double before = learner.predict(probe)(0, 0);
+        learner.start();
+
+        std::atomic<bool> done{ false };
+        std::thread reader([&] {
+            size_t lastVersion = 0;
+            while (!done.load()) {
+                auto snap = learner.snapshot();
+                assert(snap->version >= lastVersion);
+                lastVersion = snap->version;
+                double p = snap->predict(probe)(0, 0);
+                assert(p > 0.0 && p < 1.0);
+            }
+        });
+
+        // Target: the first input coordinate; 802 samples -> 201 steps
+        for (size_t i = 0; i < 802; ++i) {
+            Matrix x(1, 2);
+            x(0, 0) = static_cast<double>(i % 2);
+            x(0, 1) = static_cast<double>((i / 2) % 2);
+            Matrix y(1, 1);
+            y(0, 0) = x(0, 0);
+            assert(source.push(std::move(x), std::move(y)));
+        }
+        learner.stop();
+        done = true;
+        reader.join();
+
+        assert(learner.steps() == 201);
+        assert(learner.version() == 1 + 20 + 1);
+        auto snap = learner.snapshot();
+        assert(snap->steps == 201);
+        Matrix expected = net.predict(probe);
+        assert(snap->predict(probe)(0, 0) == expected(0, 0));
+        assert(expected(0, 0) > before);
+        assert(!source.push(Matrix(1, 2), Matrix(1, 1)));
+    }
+
+    /**
+     * @brief The file source follows appended lines, waits out partial
+     *        lines and skips malformed ones.
+     */
+    static void testFileTailSource() {
+        const char* path = "test_online_learning_tail.txt";
+        std::remove(path);
+        FileTailSampleSource source(path, 2, 1, 1);
+
+        std::thread writer([&] {
+            std::ofstream out(path);
+            out << "# x0, x1, y\n1, 2, 3\n" << std::flush;
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            out << "4 5 " << std::flush;   // Unterminated
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            out << "6\n1 2\n7,8,9\n" << std::flush;
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            source.close();
+        });
+
+        Matrix x, y;
+        std::vector<double> seen;
+        while (source.next(x, y)) {
+            assert(x.cols() == 2 && y.cols() == 1);
+            seen.push_back(x(0, 0));
+            seen.push_back(x(0, 1));
+            seen.push_back(y(0, 0));
+        }
+        writer.join();
+        assert((seen == std::vector<double>{ 1, 2, 3, 4, 5, 6, 7, 8, 9 }));
+        assert(source.skippedLines() == 1);
+        std::remove(path);
+    }
+
+    /**
+     * @brief Runs all online learning tests.
+     */
+    void runAllOnlineLearningTests() {
+        std::cout << "[test_online_learning] Running tests...\n";
+        testSnapshotCell();
+        testQueueLearner();
+        testFileTailSource();
+        std::cout << "[test_online_learning] All tests passed!\n";
+    }
+
+}  // namespace test_online_learning
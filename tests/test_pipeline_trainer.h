@@ -0,0 +1,109 @@
+/**
+ * @file test_pipeline_trainer.h
+ * @brief Tests for the pipeline-parallel trainer and the SPSC queue.
+ */
+
+#include <cassert>
+#include <cmath>
+#include <iostream>
+#include <thread>
+#include <vector>
+#include "../include/pipeline_trainer.h"
+#include "../include/threading.h"
+
+namespace test_pipeline_trainer {
+
+    using namespace nn;
+
+    static NeuralNetwork makeNet(OptimizerType opt) {
+        NeuralNetwork net({ 6, 16, 12, 8, 3 },
+            { ActivationType::ReLU, ActivationType::Tanh, ActivationType::ReLU, ActivationType::Sigmoid },
+            LossType::MSE, opt, 0.05, 0.9);
+        net.initializeParameters(42);
+        return net;
+    }
+
+    static void testSpscQueueOrder() {
+        const size_t count = 10000;
+        SpscQueue<size_t> queue(8);
+        std::thread producer([&] {
+            for (size_t i = 0; i < count; ++i) {
+                queue.push(i);
+            }
+        });
+        for (size_t i = 0; i < count; ++i) {
+            assert(queue.pop() == i);
+        }
+        producer.join();
+    }
+
+    /**
+     * @brief Both schedules must give the weights of a plain full-batch step,
+     *        over several steps so momentum state is exercised too.
+     */
+    static void testMatchesFullBatchStep(PipelineSchedule schedule) {
+        Matrix x(10, 6, true);
+        Matrix t(10, 3);
+        for (size_t e = 0; e < t.data().size(); ++e) {
+            t.data()[e] = (e % 3 == 0) ? 1.0 : 0.0;
+        }
+
+        NeuralNetwork reference = makeNet(OptimizerType::Momentum);
+        NeuralNetwork piped = makeNet(OptimizerType::Momentum);
+
+        PipelineConfig config;
+        config.numStages = 3;
+        config.microBatches = 4;
+        config.schedule = schedule;
+        PipelineTrainer trainer(piped, config);
+        assert(trainer.stageLayers().size() == 3);
+        assert(trainer.stageLayers().front().first == 0);
+        assert(trainer.stageLayers().back().second == 4);
+
+        double expectedLoss0 = 0.0;
+        double loss0 = 0.0;
+        for (int step = 0; step < 5; ++step) {
+            std::vector<Matrix> dW, dB;
+            const double expected = reference.computeGradients(x, t, dW, dB);
+            for (size_t i = 0; i < reference.numLayers(); ++i) {
+                reference.applyLayerGradients(i, dW[i], dB[i]);
+            }
+            if (step == 0) {
+                expectedLoss0 = expected;
+            }
+            double loss = trainer.trainBatch(x, t);
+            if (step == 0) {
+                loss0 = loss;
+            }
+        }
+        assert(std::abs(loss0 - expectedLoss0) < 1e-12);
+
+        for (size_t i = 0; i < reference.numLayers(); ++i) {
+            for (size_t e = 0; e < reference.weights()[i].data().size(); ++e) {
+                assert(std::abs(reference.weights()[i].data()[e] - piped.weights()[i].data()[e]) < 1e-10);
+            }
+            for (size_t e = 0; e < reference.biases()[i].data().size(); ++e) {
+                assert(std::abs(reference.biases()[i].data()[e] - piped.biases()[i].data()[e]) < 1e-10);
+            }
+        }
+
+        if (schedule == PipelineSchedule::OneFOneB) {
+            assert(trainer.peakInFlight() <= config.numStages);
+        }
+        else {
+            assert(trainer.peakInFlight() == config.microBatches);
+        }
+    }
+
+    /**
+     * @brief Runs all pipeline trainer tests.
+     */
+    void runAllPipelineTrainerTests() {
+        std::cout << "[test_pipeline_trainer] Running tests...\n";
+        testSpscQueueOrder();
+        testMatchesFullBatchStep(PipelineSchedule::GPipe);
+        testMatchesFullBatchStep(PipelineSchedule::OneFOneB);
+        std::cout << "[test_pipeline_trainer] All tests passed!\n";
+    }
+
+}  // namespace test_pipeline_trainer
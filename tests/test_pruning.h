@@ -0,0 +1,152 @@
+/**
+ * @file test_pruning.h
+ * @brief Tests for magnitude pruning, CSR matrices and the sparse inference network.
+ */
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <iostream>
+#include "../include/pruning.h"
+#include "../include/sparse_matrix.h"
+
+namespace test_pruning {
+
+    using namespace nn;
+
+    /**
+     * @brief Exactly floor(s * n) entries are zeroed and they are the smallest.
+     */
+    static void testPruneByMagnitude() {
+        Matrix w(4, 5);
+        for (size_t i = 0; i < 20; ++i) {
+            w.data()[i] = (i % 2 ? -1.0 : 1.0) * static_cast<double>(i + 1);
+        }
+        assert(pruneByMagnitude(w, 0.55) == 11);
+        for (size_t i = 0; i < 20; ++i) {
+            assert((w.data()[i] == 0.0) == (i < 11));
+        }
+        assert(pruneByMagnitude(w, 0.0) == 0);
+
+        // Ties: still exactly the requested count
+        Matrix flat(3, 3);
+        flat.data().assign(9, 0.5);
+        pruneByMagnitude(flat, 0.5);
+        assert(std::count(flat.data().begin(), flat.data().end(), 0.0) == 4);
+    }
+
+    /**
+     * @brief CSR round-trips and multiplies like the dense matrix.
+     */
+    static void testSparseMatrix() {
+        Matrix w(12, 7, true);
+        pruneByMagnitude(w, 0.7);
+        SparseMatrix s = SparseMatrix::fromDense(w);
+        assert(s.rows() == 12 && s.cols() == 7);
+        assert(s.nonZeros() == 84 - 58);
+        assert(std::abs(s.density() - 26.0 / 84.0) < 1e-12);
+        Matrix back = s.toDense();
+        assert(back.data() == w.data());
+
+        Matrix x(5, 12, true);
+        x(2, 3) = 0.0;
+        Matrix y;
+        SparseMatrix::multiply(x, s, y);
+        Matrix expected = Matrix::multiply(x, w);
+        assert(y.rows() == 5 && y.cols() == 7);
+        for (size_t e = 0; e < y.data().size(); ++e) {
+            assert(std::abs(y.data()[e] - expected.data()[e]) < 1e-12);
+        }
+    }
+
+    /**
+     * @brief The schedule ramps cubically to the final sparsity and pruned
+     *        weights stay zero through further training.
+     */
+    static void testScheduledPruning() {
+        NeuralNetwork net({ 4, 16, 2 }, { ActivationType::ReLU, ActivationType::Sigmoid },
+            LossType::MSE, OptimizerType::SGD);
+        PruningSchedule schedule;
+        schedule.finalSparsity = 0.75;
+        schedule.beginStep = 10;
+        schedule.endStep = 50;
+        schedule.frequency = 10;
+        MagnitudePruner pruner(net, schedule);
+
+        assert(pruner.targetSparsity(5) == 0.0);
+        assert(std::abs(pruner.targetSparsity(30) - 0.75 * (1.0 - 0.125)) < 1e-12);
+        assert(pruner.targetSparsity(80) == 0.75);
+        assert(pruner.targetSparsity(20) < pruner.targetSparsity(40));
+
+        Matrix x(1, 4, true);
+        Matrix y(1, 2);
+        y(0, 0) = 1.0;
+        for (size_t step = 0; step < 60; ++step) {
+            net.trainSample(x, y);
+            pruner.step();
+        }
+        assert(std::abs(pruner.sparsity() - 0.75) < 0.02);
+
+        Matrix pruned = net.weights()[0];
+        for (size_t step = 0; step < 10; ++step) {
+            net.trainSample(x, y);
+            pruner.step();
+        }
+        for (size_t e = 0; e < pruned.data().size(); ++e) {
+            if (pruned.data()[e] == 0.0) {
+                assert(net.weights()[0].data()[e] == 0.0);
+            }
+        }
+    }
+
+    /**
+     * @brief The sparse network predicts what the pruned dense one does
+     *        while storing less.
+     */
+    static void testSparseNetwork() {
+        NeuralNetwork net({ 32, 64, 64, 3 },
+            { ActivationType::ReLU, ActivationType::Tanh, ActivationType::Sigmoid },
+            LossType::MSE, OptimizerType::SGD);
+        MagnitudePruner pruner(net);
+        pruner.pruneTo(0.9);
+        assert(std::abs(pruner.sparsity() - 0.9) < 0.01);
+
+        SparseNetwork sparse(net);
+        for (size_t i = 0; i < net.numLayers(); ++i) {
+            assert(sparse.isSparse(i));
+        }
+        size_t denseBytes = 0;
+        for (size_t i = 0; i < net.numLayers(); ++i) {
+            denseBytes += (net.weights()[i].data().size() + net.biases()[i].data().size()) * sizeof(double);
+        }
+        assert(sparse.bytes() < denseBytes / 3);
+
+        Matrix x(9, 32, true);
+        Matrix expected = net.predict(x);
+        Matrix actual = sparse.predict(x);
+        for (size_t e = 0; e < expected.data().size(); ++e) {
+            assert(std::abs(actual.data()[e] - expected.data()[e]) < 1e-12);
+        }
+
+        // Above the density threshold a layer stays dense
+        SparseNetwork mixed(net, 0.05);
+        assert(!mixed.isSparse(0));
+        Matrix mixedOut = mixed.predict(x);
+        for (size_t e = 0; e < expected.data().size(); ++e) {
+            assert(std::abs(mixedOut.data()[e] - expected.data()[e]) < 1e-12);
+        }
+    }
+
+    /**
+     * @brief Runs all pruning tests.
+     */
+    void runAllPruningTests() {
+        std::cout << "[test_pruning] Running tests...\n";
+        testPruneByMagnitude();
+        testSparseMatrix();
+        testScheduledPruning();
+        testSparseNetwork();
+        std::cout << "[test_pruning] All tests passed!\n";
+    }
+
+}  // namespace test_pruning
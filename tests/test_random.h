@@ -0,0 +1,121 @@
+/**
+ * @file test_random.h
+ * @brief Tests for counter-based random generation and initializers.
+ */
+
+#include <cassert>
+#include <cmath>
+#include <iostream>
+#include "../include/random.h"
+#include "../include/neural_network.h"
+
+namespace test_random {
+
+    using namespace nn;
+
+    /**
+     * @brief Known-answer tests from the Random123 distribution.
+     */
+    static void testPhiloxKnownAnswers() {
+        std::array<uint32_t, 4> zero = philox4x32({ 0, 0, 0, 0 }, { 0, 0 });
+        assert(zero[0] == 0x6627e8d5u && zero[1] == 0xe169c58du &&
+            zero[2] == 0xbc57ac4cu && zero[3] == 0x9b00dbd8u);
+
+        std::array<uint32_t, 4> ones = philox4x32(
+            { 0xffffffffu, 0xffffffffu, 0xffffffffu, 0xffffffffu },
+            { 0xffffffffu, 0xffffffffu });
+        assert(ones[0] == 0x408f276du && ones[1] == 0x41c83b0eu &&
+            ones[2] == 0xa20bc7c6u && ones[3] == 0x6d5451fdu);
+
+        std::array<uint32_t, 4> pi = philox4x32(
+            { 0x243f6a88u, 0x85a308d3u, 0x13198a2eu, 0x03707344u },
+            { 0xa4093822u, 0x299f31d0u });
+        assert(pi[0] == 0xd16cfe09u && pi[1] == 0x94fdccebu &&
+            pi[2] == 0x5001e420u && pi[3] == 0x24126ea1u);
+    }
+
+    /**
+     * @brief A large (parallel) fill must equal a small (serial) fill of the
+     *        same leading elements, and repeat exactly for the same key.
+     */
+    static void testFillIsReproducible() {
+        Matrix big(300, 301);     // many parallel chunks, odd element count
+        Matrix small(1, 1001);    // single chunk
+        fillUniform(big, 7, 3, -2.0, 2.0);
+        fillUniform(small, 7, 3, -2.0, 2.0);
+        for (size_t i = 0; i < small.data().size(); ++i) {
+            assert(big.data()[i] == small.data()[i] && "Chunking must not change values");
+        }
+        for (double v : big.data()) {
+            assert(v >= -2.0 && v < 2.0);
+        }
+
+        Matrix again(300, 301);
+        fillUniform(again, 7, 3, -2.0, 2.0);
+        assert(again.data() == big.data() && "Same (seed, tensorId) must repeat");
+
+        Matrix other(300, 301);
+        fillUniform(other, 7, 4, -2.0, 2.0);
+        assert(other.data() != big.data() && "Different tensor IDs must differ");
+
+        Matrix normal(400, 500);
+        fillNormal(normal, 11, 0, 1.0, 0.5);
+        double sum = 0.0;
+        double sumSq = 0.0;
+        for (double v : normal.data()) {
+            sum += v;
+            sumSq += v * v;
+        }
+        double n = static_cast<double>(normal.data().size());
+        double mean = sum / n;
+        double stddev = std::sqrt(sumSq / n - mean * mean);
+        assert(std::abs(mean - 1.0) < 0.01 && std::abs(stddev - 0.5) < 0.01);
+    }
+
+    /**
+     * @brief Checks initializer choice and that networks are reproducible.
+     */
+    static void testInitializers() {
+        assert(defaultInitFor(ActivationType::ReLU) == InitType::HeNormal);
+        assert(defaultInitFor(ActivationType::Tanh) == InitType::XavierUniform);
+        assert(defaultInitFor(ActivationType::Sigmoid) == InitType::XavierUniform);
+
+        Matrix w(64, 32);
+        initializeWeights(w, InitType::XavierUniform, 1, 0);
+        double limit = std::sqrt(6.0 / 96.0);
+        for (double v : w.data()) {
+            assert(std::abs(v) <= limit);
+        }
+
+        std::vector<size_t> layerSizes = { 4, 16, 16, 1 };
+        std::vector<ActivationType> activs = {
+            ActivationType::ReLU, ActivationType::Tanh, ActivationType::Sigmoid
+        };
+        NeuralNetwork a(layerSizes, activs, LossType::MSE, OptimizerType::SGD);
+        NeuralNetwork b(layerSizes, activs, LossType::MSE, OptimizerType::SGD);
+        a.initializeParameters(99);
+        b.initializeParameters(99);
+        for (size_t i = 0; i < a.weights().size(); ++i) {
+            assert(a.weights()[i].data() == b.weights()[i].data());
+        }
+
+        setGlobalSeed(5);
+        NeuralNetwork c(layerSizes, activs, LossType::MSE, OptimizerType::SGD);
+        setGlobalSeed(5);
+        NeuralNetwork d(layerSizes, activs, LossType::MSE, OptimizerType::SGD);
+        assert(c.weights()[0].data() == d.weights()[0].data() &&
+            "Resetting the global seed must reproduce construction");
+    }
+
+    /**
+     * @brief Runs all random-generation tests in sequence.
+     */
+    void runAllRandomTests() {
+        std::cout << "[test_random] Running tests...\n";
+        testPhiloxKnownAnswers();
+        testFillIsReproducible();
+        testInitializers();
+        std::cout << "[test_random] All tests passed!\n";
+    }
+
+}  // namespace test_random
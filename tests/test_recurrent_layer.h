@@ -0,0 +1,172 @@
+/**
+ * @file test_recurrent_layer.h
+ * @brief Tests for the LSTM and GRU layers.
+ */
+
+#include <cassert>
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <vector>
+#include "../include/recurrent_layer.h"
+#include "../include/layer_graph.h"
+#include "gradient_check.h"
+
+namespace test_recurrent_layer {
+
+    using namespace nn;
+
+    /**
+     * @brief Builds Dense -> recurrent -> Dense and checks the front Dense
+     *        (input gradients) and both recurrent weight matrices against
+     *        central finite differences.
+     */
+    template <typename Recurrent>
+    static void checkGradients(bool returnSequences) {
+        const double lr = 1e-3;
+        const size_t F = 3, H = 4, T = 5;
+        LayerGraph graph(2 * T, LossType::MSE, OptimizerType::SGD, lr);
+        size_t front = graph.add(std::make_unique<DenseLayer>(2 * T, F * T, ActivationType::Tanh, 1));
+        size_t rnn = graph.add(std::make_unique<Recurrent>(F, H, T, returnSequences, 0, 2));
+        graph.add(std::make_unique<DenseLayer>(graph.outputWidth(rnn), 2, ActivationType::Sigmoid, 3));
+
+        Matrix x(3, 2 * T, true);
+        Matrix t(3, 2, true);
+        Matrix& wFront = static_cast<DenseLayer&>(graph.layer(front)).weights();
+        Matrix& wx = static_cast<Recurrent&>(graph.layer(rnn)).inputWeights();
+        Matrix& wh = static_cast<Recurrent&>(graph.layer(rnn)).recurrentWeights();
+        test_gradient_check::checkParameterGradients(graph, x, t, { &wFront, &wx, &wh }, lr);
+    }
+
+    static void testGradientsMatchFiniteDifferences() {
+        checkGradients<LSTMLayer>(false);
+        checkGradients<LSTMLayer>(true);
+        checkGradients<GRULayer>(false);
+        checkGradients<GRULayer>(true);
+    }
+
+    /**
+     * @brief With a 2-step BPTT window, steps before the window get no input gradient.
+     */
+    static void testTruncatedBackprop() {
+        const size_t F = 2, H = 3, T = 6, B = 2;
+        LSTMLayer lstm(F, H, T, false, 2, 5);
+        std::vector<size_t> savedWidths = lstm.savedWidths({ F * T });
+
+        Matrix x(B, F * T, true);
+        Matrix y(B, H);
+        std::vector<Matrix> saved;
+        for (size_t w : savedWidths) {
+            saved.emplace_back(B, w);
+        }
+        std::vector<Matrix*> savedPtrs = { &saved[0], &saved[1], &saved[2] };
+        lstm.forward({ &x }, y, savedPtrs, true);
+
+        Matrix gradY(B, H);
+        std::fill(gradY.data().begin(), gradY.data().end(), 1.0);
+        Matrix gradX(B, F * T);
+        lstm.backward({ &x }, savedPtrs, gradY, { &gradX });
+
+        for (size_t s = 0; s < B; ++s) {
+            for (size_t t = 0; t < T; ++t) {
+                double norm = 0.0;
+                for (size_t f = 0; f < F; ++f) {
+                    norm += std::abs(gradX(s, t * F + f));
+                }
+                assert((t < T - 2) == (norm == 0.0));
+            }
+        }
+    }
+
+    /**
+     * @brief Checks a 2-of-5-step BPTT window (dWx, dWh and dX, which go
+     *        through the packed-window path) against finite differences.
+     *        Steps before the window get zero inputs and the biases are
+     *        zeroed, so every state there is exactly 0 whatever the weights
+     *        and the full gradient the probes measure is the truncated one.
+     */
+    template <typename Recurrent>
+    static void checkTruncatedGradients(bool returnSequences) {
+        const size_t F = 3, H = 4, T = 5, B = 3, window = 2;
+        Recurrent rnn(F, H, T, returnSequences, window, 6);
+        std::vector<std::pair<Matrix*, Matrix*>> params = rnn.parameters();
+        for (size_t k = 2; k < params.size(); ++k) {
+            std::fill(params[k].first->data().begin(), params[k].first->data().end(), 0.0);
+        }
+
+        Matrix x(B, F * T, true);
+        for (size_t s = 0; s < B; ++s) {
+            std::fill(&x(s, 0), &x(s, 0) + (T - window) * F, 0.0);
+        }
+        std::vector<Matrix> saved;
+        for (size_t w : rnn.savedWidths({ F * T })) {
+            saved.emplace_back(B, w);
+        }
+        std::vector<Matrix*> savedPtrs;
+        for (Matrix& m : saved) {
+            savedPtrs.push_back(&m);
+        }
+
+        // L = sum(c * y): dL/dy = c
+        const size_t outWidth = rnn.outputWidth({ F * T });
+        Matrix y(B, outWidth);
+        Matrix c(B, outWidth, true);
+        auto lossOf = [&]() {
+            rnn.forward({ &x }, y, savedPtrs, true);
+            double sum = 0.0;
+            for (size_t e = 0; e < y.data().size(); ++e) {
+                sum += c.data()[e] * y.data()[e];
+            }
+            return sum;
+        };
+        auto numeric = [&](double& p) {
+            const double eps = 1e-6;
+            double saved = p;
+            p = saved + eps;
+            double up = lossOf();
+            p = saved - eps;
+            double down = lossOf();
+            p = saved;
+            return (up - down) / (2.0 * eps);
+        };
+
+        lossOf();
+        Matrix gradY = c;
+        Matrix gradX(B, F * T);
+        rnn.backward({ &x }, savedPtrs, gradY, { &gradX });
+
+        for (size_t k = 0; k < 2; ++k) {   // Wx, Wh
+            Matrix& w = *params[k].first;
+            const Matrix& g = *params[k].second;
+            for (size_t e = 0; e < w.data().size(); ++e) {
+                double n = numeric(w.data()[e]);
+                assert(std::abs(g.data()[e] - n) < 1e-6 * (1.0 + std::abs(n)));
+            }
+        }
+        for (size_t s = 0; s < B; ++s) {
+            for (size_t e = (T - window) * F; e < T * F; ++e) {
+                double n = numeric(x(s, e));
+                assert(std::abs(gradX(s, e) - n) < 1e-6 * (1.0 + std::abs(n)));
+            }
+        }
+    }
+
+    static void testTruncatedGradientsMatchFiniteDifferences() {
+        checkTruncatedGradients<LSTMLayer>(false);
+        checkTruncatedGradients<LSTMLayer>(true);
+        checkTruncatedGradients<GRULayer>(false);
+        checkTruncatedGradients<GRULayer>(true);
+    }
+
+    /**
+     * @brief Runs all recurrent layer tests.
+     */
+    void runAllRecurrentLayerTests() {
+        std::cout << "[test_recurrent_layer] Running tests...\n";
+        testGradientsMatchFiniteDifferences();
+        testTruncatedBackprop();
+        testTruncatedGradientsMatchFiniteDifferences();
+        std::cout << "[test_recurrent_layer] All tests passed!\n";
+    }
+
+}  // namespace test_recurrent_layer
@@ -0,0 +1,135 @@
+/**
+ * @file test_static_neural_network.h
+ * @brief Tests for the StaticNeuralNetwork template using simple assert-based checks.
+ */
+
+#include <cassert>
+#include <iostream>
+#include <vector>
+#include "../include/neural_network.h"
+#include "../include/static_neural_network.h"
+
+namespace test_static_nn {
+
+    using namespace nn;
+
+    /**
+     * @brief Checks that a 2 -> 4 -> 4 -> 1 fixed-topology tanh net learns XOR,
+     *        mirroring test_nn::testXorTrainingBasic.
+     */
+    static void testXorTrainingBasic() {
+        using Net = StaticNeuralNetwork<
+            Activations<ActivationType::Tanh, ActivationType::Tanh, ActivationType::Sigmoid>,
+            2, 4, 4, 1>;
+
+        static_assert(Net::kInputSize == 2, "Input size should be 2");
+        static_assert(Net::kOutputSize == 1, "Output size should be 1");
+
+        const Net::Input inputs[4] = { {0, 0}, {0, 1}, {1, 0}, {1, 1} };
+        const Net::Output targets[4] = { {0}, {1}, {1}, {0} };
+
+        Net net(LossType::CrossEntropy, OptimizerType::Momentum, 0.05, 0.9);
+
+        int epochs = 2000;
+        for (int e = 0; e < epochs; ++e) {
+            for (size_t i = 0; i < 4; ++i) {
+                net.trainSample(inputs[i], targets[i]);
+            }
+        }
+
+        for (size_t i = 0; i < 4; ++i) {
+            double outVal = net.forward(inputs[i])[0];
+            if (targets[i][0] == 0.0) {
+                assert((outVal < 0.5) && "Expected near 0 but got a higher value.");
+            }
+            else {
+                assert((outVal > 0.5) && "Expected near 1 but got a lower value.");
+            }
+        }
+    }
+
+    /**
+     * @brief Checks the Matrix overloads agree with the std::array ones.
+     */
+    static void testMatrixOverloads() {
+        using Net = StaticNeuralNetwork<
+            Activations<ActivationType::Tanh, ActivationType::Sigmoid>, 3, 5, 2>;
+
+        Net net(LossType::MSE, OptimizerType::SGD, 0.1);
+
+        Matrix in(1, 3);
+        in(0, 0) = 0.25; in(0, 1) = -0.5; in(0, 2) = 1.0;
+        Matrix out = net.forward(in);
+        assert(out.rows() == 1 && out.cols() == 2);
+
+        Net::Output arrayOut = net.forward(Net::Input{ 0.25, -0.5, 1.0 });
+        assert(out(0, 0) == arrayOut[0] && out(0, 1) == arrayOut[1]);
+
+        Matrix target(1, 2);
+        target(0, 0) = 1.0; target(0, 1) = 0.0;
+        double before = net.trainSample(in, target);
+        for (int e = 0; e < 200; ++e) {
+            net.trainSample(in, target);
+        }
+        double after = net.trainSample(in, target);
+        assert(after < before && "Loss should decrease on a single repeated sample");
+    }
+
+    /**
+     * @brief Trains a StaticNeuralNetwork and a NeuralNetwork that start from
+     *        the same parameters side by side and checks every loss and
+     *        output stays equal.
+     */
+    template <typename Net>
+    static void checkLockstep(const std::vector<size_t>& sizes,
+        const std::vector<ActivationType>& activations, LossType loss, OptimizerType opt) {
+        NeuralNetwork reference(sizes, activations, loss, opt, 0.05, 0.9);
+        Net net(loss, opt, 0.05, 0.9);
+        net.setParameters(reference.weights(), reference.biases());
+
+        for (int step = 0; step < 20; ++step) {
+            Matrix in(1, Net::kInputSize, true);
+            Matrix target(1, Net::kOutputSize);
+            for (size_t j = 0; j < Net::kOutputSize; ++j) {
+                target(0, j) = (step + j) % 2;
+            }
+            Matrix expected = reference.forward(in);
+            Matrix out = net.forward(in);
+            for (size_t j = 0; j < Net::kOutputSize; ++j) {
+                assert(out(0, j) == expected(0, j) && "Output should match NeuralNetwork");
+            }
+            double expectedLoss = reference.trainSample(in, target);
+            double lossVal = net.trainSample(in, target);
+            assert(lossVal == expectedLoss && "Loss should match NeuralNetwork");
+        }
+    }
+
+    /**
+     * @brief Same train/predict semantics as NeuralNetwork for both optimizers
+     *        and both losses.
+     */
+    static void testMatchesNeuralNetwork() {
+        using Net = StaticNeuralNetwork<
+            Activations<ActivationType::ReLU, ActivationType::Tanh, ActivationType::Sigmoid>, 3, 6, 5, 2>;
+        const std::vector<size_t> sizes = { 3, 6, 5, 2 };
+        const std::vector<ActivationType> activations =
+            { ActivationType::ReLU, ActivationType::Tanh, ActivationType::Sigmoid };
+        for (LossType loss : { LossType::MSE, LossType::CrossEntropy }) {
+            for (OptimizerType opt : { OptimizerType::SGD, OptimizerType::Momentum }) {
+                checkLockstep<Net>(sizes, activations, loss, opt);
+            }
+        }
+    }
+
+    /**
+     * @brief Runs all StaticNeuralNetwork tests in sequence.
+     */
+    void runAllStaticNeuralNetworkTests() {
+        std::cout << "[test_static_neural_network] Running tests...\n";
+        testXorTrainingBasic();
+        testMatrixOverloads();
+        testMatchesNeuralNetwork();
+        std::cout << "[test_static_neural_network] All tests passed!\n";
+    }
+
+}  // namespace test_static_nn
@@ -0,0 +1,106 @@
+/**
+ * @file test_tensor_parallel.h
+ * @brief Tests for the column-sharded tensor-parallel trainer.
+ */
+
+#include <atomic>
+#include <cassert>
+#include <cmath>
+#include <iostream>
+#include <vector>
+#include "../include/tensor_parallel.h"
+#include "../include/threading.h"
+
+namespace test_tensor_parallel {
+
+    using namespace nn;
+
+    static NeuralNetwork makeNet() {
+        NeuralNetwork net({ 6, 32, 24, 3 },
+            { ActivationType::Tanh, ActivationType::ReLU, ActivationType::Sigmoid },
+            LossType::CrossEntropy, OptimizerType::Momentum, 0.05, 0.9);
+        net.initializeParameters(7);
+        return net;
+    }
+
+    static void testThreadGroupBarrier() {
+        ThreadGroup group(4, false);
+        std::vector<int> slots(group.size(), 0);
+        std::atomic<bool> ok{ true };
+        for (int round = 0; round < 50; ++round) {
+            group.run([&](size_t t) {
+                slots[t] = round;
+                group.barrier();
+                for (int v : slots) {
+                    if (v != round) {
+                        ok = false;
+                    }
+                }
+                group.barrier();
+            });
+        }
+        assert(ok);
+    }
+
+    /**
+     * @brief Sharded training must follow the same trajectory as a plain
+     *        full-batch step, including through the partial-sum reduction.
+     */
+    static void testMatchesFullBatchStep() {
+        Matrix x(9, 6, true);
+        Matrix t(9, 3);
+        for (size_t e = 0; e < t.data().size(); ++e) {
+            t.data()[e] = (e % 4 == 0) ? 1.0 : 0.0;
+        }
+
+        NeuralNetwork reference = makeNet();
+        NeuralNetwork sharded = makeNet();
+
+        TensorParallelConfig config;
+        config.numThreads = 4;
+        config.minShardWeights = 64;
+        {
+            TensorParallelTrainer trainer(sharded, config);
+            assert(trainer.numShards(0) == 3);
+            assert(trainer.numShards(1) == 4);
+            assert(trainer.numShards(2) == 1);
+
+            for (int step = 0; step < 5; ++step) {
+                std::vector<Matrix> dW, dB;
+                double expected = reference.computeGradients(x, t, dW, dB);
+                double loss = trainer.trainBatch(x, t);
+                assert(std::abs(loss - expected) < 1e-10);
+                for (size_t i = 0; i < reference.numLayers(); ++i) {
+                    reference.applyLayerGradients(i, dW[i], dB[i]);
+                }
+            }
+
+            Matrix y = trainer.predict(x);
+            Matrix yRef = reference.predict(x);
+            for (size_t e = 0; e < y.data().size(); ++e) {
+                assert(std::abs(y.data()[e] - yRef.data()[e]) < 1e-10);
+            }
+        }
+
+        // The destructor synced the shards back
+        for (size_t i = 0; i < reference.numLayers(); ++i) {
+            for (size_t e = 0; e < reference.weights()[i].data().size(); ++e) {
+                assert(std::abs(reference.weights()[i].data()[e] - sharded.weights()[i].data()[e]) < 1e-10);
+            }
+            for (size_t e = 0; e < reference.biases()[i].data().size(); ++e) {
+                assert(std::abs(reference.biases()[i].data()[e] - sharded.biases()[i].data()[e]) < 1e-10);
+            }
+        }
+    }
+
+    /**
+     * @brief Runs all tensor-parallel tests.
+     */
+    void runAllTensorParallelTests() {
+        std::cout << "[test_tensor_parallel] Running tests...\n";
+        testThreadGroupBarrier();
+        testMatchesFullBatchStep();
+        std::cout << "[test_tensor_parallel] All tests passed!\n";
+    }
+
+}  // namespace test_tensor_parallel
@@ -0,0 +1,112 @@
+/**
+ * @file test_trainer.h
+ * @brief Tests for learning-rate schedules and the Trainer loop.
+ */
+
+#include <cassert>
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include "../include/trainer.h"
+
+namespace test_trainer {
+
+    using namespace nn;
+
+    /**
+     * @brief Checks each schedule against hand-computed rates.
+     */
+    static void testSchedules() {
+        StepDecaySchedule step(10, 0.5);
+        assert(step.rate(0, 1.0) == 1.0);
+        assert(step.rate(9, 1.0) == 1.0);
+        assert(step.rate(10, 1.0) == 0.5);
+        assert(step.rate(25, 1.0) == 0.25);
+
+        CosineSchedule cosine(100, 0.0);
+        assert(cosine.rate(0, 1.0) == 1.0);
+        assert(std::abs(cosine.rate(50, 1.0) - 0.5) < 1e-12);
+        assert(std::abs(cosine.rate(100, 1.0)) < 1e-12);
+        assert(std::abs(cosine.rate(500, 1.0)) < 1e-12);
+
+        WarmupSchedule warmup(4, std::make_unique<StepDecaySchedule>(2, 0.1));
+        assert(warmup.rate(0, 1.0) == 0.25);
+        assert(warmup.rate(3, 1.0) == 1.0);
+        assert(warmup.rate(4, 1.0) == 1.0);
+        assert(std::abs(warmup.rate(6, 1.0) - 0.1) < 1e-12);
+
+        ReduceOnPlateauSchedule plateau(0.5, 2, 0.0, 0.1);
+        plateau.observe(1.0);  // best
+        plateau.observe(1.0);  // wait 1
+        plateau.observe(1.0);  // wait 2
+        assert(plateau.rate(0, 1.0) == 1.0);
+        plateau.observe(1.0);  // wait 3 > patience: halve
+        assert(plateau.rate(0, 1.0) == 0.5);
+        plateau.observe(0.5);  // improvement resets the wait
+        plateau.observe(0.5);
+        plateau.observe(0.5);
+        assert(plateau.rate(0, 1.0) == 0.5);
+        for (int i = 0; i < 20; ++i) {
+            plateau.observe(0.5);
+        }
+        assert(plateau.rate(0, 1.0) == 0.1 && "Rate should not drop below minRate");
+    }
+
+    /**
+     * @brief Checks fit stops early at the target loss and restores the rate.
+     */
+    static void testEarlyStopping() {
+        Dataset data;
+        for (int pattern = 0; pattern < 4; ++pattern) {
+            Matrix in(1, 2);
+            in(0, 0) = pattern & 1;
+            in(0, 1) = (pattern >> 1) & 1;
+            Matrix t(1, 1);
+            t(0, 0) = (pattern == 3) ? 1.0 : 0.0;  // AND
+            data.inputs.push_back(in);
+            data.targets.push_back(t);
+        }
+
+        NeuralNetwork net({ 2, 4, 1 },
+            { ActivationType::Tanh, ActivationType::Sigmoid },
+            LossType::CrossEntropy, OptimizerType::Momentum, 0.05, 0.9);
+
+        TrainerConfig config;
+        config.maxEpochs = 20000;
+        config.evalInterval = 10;
+        config.targetLoss = 0.05;
+
+        size_t evaluations = 0;
+        Trainer trainer(config, std::make_unique<CosineSchedule>(20000, 0.01));
+        trainer.setEvaluationCallback([&evaluations](const TrainingProgress&) { ++evaluations; });
+        TrainingResult result = trainer.fit(net, data);
+
+        assert(result.reason == StopReason::TargetLoss && "AND should reach the target loss");
+        assert(result.progress.epoch < config.maxEpochs);
+        assert(result.progress.monitoredLoss <= config.targetLoss);
+        assert(result.progress.accuracy == 1.0);
+        assert(evaluations == result.progress.epoch / config.evalInterval);
+        assert(net.learningRate() == 0.05 && "fit should restore the base rate");
+
+        // Stall detection: a zero learning rate never improves
+        NeuralNetwork frozen({ 2, 4, 1 },
+            { ActivationType::Tanh, ActivationType::Sigmoid },
+            LossType::CrossEntropy, OptimizerType::SGD, 0.0);
+        config.targetLoss = -1.0;
+        config.patience = 3;
+        TrainingResult stalled = Trainer(config).fit(frozen, data);
+        assert(stalled.reason == StopReason::Stalled);
+        assert(stalled.progress.epoch == 4 * config.evalInterval);
+    }
+
+    /**
+     * @brief Runs all Trainer tests in sequence.
+     */
+    void runAllTrainerTests() {
+        std::cout << "[test_trainer] Running tests...\n";
+        testSchedules();
+        testEarlyStopping();
+        std::cout << "[test_trainer] All tests passed!\n";
+    }
+
+}  // namespace test_trainer